@@ -413,10 +413,9 @@ void EmuSystem::runFrame(bool renderGfx, bool processGfx, bool renderAudio)
 		updateAndDrawEmuVideo();
 	}
 	auto frames = audioFramesPerVideoFrame;
-	Int16 buff[frames * soundChannels];
-	uint writtenFrames = osystem.soundGeneric().processAudio(buff, frames);
-	if(renderAudio)
-		writeSound(buff, writtenFrames);
+	auto soundBuff = getSoundBuffer(frames, renderAudio);
+	uint writtenFrames = osystem.soundGeneric().processAudio((Int16*)soundBuff.data, frames);
+	commitSound(soundBuff, writtenFrames);
 }
 
 void EmuSystem::reset(ResetMode mode)
@@ -930,6 +930,32 @@ void TIA::updateScanlineByTrace(int target)
 }
 #endif
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// Set 'bit' in objects[i] wherever (mask[i] & graphics) is non-zero.
+// Full words test eight clocks at once using the usual non-zero byte trick;
+// each byte of the result is 0 or 1, so scaling by the object bit
+// cannot carry between bytes.
+static inline void addObjectSpan(uInt8* objects, const uInt8* mask,
+    uInt8 graphics, uInt8 bit, uInt32 words, uInt32 count)
+{
+  const uInt64 ones = 0x0101010101010101ULL;
+  const uInt64 low7 = 0x7F7F7F7F7F7F7F7FULL;
+  const uInt64 graphicsWord = graphics * ones;
+
+  for(uInt32 w = 0; w < words; ++w)
+  {
+    uInt64 m, o;
+    memcpy(&m, mask + w * 8, 8);
+    memcpy(&o, objects + w * 8, 8);
+    m &= graphicsWord;
+    o |= (((((m & low7) + low7) | m) >> 7) & ones) * bit;
+    memcpy(objects + w * 8, &o, 8);
+  }
+  for(uInt32 i = words * 8; i < count; ++i)
+    if(mask[i] & graphics)
+      objects[i] |= bit;
+}
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void TIA::updateFrame(Int32 clock)
 {
@@ -1112,32 +1138,58 @@ void TIA::updateFrame(Int32 clock)
           myM1Mask = &TIATables::MxMask[myNUSIZ1 & 0x07]
               [(myNUSIZ1 & 0x30) >> 4][160 - (myPOSM1 & 0xFF)];
 
+        // Lines without mid-line register writes arrive here as one span
+        // covering the whole visible line.  Rather than testing all six
+        // objects per clock, build the object bits for the span one object
+        // at a time, eight clocks per 64-bit word, skipping objects that are
+        // disabled or have no graphics.
         uInt8 enabledObjects = myEnabledObjects & myDisabledObjects;
         uInt32 hpos = clocksFromStartOfScanLine - HBLANK;
-        for(; myFramePointer < ending; ++myFramePointer, ++hpos)
-        {
-          uInt8 enabled = ((enabledObjects & PFBit) &&
-                           (myPF & myPFMask[hpos])) ? PFBit : 0;
-
-          if((enabledObjects & BLBit) && myBLMask[hpos])
-            enabled |= BLBit;
+        uInt32 count = ending - myFramePointer;
+        uInt32 words = count / 8;
+        uInt8 objects[160];
 
-          if((enabledObjects & P1Bit) && (myCurrentGRP1 & myP1Mask[hpos]))
-            enabled |= P1Bit;
-
-          if((enabledObjects & M1Bit) && myM1Mask[hpos])
-            enabled |= M1Bit;
-
-          if((enabledObjects & P0Bit) && (myCurrentGRP0 & myP0Mask[hpos]))
-            enabled |= P0Bit;
-
-          if((enabledObjects & M0Bit) && myM0Mask[hpos])
-            enabled |= M0Bit;
-
-          myCollision |= TIATables::CollisionMask[enabled];
-          *myFramePointer = myColorPtr[myPriorityEncoder[hpos < 80 ? 0 : 1]
-              [enabled | myPlayfieldPriorityAndScore]];
+        if((enabledObjects & PFBit) && myPF)
+        {
+          const uInt32* pfMask = myPFMask + hpos;
+          for(uInt32 i = 0; i < count; ++i)
+            objects[i] = (myPF & pfMask[i]) ? PFBit : 0;
+        }
+        else
+          memset(objects, 0, count);
+
+        if(enabledObjects & BLBit)
+          addObjectSpan(objects, myBLMask + hpos, 0xFF, BLBit, words, count);
+        if((enabledObjects & P1Bit) && myCurrentGRP1)
+          addObjectSpan(objects, myP1Mask + hpos, myCurrentGRP1, P1Bit, words, count);
+        if(enabledObjects & M1Bit)
+          addObjectSpan(objects, myM1Mask + hpos, 0xFF, M1Bit, words, count);
+        if((enabledObjects & P0Bit) && myCurrentGRP0)
+          addObjectSpan(objects, myP0Mask + hpos, myCurrentGRP0, P0Bit, words, count);
+        if(enabledObjects & M0Bit)
+          addObjectSpan(objects, myM0Mask + hpos, 0xFF, M0Bit, words, count);
+
+        // Collisions only depend on which object combinations appeared,
+        // so mark those first and latch each combination once
+        uInt8 seen[64] = { 0 };
+        for(uInt32 i = 0; i < count; ++i)
+          seen[objects[i]] = 1;
+        for(uInt32 c = 0; c < 64; ++c)
+          if(seen[c])
+            myCollision |= TIATables::CollisionMask[c];
+
+        // The left and right halves use different priority encoders
+        uInt32 i = 0;
+        if(hpos < 80)
+        {
+          const uInt8* left = myPriorityEncoder[0];
+          uInt32 leftCount = count < 80 - hpos ? count : 80 - hpos;
+          for(; i < leftCount; ++i)
+            myFramePointer[i] = myColorPtr[left[objects[i] | myPlayfieldPriorityAndScore]];
         }
+        const uInt8* right = myPriorityEncoder[1];
+        for(; i < count; ++i)
+          myFramePointer[i] = myColorPtr[right[objects[i] | myPlayfieldPriorityAndScore]];
       }
       myFramePointer = ending;
     }
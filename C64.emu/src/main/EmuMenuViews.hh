@@ -131,6 +131,16 @@ class SystemOptionView : public OptionView
 		}
 	};
 
+	BoolMenuItem sidThreaded
+	{
+		"Run ReSID On Separate Thread",
+		[this](BoolMenuItem &item, View &, Input::Event e)
+		{
+			item.toggle(*this);
+			resources_set_int("SidResidThreaded", item.on);
+		}
+	};
+
 	template <size_t S>
 	static void printSysPathMenuEntryStr(char (&str)[S])
 	{
@@ -211,6 +221,7 @@ public:
 		OptionView::loadAudioItems(item, items);
 		#ifdef HAVE_RESID
 		sidEngineInit(); item[items++] = &sidEngine;
+		sidThreaded.init(intResource("SidResidThreaded")); item[items++] = &sidThreaded;
 		#endif
 	}
 
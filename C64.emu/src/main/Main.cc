@@ -80,7 +80,7 @@ enum
 	CFGKEY_AUTOSTART_TDE = 258, CFGKEY_C64_MODEL = 259,
 	CFGKEY_BORDER_MODE = 260, CFGKEY_SWAP_JOYSTICK_PORTS = 261,
 	CFGKEY_SID_ENGINE = 262, CFGKEY_CROP_NORMAL_BORDERS = 263,
-	CFGKEY_SYSTEM_FILE_PATH = 264
+	CFGKEY_SYSTEM_FILE_PATH = 264, CFGKEY_SID_THREADED = 265
 };
 
 static int intResource(const char *name)
@@ -179,6 +179,16 @@ static int sidEngine()
 	return intResource("SidEngine");
 }
 
+static void setSidThreaded(bool on)
+{
+	resources_set_int("SidResidThreaded", on);
+}
+
+static bool sidThreaded()
+{
+	return intResource("SidResidThreaded");
+}
+
 static Byte1Option optionDriveTrueEmulation(CFGKEY_DRIVE_TRUE_EMULATION, 1);
 static Byte1Option optionCropNormalBorders(CFGKEY_CROP_NORMAL_BORDERS, 1);
 static Option<OptionMethodFunc<bool, autostartWarp, setAutostartWarp>, uint8>
@@ -197,6 +207,8 @@ static Option<OptionMethodFunc<int, sidEngine, setSidEngine>, uint8>
 		SID_ENGINE_FASTSID
 		#endif
 	);
+static Option<OptionMethodFunc<bool, sidThreaded, setSidThreaded>, uint8>
+	optionSidThreaded(CFGKEY_SID_THREADED, 0);
 static Byte1Option optionSwapJoystickPorts(CFGKEY_SWAP_JOYSTICK_PORTS, 0);
 PathOption optionFirmwarePath(CFGKEY_SYSTEM_FILE_PATH, firmwareBasePath, "");
 
@@ -216,6 +228,7 @@ bool EmuSystem::readConfig(IO &io, uint key, uint readSize)
 		bcase CFGKEY_BORDER_MODE: optionBorderMode.readFromIO(io, readSize);
 		bcase CFGKEY_CROP_NORMAL_BORDERS: optionCropNormalBorders.readFromIO(io, readSize);
 		bcase CFGKEY_SID_ENGINE: optionSidEngine.readFromIO(io, readSize);
+		bcase CFGKEY_SID_THREADED: optionSidThreaded.readFromIO(io, readSize);
 		bcase CFGKEY_SWAP_JOYSTICK_PORTS: optionSwapJoystickPorts.readFromIO(io, readSize);
 		bcase CFGKEY_SYSTEM_FILE_PATH: optionFirmwarePath.readFromIO(io, readSize);
 	}
@@ -231,6 +244,7 @@ void EmuSystem::writeConfig(IO &io)
 	optionBorderMode.writeWithKeyIfNotDefault(io);
 	optionCropNormalBorders.writeWithKeyIfNotDefault(io);
 	optionSidEngine.writeWithKeyIfNotDefault(io);
+	optionSidThreaded.writeWithKeyIfNotDefault(io);
 	optionSwapJoystickPorts.writeWithKeyIfNotDefault(io);
 	optionFirmwarePath.writeToIO(io);
 }
@@ -1101,6 +1115,7 @@ CallResult EmuSystem::onInit()
 		{
 			execSem.wait();
 			logMsg("running C64");
+			updateEmuWorkerThreadScheduling();
 			maincpu_mainloop();
 		});
 
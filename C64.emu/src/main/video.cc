@@ -32,6 +32,8 @@ extern "C"
 	#include "videoarch.h"
 	#include "kbdbuf.h"
 	#include "sound.h"
+	#include "sid/sid.h"
+	#include "sid/resid.h"
 }
 
 CLINK void (*vsync_hook)(void);
@@ -77,6 +79,9 @@ CLINK void vsyncarch_postsync(void) {}
 
 CLINK int vsync_do_vsync(struct video_canvas_s *c, int been_skipped)
 {
+	#ifdef HAVE_RESID
+	resid_frame_sync();
+	#endif
 	sound_flush();
 	kbdbuf_flush();
 	vsync_hook();
@@ -91,6 +96,9 @@ CLINK int vsync_do_vsync(struct video_canvas_s *c, int been_skipped)
 		sem_post(&execDoneSem);
 		sem_wait(&execSem);
 		#endif
+		// the main thread only waits on this one while emulating, re-check the
+		// scheduling since emulation may have stopped or its options changed
+		updateEmuWorkerThreadScheduling();
 	}
 	else
 	{
@@ -64,6 +64,10 @@ extern char *strcpy(char *s1, char *s2);
 #include "resid/sid.h"
 /* resid-dtv/ is used for DTVSID, but the API is the same */
 
+#include <atomic>
+#include <pthread.h>
+#include <sched.h>
+
 using namespace reSID;
 
 extern "C" {
@@ -75,6 +79,9 @@ struct sound_s
 
     /* resid sid implementation */
     reSID::SID *sid;
+
+    /* worker running the sid, NULL when clocked on the emulation thread */
+    struct resid_thread_s *thread;
 };
 
 typedef struct sound_s sound_t;
@@ -96,6 +103,307 @@ static SWORD *getbuf(int len)
     return buf;
 }
 
+/* Threaded mode: instead of clocking reSID inline, the elapsed cycles
+ * before each register write and the write itself are queued in order
+ * and replayed on a worker thread, so the output is identical to the
+ * inline mode. The worker renders into a sample FIFO and the samples
+ * rendered up to the previous frame's end are released to
+ * resid_calculate_samples() by resid_frame_sync(), adding one frame of
+ * latency while the worker runs parallel to the next frame. Anything
+ * that needs the SID state itself (register reads, snapshots, resets)
+ * waits for the worker to catch up first.
+ */
+
+enum {
+    RESID_CMD_CLOCK,
+    RESID_CMD_WRITE,
+    RESID_CMD_FENCE,
+    RESID_CMD_FRAME
+};
+
+typedef struct resid_cmd_s {
+    int value; /* cycles to clock or fence sequence number */
+    BYTE type;
+    BYTE addr;
+    BYTE byte;
+} resid_cmd_t;
+
+#define RESID_CMD_QUEUE_SIZE 16384 /* power of 2 */
+#define RESID_SAMPLE_FIFO_SIZE 32768 /* power of 2 */
+#define RESID_MAX_THREADED_SIDS 3
+
+typedef struct resid_thread_s {
+    reSID::SID *sid;
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t wake_cond;
+    pthread_cond_t done_cond;
+    std::atomic<bool> idle;
+    std::atomic<bool> quit;
+    std::atomic<bool> emu_waiting;
+
+    /* emulation thread -> worker */
+    resid_cmd_t cmd[RESID_CMD_QUEUE_SIZE];
+    std::atomic<unsigned int> cmd_pushed;
+    std::atomic<unsigned int> cmd_popped;
+    unsigned int fences_pushed;
+    std::atomic<unsigned int> fences_done;
+
+    /* worker -> emulation thread */
+    SWORD samples[RESID_SAMPLE_FIFO_SIZE];
+    std::atomic<unsigned int> produced;
+    std::atomic<unsigned int> consumed;
+    std::atomic<unsigned int> frame_produced;
+    unsigned int released;
+    unsigned int frame_fence;
+} resid_thread_t;
+
+static int resid_threaded_sids;
+static resid_thread_t *resid_threads[RESID_MAX_THREADED_SIDS];
+
+static void resid_thread_render(resid_thread_t *t, int delta_t)
+{
+    SWORD tmp[512];
+
+    while (delta_t > 0) {
+        int nr = t->sid->clock(delta_t, tmp, 512, 1);
+        int i;
+
+        for (i = 0; i < nr; i++) {
+            unsigned int pos = t->produced.load(std::memory_order_relaxed);
+
+            /* only the previous frame's samples are unreleased, this
+               doesn't wait unless the consumer stalls for a long time */
+            while (pos - t->consumed.load(std::memory_order_acquire) >= RESID_SAMPLE_FIFO_SIZE) {
+                if (t->quit.load()) {
+                    return;
+                }
+                /* the emulation thread is waiting for a fence queued after
+                   this render or for queue space, and won't consume until
+                   then, so drop the sample instead of waiting on each other */
+                if (t->emu_waiting.load()) {
+                    break;
+                }
+                sched_yield();
+            }
+            if (pos - t->consumed.load(std::memory_order_acquire) >= RESID_SAMPLE_FIFO_SIZE) {
+                continue;
+            }
+            t->samples[pos & (RESID_SAMPLE_FIFO_SIZE - 1)] = tmp[i];
+            t->produced.store(pos + 1, std::memory_order_release);
+        }
+    }
+}
+
+static void *resid_thread_main(void *arg)
+{
+    resid_thread_t *t = (resid_thread_t *)arg;
+
+    for (;;) {
+        unsigned int pos = t->cmd_popped.load(std::memory_order_relaxed);
+        resid_cmd_t *c;
+
+        if (pos == t->cmd_pushed.load(std::memory_order_acquire)) {
+            pthread_mutex_lock(&t->mutex);
+            t->idle.store(true);
+            while (pos == t->cmd_pushed.load() && !t->quit.load()) {
+                pthread_cond_wait(&t->wake_cond, &t->mutex);
+            }
+            t->idle.store(false);
+            pthread_mutex_unlock(&t->mutex);
+            if (t->quit.load()) {
+                return NULL;
+            }
+            continue;
+        }
+
+        c = &t->cmd[pos & (RESID_CMD_QUEUE_SIZE - 1)];
+        switch (c->type) {
+            case RESID_CMD_CLOCK:
+                resid_thread_render(t, c->value);
+                break;
+            case RESID_CMD_WRITE:
+                t->sid->write(c->addr, c->byte);
+                break;
+            case RESID_CMD_FRAME:
+                t->frame_produced.store(t->produced.load(std::memory_order_relaxed), std::memory_order_relaxed);
+                /* fall through */
+            case RESID_CMD_FENCE:
+                pthread_mutex_lock(&t->mutex);
+                t->fences_done.store(c->value);
+                pthread_cond_broadcast(&t->done_cond);
+                pthread_mutex_unlock(&t->mutex);
+                break;
+        }
+        t->cmd_popped.store(pos + 1, std::memory_order_release);
+    }
+}
+
+static void resid_thread_push(resid_thread_t *t, BYTE type, int value, BYTE addr, BYTE byte)
+{
+    unsigned int pos = t->cmd_pushed.load(std::memory_order_relaxed);
+    resid_cmd_t *c;
+
+    if (pos - t->cmd_popped.load(std::memory_order_acquire) >= RESID_CMD_QUEUE_SIZE) {
+        t->emu_waiting.store(true);
+        while (pos - t->cmd_popped.load(std::memory_order_acquire) >= RESID_CMD_QUEUE_SIZE) {
+            sched_yield();
+        }
+        t->emu_waiting.store(false);
+    }
+    c = &t->cmd[pos & (RESID_CMD_QUEUE_SIZE - 1)];
+    c->type = type;
+    c->value = value;
+    c->addr = addr;
+    c->byte = byte;
+    t->cmd_pushed.store(pos + 1);
+    if (t->idle.load()) {
+        pthread_mutex_lock(&t->mutex);
+        pthread_cond_signal(&t->wake_cond);
+        pthread_mutex_unlock(&t->mutex);
+    }
+}
+
+static void resid_thread_wait_fence(resid_thread_t *t, unsigned int fence)
+{
+    if ((int)(t->fences_done.load() - fence) >= 0) {
+        return;
+    }
+    t->emu_waiting.store(true);
+    pthread_mutex_lock(&t->mutex);
+    while ((int)(t->fences_done.load() - fence) < 0) {
+        pthread_cond_wait(&t->done_cond, &t->mutex);
+    }
+    pthread_mutex_unlock(&t->mutex);
+    t->emu_waiting.store(false);
+}
+
+/* wait until the worker has replayed everything queued so far */
+static void resid_thread_drain(resid_thread_t *t)
+{
+    unsigned int fence = ++t->fences_pushed;
+
+    resid_thread_push(t, RESID_CMD_FENCE, (int)fence, 0, 0);
+    resid_thread_wait_fence(t, fence);
+}
+
+static void resid_thread_frame(resid_thread_t *t)
+{
+    if (t->frame_fence) {
+        unsigned int frame_produced;
+
+        resid_thread_wait_fence(t, t->frame_fence);
+        frame_produced = t->frame_produced.load(std::memory_order_relaxed);
+        /* a reset may have discarded past this frame's end already */
+        if ((int)(frame_produced - t->released) > 0) {
+            t->released = frame_produced;
+        }
+    }
+    t->frame_fence = ++t->fences_pushed;
+    resid_thread_push(t, RESID_CMD_FRAME, (int)t->frame_fence, 0, 0);
+}
+
+static int resid_thread_read_samples(resid_thread_t *t, SWORD *pbuf, int nr, int interleave)
+{
+    unsigned int pos = t->consumed.load(std::memory_order_relaxed);
+    unsigned int avail = t->released - pos;
+    int i;
+
+    if ((unsigned int)nr > avail) {
+        nr = (int)avail;
+    }
+    for (i = 0; i < nr; i++) {
+        pbuf[i * interleave] = t->samples[(pos + i) & (RESID_SAMPLE_FIFO_SIZE - 1)];
+    }
+    t->consumed.store(pos + nr, std::memory_order_release);
+    return nr;
+}
+
+static void resid_thread_discard_samples(resid_thread_t *t)
+{
+    unsigned int produced = t->produced.load();
+
+    t->released = produced;
+    t->consumed.store(produced);
+}
+
+static resid_thread_t *resid_thread_start(reSID::SID *sid)
+{
+    resid_thread_t *t;
+
+    if (resid_threaded_sids == RESID_MAX_THREADED_SIDS) {
+        return NULL;
+    }
+
+    t = new resid_thread_t;
+    t->sid = sid;
+    t->idle = false;
+    t->quit = false;
+    t->emu_waiting = false;
+    t->cmd_pushed = 0;
+    t->cmd_popped = 0;
+    t->fences_pushed = 0;
+    t->fences_done = 0;
+    t->produced = 0;
+    t->consumed = 0;
+    t->frame_produced = 0;
+    t->released = 0;
+    t->frame_fence = 0;
+    pthread_mutex_init(&t->mutex, NULL);
+    pthread_cond_init(&t->wake_cond, NULL);
+    pthread_cond_init(&t->done_cond, NULL);
+    if (pthread_create(&t->thread, NULL, resid_thread_main, t) != 0) {
+        log_warning(LOG_DEFAULT, "reSID: unable to create thread, running inline");
+        pthread_cond_destroy(&t->done_cond);
+        pthread_cond_destroy(&t->wake_cond);
+        pthread_mutex_destroy(&t->mutex);
+        delete t;
+        return NULL;
+    }
+    resid_threads[resid_threaded_sids++] = t;
+    return t;
+}
+
+static void resid_thread_stop(resid_thread_t *t)
+{
+    int i;
+
+    resid_thread_drain(t);
+    pthread_mutex_lock(&t->mutex);
+    t->quit.store(true);
+    pthread_cond_signal(&t->wake_cond);
+    pthread_mutex_unlock(&t->mutex);
+    pthread_join(t->thread, NULL);
+    pthread_cond_destroy(&t->done_cond);
+    pthread_cond_destroy(&t->wake_cond);
+    pthread_mutex_destroy(&t->mutex);
+
+    for (i = 0; i < resid_threaded_sids; i++) {
+        if (resid_threads[i] == t) {
+            resid_threads[i] = resid_threads[--resid_threaded_sids];
+            break;
+        }
+    }
+    delete t;
+}
+
+/* bring the sid state up to date before touching it from this thread */
+static void resid_sync(sound_t *psid)
+{
+    if (psid->thread) {
+        resid_thread_drain(psid->thread);
+    }
+}
+
+void resid_frame_sync(void)
+{
+    int i;
+
+    for (i = 0; i < resid_threaded_sids; i++) {
+        resid_thread_frame(resid_threads[i]);
+    }
+}
+
 static sound_t *resid_open(BYTE *sidstate)
 {
     sound_t *psid;
@@ -103,6 +411,7 @@ static sound_t *resid_open(BYTE *sidstate)
 
     psid = new sound_t;
     psid->sid = new reSID::SID;
+    psid->thread = NULL;
 
     for (i = 0x00; i <= 0x18; i++) {
         psid->sid->write(i, sidstate[i]);
@@ -117,7 +426,7 @@ static int resid_init(sound_t *psid, int speed, int cycles_per_sec, int factor)
     char model_text[100];
     char method_text[100];
     double passband, gain;
-    int filters_enabled, model, sampling, passband_percentage, gain_percentage, filter_bias_mV;
+    int filters_enabled, model, sampling, passband_percentage, gain_percentage, filter_bias_mV, threaded;
 
     if (resources_get_int("SidFilters", &filters_enabled) < 0) {
         return 0;
@@ -143,6 +452,15 @@ static int resid_init(sound_t *psid, int speed, int cycles_per_sec, int factor)
         return 0;
     }
 
+    if (resources_get_int("SidResidThreaded", &threaded) < 0) {
+        return 0;
+    }
+
+    if (psid->thread) {
+        resid_thread_stop(psid->thread);
+        psid->thread = NULL;
+    }
+
     passband = speed * passband_percentage / 200.0;
     gain = gain_percentage / 100.0;
 
@@ -212,16 +530,25 @@ static int resid_init(sound_t *psid, int speed, int cycles_per_sec, int factor)
         return 0;
     }
 
-    log_message(LOG_DEFAULT, "reSID: %s, filter %s, sampling rate %dHz - %s",
+    /* the worker renders at the nominal rate only */
+    if (threaded && factor == 1000) {
+        psid->thread = resid_thread_start(psid->sid);
+    }
+
+    log_message(LOG_DEFAULT, "reSID: %s, filter %s, sampling rate %dHz - %s%s",
                 model_text,
                 filters_enabled ? "on" : "off",
-                speed, method_text);
+                speed, method_text,
+                psid->thread ? ", threaded" : "");
 
     return 1;
 }
 
 static void resid_close(sound_t *psid)
 {
+    if (psid->thread) {
+        resid_thread_stop(psid->thread);
+    }
     delete psid->sid;
     delete psid;
 
@@ -233,16 +560,25 @@ static void resid_close(sound_t *psid)
 
 static BYTE resid_read(sound_t *psid, WORD addr)
 {
+    resid_sync(psid);
     return psid->sid->read(addr);
 }
 
 static void resid_store(sound_t *psid, WORD addr, BYTE byte)
 {
+    if (psid->thread) {
+        resid_thread_push(psid->thread, RESID_CMD_WRITE, 0, (BYTE)addr, byte);
+        return;
+    }
     psid->sid->write(addr, byte);
 }
 
 static void resid_reset(sound_t *psid, CLOCK cpu_clk)
 {
+    if (psid->thread) {
+        resid_thread_drain(psid->thread);
+        resid_thread_discard_samples(psid->thread);
+    }
     psid->sid->reset();
 }
 
@@ -252,6 +588,13 @@ static int resid_calculate_samples(sound_t *psid, SWORD *pbuf, int nr,
     SWORD *tmp_buf;
     int retval;
 
+    if (psid->thread) {
+        if (*delta_t > 0) {
+            resid_thread_push(psid->thread, RESID_CMD_CLOCK, *delta_t, 0, 0);
+            *delta_t = 0;
+        }
+        return resid_thread_read_samples(psid->thread, pbuf, nr, interleave);
+    }
     if (psid->factor == 1000) {
         return psid->sid->clock(*delta_t, pbuf, nr, interleave);
     }
@@ -275,6 +618,7 @@ static void resid_state_read(sound_t *psid, sid_snapshot_state_t *sid_state)
     reSID::SID::State state;
     unsigned int i;
 
+    resid_sync(psid);
     state = psid->sid->read_state();
 
     for (i = 0; i < 0x20; i++) {
@@ -339,6 +683,7 @@ static void resid_state_write(sound_t *psid, sid_snapshot_state_t *sid_state)
     state.write_address = (reg8)sid_state->write_address;
     state.voice_mask = (reg4)sid_state->voice_mask;
 
+    resid_sync(psid);
     psid->sid->write_state((const reSID::SID::State)state);
 }
 
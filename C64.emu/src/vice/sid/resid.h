@@ -31,4 +31,8 @@
 
 extern sid_engine_t resid_hooks;
 
+/* Releases the samples threaded reSID instances rendered for the
+   previous frame, call once per frame before sound_flush(). */
+extern void resid_frame_sync(void);
+
 #endif
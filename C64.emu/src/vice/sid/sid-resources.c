@@ -60,6 +60,7 @@ static int sid_resid_sampling;
 static int sid_resid_passband;
 static int sid_resid_gain;
 static int sid_resid_filter_bias;
+static int sid_resid_threaded;
 #endif
 int sid_stereo = 0;
 int checking_sid_stereo;
@@ -293,6 +294,13 @@ static int set_sid_resid_filter_bias(int i, void *param)
     return 0;
 }
 
+static int set_sid_resid_threaded(int val, void *param)
+{
+    sid_resid_threaded = val ? 1 : 0;
+    sid_state_changed = 1;
+    return 0;
+}
+
 #endif
 
 #ifdef HAVE_HARDSID
@@ -323,6 +331,8 @@ static const resource_int_t resid_resources_int[] = {
       &sid_resid_gain, set_sid_resid_gain, NULL },
     { "SidResidFilterBias", 500, RES_EVENT_NO, NULL,
       &sid_resid_filter_bias, set_sid_resid_filter_bias, NULL },
+    { "SidResidThreaded", 0, RES_EVENT_NO, NULL,
+      &sid_resid_threaded, set_sid_resid_threaded, NULL },
     { NULL }
 };
 #endif
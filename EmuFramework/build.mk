@@ -27,7 +27,13 @@ EmuVideo.cc \
 EmuInputView.cc \
 EmuVideoLayer.cc \
 Cheats.cc \
-Recent.cc
+Recent.cc \
+InputLatency.cc \
+FrameProfiler.cc \
+ArchiveCache.cc \
+AudioTimeStretch.cc \
+StartupTrace.cc \
+InitTaskGraph.cc
 
 ifeq ($(emuFramework_onScreenControls), 1)
  SRC += TouchConfigView.cc \
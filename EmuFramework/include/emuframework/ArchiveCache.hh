@@ -0,0 +1,44 @@
+#pragma once
+
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <imagine/io/FileIO.hh>
+#include <imagine/fs/FS.hh>
+
+// On-disk cache of game files extracted from archives, keyed by the
+// archive's path, size, and modification time. The entry name isn't part
+// of the key since the cache is checked before opening the archive, an
+// unchanged archive always yields the same game entry. The least recently
+// used entries are removed once the cache grows past maxSize().
+
+namespace ArchiveCache
+{
+
+static constexpr off_t DEFAULT_MAX_SIZE = 512 * 1024 * 1024;
+
+// 0 disables the cache, trim removes entries over the new size right away
+void setMaxSize(off_t size, bool trim = false);
+off_t maxSize();
+
+// Opens the cached copy of the game file in the archive and returns its name in entryName,
+// returns an unopened FileIO if not cached
+FileIO open(const char *archivePath, FS::FileString &entryName);
+
+// Extracts the remaining data of io into the cache, returns an unopened FileIO on error,
+// in which case io may have been partially read
+FileIO add(const char *archivePath, IO &io, const char *entryName);
+
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <imagine/engine-globals.h>
+#include <imagine/util/audio/PcmFormat.hh>
+#include <vector>
+
+// Shortens 16-bit PCM by a speed factor without changing its pitch using
+// WSOLA (waveform similarity overlap-add), so audio stays audible while
+// fast-forwarding
+
+class AudioTimeStretcher
+{
+public:
+	AudioTimeStretcher() {}
+	// a speed of 1 disables stretching
+	void setSpeed(uint speed);
+	uint speed() const { return speed_; }
+	bool isActive() const { return speed_ > 1; }
+	void reset();
+	// stretches the samples and passes the result to Audio::writePcm()
+	void write(const void *samples, uint frames);
+
+private:
+	Audio::PcmFormat format{};
+	uint speed_ = 1;
+	uint segFrames = 0; // length of each output segment, also the cross-fade length
+	uint seekFrames = 0; // search range around the nominal input position
+	double pos = 0; // nominal input position of the next segment
+	std::vector<int16> in{};
+	std::vector<int16> overlap{}; // input following the last output segment
+	std::vector<int16> out{};
+
+	void init();
+	uint bestSegmentPos(uint nominalPos) const;
+};
+
+extern AudioTimeStretcher audioTimeStretcher;
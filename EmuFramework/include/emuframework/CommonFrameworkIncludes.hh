@@ -2,6 +2,7 @@
 
 #include <emuframework/CreditsView.hh>
 #include <emuframework/Option.hh>
+#include <emuframework/FrameProfiler.hh>
 
 #include <imagine/logger/logger.h>
 #include <imagine/gfx/GfxSprite.hh>
@@ -97,5 +97,12 @@ void placeEmuViews();
 void placeElements();
 void startViewportAnimation(AppWindowData &winData);
 void updateAndDrawEmuVideo();
+// apply the thread CPU & priority options, the emulation one to the calling thread
+void applyEmuThreadScheduling();
+// for threads a core runs emulation on besides the main one, call before each
+// unit of work: follows the emulation thread option while emulating and resets
+// to normal scheduling once it stops, since the main thread may spin on them
+void updateEmuWorkerThreadScheduling();
+void applyAudioThreadScheduling();
 
 static constexpr const char *strftimeFormat = "%x  %r";
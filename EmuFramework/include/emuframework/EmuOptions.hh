@@ -72,6 +72,10 @@ extern Byte1Option optionHideStatusBar;
 extern OptionSwappedGamepadConfirm optionSwappedGamepadConfirm;
 extern Byte1Option optionConfirmOverwriteState;
 extern Byte1Option optionFastForwardSpeed;
+static constexpr uint ARCHIVE_CACHE_SIZE_UNIT = 64 * 1024 * 1024;
+extern Byte1Option optionArchiveCacheSize; // in ARCHIVE_CACHE_SIZE_UNITs, 0 disables the cache
+// runs as many frames as fit in each screen refresh
+static constexpr uint FAST_FORWARD_SPEED_AUTO = 8;
 #ifdef CONFIG_INPUT_DEVICE_HOTSWAP
 extern Byte1Option optionNotifyInputDeviceChange;
 #endif
@@ -127,6 +131,8 @@ extern OptionVControllerLayoutPosition optionVControllerLayoutPos;
 extern Byte1Option optionFrameInterval;
 #endif
 extern Byte1Option optionSkipLateFrames;
+extern Byte1Option optionFrameDelay;
+extern Byte1Option optionSkipUnchangedFrames;
 extern DoubleOption optionFrameRate;
 extern DoubleOption optionFrameRatePAL;
 extern DoubleOption optionRefreshRateOverride;
@@ -150,6 +156,17 @@ extern SByte1Option optionProcessPriority;
 extern Byte1Option optionManageCPUFreq;
 #endif
 
+#ifdef CONFIG_THREAD_SCHEDULING_HINTS
+static constexpr uint8 OPTION_THREAD_CPUS_ANY = 0;
+static constexpr uint8 OPTION_THREAD_CPUS_PERFORMANCE = 1;
+static constexpr uint8 OPTION_THREAD_CPUS_EFFICIENCY = 2;
+static constexpr uint8 OPTION_THREAD_CPUS_MAX_VALUE = OPTION_THREAD_CPUS_EFFICIENCY;
+extern Byte1Option optionEmuThreadCPUs;
+extern Byte1Option optionAudioThreadCPUs;
+extern Byte1Option optionRealtimeThreads;
+IG::SchedulingHint makeThreadSchedulingHint(uint8 cpus, int realtimePriority);
+#endif
+
 extern Byte1Option optionDitherImage;
 
 #if defined CONFIG_BASE_X11 || (defined CONFIG_BASE_ANDROID && !defined CONFIG_MACHINE_OUYA) || defined CONFIG_BASE_IOS
@@ -162,6 +179,8 @@ extern PathOption optionSavePath;
 extern Byte1Option optionCheckSavePathWriteAccess;
 
 extern Byte1Option optionShowBundledGames;
+extern Byte1Option optionShowInputLatency;
+extern Byte1Option optionShowFrameProfiler;
 
 // Common options handled per-emulator backend
 extern PathOption optionFirmwarePath;
@@ -152,6 +152,10 @@ public:
 	static void stopSound();
 	static void startSound();
 	static void writeSound(const void *samples, uint framesToWrite);
+	// Returns room for maxFrames of audio, taken directly from the backend's
+	// output ring when possible so cores can mix without an extra copy.
+	// Always pass it to commitSound() with the frames actually written.
+	static Audio::BufferContext getSoundBuffer(uint maxFrames, bool renderAudio = true);
 	static void commitSound(Audio::BufferContext buffer, uint frames);
 	static uint advanceFramesWithTime(Base::FrameTimeBase time);
 	static void setupGamePaths(const char *filePath);
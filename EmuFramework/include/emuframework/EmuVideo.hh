@@ -16,6 +16,7 @@
 	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
 
 #include <imagine/gfx/Texture.hh>
+#include <memory>
 
 class EmuVideo
 {
@@ -24,6 +25,10 @@ public:
 	IG::Pixmap vidPix{};
 	char *pixBuff{};
 	uint vidPixAlign = Gfx::Texture::MAX_ASSUME_ALIGN;
+	Gfx::LockedTextureBuffer frameBuff{};
+	bool lastFrameDirect = false;
+	std::unique_ptr<uint64_t[]> rowHash{};
+	uint rowHashes = 0; // 0 when the texture doesn't match vidPix
 
 public:
 	constexpr EmuVideo() {}
@@ -36,4 +41,12 @@ public:
 	void initImage(bool force, uint xO, uint yO, uint x, uint y, uint totalX, uint totalY, uint pitch = 0);
 	void takeGameScreenshot();
 	bool isExternalTexture();
+	// currently only NES.emu renders through startFrame(), other cores
+	// keep writing their own buffer and have it copied in updateImage()
+	IG::Pixmap startFrame();
+	bool updateImage();
+
+private:
+	void cancelFrame();
+	bool findChangedRows(uint &firstRow, uint &endRow);
 };
@@ -0,0 +1,102 @@
+#pragma once
+
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <imagine/time/Time.hh>
+#include <imagine/gfx/GfxText.hh>
+#include <imagine/gfx/ProjectionPlane.hh>
+#include <array>
+#include <atomic>
+
+#ifndef NDEBUG
+#define CONFIG_EMUFRAMEWORK_FRAME_PROFILER
+#endif
+
+class FrameProfiler
+{
+public:
+	// scope times are inclusive, so RUN_FRAME also counts any nested scopes
+	enum Scope : uint8
+	{
+		RUN_FRAME, VIDEO_CONVERT, TEXTURE_UPLOAD, AUDIO_WRITE, INPUT, DRAW_FRAME,
+		// optionally marked by cores
+		CORE_CPU, CORE_VIDEO, CORE_SOUND,
+		SCOPES
+	};
+
+	constexpr FrameProfiler() {}
+	void setEnabled(bool on);
+	bool isEnabled() const { return enabled; }
+	void reset();
+	// safe to call from any thread
+	void add(Scope scope, IG::Time time)
+	{
+		frameNSecs[scope].fetch_add(time.nSecs(), std::memory_order_relaxed);
+	}
+	void endFrame();
+	void logStats();
+	bool writeStats(const char *path);
+	void place(const Gfx::ProjectionPlane &projP);
+	void draw();
+	static const char *scopeName(Scope scope);
+
+private:
+	static constexpr uint HISTORY_FRAMES = 120;
+	static constexpr uint OVERLAY_UPDATE_FRAMES = 30;
+	std::array<std::atomic<uint64_t>, SCOPES> frameNSecs{};
+	// per-frame microseconds of each scope, plus the frame interval in the last slot
+	std::array<std::array<uint32, HISTORY_FRAMES>, SCOPES + 1> history{};
+	std::array<uint64_t, SCOPES> totalUSecs{};
+	std::array<uint32, SCOPES> maxUSecs{};
+	uint historyIdx = 0;
+	uint historyFrames = 0;
+	uint frames = 0;
+	IG::Time lastFrame{};
+	bool enabled = false;
+	uint framesSinceOverlayUpdate = 0;
+	Gfx::Text text{};
+	Gfx::ProjectionPlane projP{};
+	std::array<char, 512> str{};
+
+	uint percentileUSecs(uint historyRow, uint percent) const;
+	void updateOverlayText();
+};
+
+extern FrameProfiler frameProfiler;
+
+class FrameProfileScope
+{
+public:
+	FrameProfileScope(FrameProfiler::Scope scope):
+		scope{scope}, start{frameProfiler.isEnabled() ? IG::Time::now() : IG::Time{}}
+	{}
+
+	~FrameProfileScope()
+	{
+		if(start.nSecs())
+			frameProfiler.add(scope, IG::Time::now() - start);
+	}
+
+private:
+	FrameProfiler::Scope scope;
+	IG::Time start;
+};
+
+#ifdef CONFIG_EMUFRAMEWORK_FRAME_PROFILER
+#define EMU_PROFILE_SCOPE(scope) FrameProfileScope frameProfileScope{FrameProfiler::scope}
+#else
+#define EMU_PROFILE_SCOPE(scope)
+#endif
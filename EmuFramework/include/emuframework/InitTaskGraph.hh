@@ -0,0 +1,59 @@
+#pragma once
+
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <imagine/engine-globals.h>
+#include <imagine/thread/Thread.hh>
+#include <imagine/util/DelegateFunc.hh>
+#include <array>
+
+// Runs a set of init steps, letting steps marked as thread-safe run on
+// the shared task pool once the steps they depend on have finished
+class InitTaskGraph
+{
+public:
+	using TaskId = uint;
+	using TaskFunc = DelegateFunc<void ()>;
+	static constexpr uint MAX_TASKS = 16;
+
+	InitTaskGraph() {}
+	// deps is a mask made with dep(), tasks only depend on previously added ones
+	TaskId add(const char *name, TaskFunc func, uint32 deps = 0, bool anyThread = false);
+	static constexpr uint32 dep(TaskId id) { return 1 << id; }
+	// returns once all tasks have finished
+	void run();
+
+private:
+	struct Task
+	{
+		const char *name{};
+		TaskFunc func{};
+		uint32 deps = 0;
+		bool anyThread = false;
+	};
+
+	std::array<Task, MAX_TASKS> task{};
+	uint tasks = 0;
+	uint32 startedMask = 0;
+	uint32 doneMask = 0;
+	IG::Mutex mutex{};
+	IG::ConditionVar cond{};
+
+	int nextReadyTask(bool onMainThread) const;
+	void runTask(uint idx);
+	bool runNextTask(bool onMainThread);
+	void runWorker();
+};
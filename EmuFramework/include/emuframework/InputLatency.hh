@@ -0,0 +1,90 @@
+#pragma once
+
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <imagine/time/Time.hh>
+#include <imagine/input/Input.hh>
+#include <imagine/input/Time.hh>
+#include <imagine/gfx/GfxText.hh>
+#include <imagine/gfx/ProjectionPlane.hh>
+#include <array>
+
+class LatencyHistogram
+{
+public:
+	// 0.5ms buckets, the last one collects everything above the range
+	static constexpr uint BUCKETS = 128;
+	static constexpr uint BUCKET_USECS = 500;
+
+	constexpr LatencyHistogram() {}
+	void add(IG::Time time);
+	void reset();
+	uint samples() const { return samples_; }
+	uint avgUSecs() const;
+	uint maxUSecs() const { return maxUSecs_; }
+	uint percentileUSecs(uint percent) const;
+	uint bucketSamples(uint idx) const { return bucket[idx]; }
+
+private:
+	std::array<uint32, BUCKETS> bucket{};
+	uint samples_ = 0;
+	uint maxUSecs_ = 0;
+	uint64_t totalUSecs = 0;
+};
+
+class InputLatencyTracer
+{
+public:
+	struct TraceEntry
+	{
+		IG::Time input{};
+		IG::Time frameEmulated{};
+		IG::Time framePresented{};
+	};
+
+	LatencyHistogram inputToFrame{};
+	LatencyHistogram frameToSwap{};
+
+	constexpr InputLatencyTracer() {}
+	void setEnabled(bool on);
+	bool isEnabled() const { return enabled; }
+	void reset();
+	void addInput(Input::Time time);
+	void markFrameEmulated();
+	void markFramePresented();
+	void logStats();
+	bool writeStats(const char *path);
+	void place(const Gfx::ProjectionPlane &projP);
+	void draw();
+
+private:
+	static constexpr uint TRACE_ENTRIES = 256;
+	static constexpr uint OVERLAY_UPDATE_FRAMES = 30;
+	std::array<TraceEntry, TRACE_ENTRIES> trace{};
+	uint traceIdx = 0;
+	IG::Time pendingInput{};
+	IG::Time frameEmulated{};
+	bool enabled = false;
+	bool frameHasInput = false;
+	uint framesSinceOverlayUpdate = 0;
+	Gfx::Text text{};
+	Gfx::ProjectionPlane projP{};
+	std::array<char, 192> str{};
+
+	void updateOverlayText();
+};
+
+extern InputLatencyTracer inputLatency;
@@ -40,6 +40,7 @@ public:
 	void post(const char *msg, int secs = 3, bool error = false);
 	void postError(const char *msg, int secs = 3);
 	void draw();
+	bool isVisible() const { return str[0]; }
 
 	[[gnu::format(printf, 4, 5)]]
 	void printf(uint secs, bool error, const char *format, ...);
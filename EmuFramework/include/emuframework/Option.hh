@@ -294,7 +294,11 @@ enum { CFGKEY_SOUND = 0, CFGKEY_TOUCH_CONTROL_DISPLAY = 1,
 	CFGKEY_CHECK_SAVE_PATH_WRITE_ACCESS = 74, CFGKEY_IMAGE_EFFECT_PIXEL_FORMAT = 75,
 	CFGKEY_SKIP_LATE_FRAMES = 76, CFGKEY_FRAME_RATE = 77,
 	CFGKEY_FRAME_RATE_PAL = 78, CFGKEY_TIME_FRAMES_WITH_SCREEN_REFRESH = 79,
-	CFGKEY_MANAGE_CPU_FREQ = 80
+	CFGKEY_MANAGE_CPU_FREQ = 80, CFGKEY_SHOW_INPUT_LATENCY = 81,
+	CFGKEY_FRAME_DELAY = 82, CFGKEY_SKIP_UNCHANGED_FRAMES = 83,
+	CFGKEY_SHOW_FRAME_PROFILER = 84, CFGKEY_EMU_THREAD_CPUS = 85,
+	CFGKEY_AUDIO_THREAD_CPUS = 86, CFGKEY_REALTIME_THREADS = 87,
+	CFGKEY_ARCHIVE_CACHE_SIZE = 88
 	// 256+ is reserved
 };
 
@@ -23,6 +23,7 @@
 #include <imagine/audio/Audio.hh>
 #include <emuframework/EmuInput.hh>
 #include <emuframework/EmuOptions.hh>
+#include <emuframework/FrameProfiler.hh>
 #include <emuframework/EmuApp.hh>
 #include <emuframework/FilePicker.hh>
 void onCloseModalPopWorkDir(Input::Event e);
@@ -41,6 +42,8 @@ protected:
 	void frameIntervalInit();
 	#endif
 	BoolMenuItem dropLateFrames{};
+	BoolMenuItem frameDelay{};
+	BoolMenuItem skipUnchangedFrames{};
 	char frameRateStr[64]{};
 	TextMenuItem frameRate;
 	char frameRatePALStr[64]{};
@@ -104,11 +107,22 @@ protected:
 	static constexpr uint MIN_FAST_FORWARD_SPEED = 2;
 	void fastForwardSpeedinit();
 	MultiChoiceSelectMenuItem fastForwardSpeed;
+	void archiveCacheSizeInit();
+	MultiChoiceSelectMenuItem archiveCacheSize;
 	#if defined __ANDROID__
 	void processPriorityInit();
 	MultiChoiceSelectMenuItem processPriority;
 	BoolMenuItem manageCPUFreq;
 	#endif
+	#ifdef CONFIG_THREAD_SCHEDULING_HINTS
+	MultiChoiceSelectMenuItem emuThreadCPUs;
+	MultiChoiceSelectMenuItem audioThreadCPUs;
+	BoolMenuItem realtimeThreads;
+	#endif
+	BoolMenuItem showInputLatency;
+	#ifdef CONFIG_EMUFRAMEWORK_FRAME_PROFILER
+	BoolMenuItem showFrameProfiler;
+	#endif
 
 	// GUI
 	BoolMenuItem pauseUnfocused;
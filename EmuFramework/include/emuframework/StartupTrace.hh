@@ -0,0 +1,61 @@
+#pragma once
+
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <imagine/engine-globals.h>
+#include <imagine/time/Time.hh>
+#include <array>
+#include <atomic>
+
+class StartupTracer
+{
+public:
+	class Phase
+	{
+	public:
+		Phase(StartupTracer &tracer, const char *name);
+		~Phase();
+
+	private:
+		StartupTracer &tracer;
+		const char *name;
+		IG::Time start;
+	};
+
+	constexpr StartupTracer() {}
+	void begin();
+	// safe to call from any thread until the first frame
+	void addPhase(const char *name, IG::Time start, IG::Time end);
+	void markFirstFrame();
+	bool isDone() const { return done; }
+
+private:
+	struct PhaseEntry
+	{
+		const char *name{};
+		IG::Time start{};
+		IG::Time duration{};
+		bool mainThread = false;
+	};
+
+	static constexpr uint MAX_PHASES = 32;
+	std::array<PhaseEntry, MAX_PHASES> phase{};
+	std::atomic<uint> phases{};
+	IG::Time startTime{};
+	bool done = false;
+};
+
+extern StartupTracer startupTrace;
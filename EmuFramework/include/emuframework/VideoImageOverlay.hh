@@ -40,4 +40,7 @@ public:
 	void setEffect(uint effect);
 	void place(const Gfx::Sprite &disp, uint lines);
 	void draw();
+
+private:
+	void initImage();
 };
@@ -0,0 +1,220 @@
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <emuframework/ArchiveCache.hh>
+#include <imagine/fs/FileCache.hh>
+#include <imagine/logger/logger.h>
+#include <imagine/util/strings.h>
+#include <algorithm>
+#include <vector>
+#include <cstdio>
+
+namespace ArchiveCache
+{
+
+// Each entry is stored as <key>.rom with a <key>.info file holding the
+// archive's path, size, mtime, and the entry's name. The info file is
+// rewritten on every use so its mtime orders entries for eviction.
+
+static const char infoMagic[4] {'A', 'C', 'I', '1'};
+static off_t maxSize_ = DEFAULT_MAX_SIZE;
+
+struct ArchiveKey
+{
+	FS::PathString path{};
+	uint64_t size = 0;
+	int64_t mTime = 0;
+	uint64_t hash = 0;
+};
+
+static FS::PathString cacheDir()
+{
+	return FileCache::dirPath(".archiveCache");
+}
+
+static bool makeKey(const char *archivePath, ArchiveKey &key)
+{
+	CallResult res = OK;
+	auto status = FS::status(archivePath, res);
+	if(res != OK)
+		return false;
+	string_copy(key.path, archivePath);
+	key.size = status.size();
+	key.mTime = status.last_write_time();
+	key.hash = FileCache::fnv1a(archivePath);
+	key.hash = FileCache::fnv1a(&key.size, sizeof(key.size), key.hash);
+	key.hash = FileCache::fnv1a(&key.mTime, sizeof(key.mTime), key.hash);
+	return true;
+}
+
+static FS::PathString entryPath(const ArchiveKey &key, const char *ext)
+{
+	return FS::makePathStringPrintf("%s/%016llx.%s", cacheDir().data(), (unsigned long long)key.hash, ext);
+}
+
+static bool writeInfo(const ArchiveKey &key, const char *entryName)
+{
+	uint16 pathLen = strlen(key.path.data());
+	uint16 nameLen = strlen(entryName);
+	std::vector<char> buff{infoMagic, infoMagic + sizeof(infoMagic)};
+	auto append =
+		[&buff](const void *data, size_t size)
+		{
+			buff.insert(buff.end(), (const char*)data, (const char*)data + size);
+		};
+	append(&key.size, sizeof(key.size));
+	append(&key.mTime, sizeof(key.mTime));
+	append(&pathLen, sizeof(pathLen));
+	append(key.path.data(), pathLen);
+	append(&nameLen, sizeof(nameLen));
+	append(entryName, nameLen);
+	return writeToNewFile(entryPath(key, "info").data(), buff.data(), buff.size()) == OK;
+}
+
+static bool readInfo(const ArchiveKey &key, FS::FileString &entryName)
+{
+	FileIO file;
+	if(file.open(entryPath(key, "info")) != OK)
+		return false;
+	char magic[sizeof(infoMagic)];
+	uint64_t size;
+	int64_t mTime;
+	uint16 pathLen;
+	FS::PathString path{};
+	if(file.readAll(magic, sizeof(magic)) != OK || memcmp(magic, infoMagic, sizeof(magic)) != 0
+		|| file.readAll(&size, sizeof(size)) != OK || size != key.size
+		|| file.readAll(&mTime, sizeof(mTime)) != OK || mTime != key.mTime
+		|| file.readAll(&pathLen, sizeof(pathLen)) != OK || pathLen >= path.size()
+		|| file.readAll(path.data(), pathLen) != OK || strcmp(path.data(), key.path.data()) != 0)
+	{
+		return false;
+	}
+	uint16 nameLen;
+	entryName = {};
+	if(file.readAll(&nameLen, sizeof(nameLen)) != OK || nameLen >= entryName.size()
+		|| file.readAll(entryName.data(), nameLen) != OK)
+	{
+		return false;
+	}
+	return true;
+}
+
+static void removeEntry(const char *infoPath)
+{
+	auto romPath = FS::makePathString(infoPath);
+	strcpy(strrchr(romPath.data(), '.'), ".rom");
+	FS::remove(romPath);
+	FS::remove(infoPath);
+}
+
+static void evict(off_t sizeNeeded)
+{
+	// entries are sized by their .rom file and ordered by their .info file's last rewrite
+	FileCache::evict(cacheDir().data(), "info", maxSize_, sizeNeeded,
+		[](const char *infoPath) -> off_t
+		{
+			auto romPath = FS::makePathString(infoPath);
+			strcpy(strrchr(romPath.data(), '.'), ".rom");
+			CallResult res = OK;
+			auto status = FS::status(romPath, res);
+			return res == OK ? (off_t)status.size() : -1;
+		},
+		[](const char *infoPath)
+		{
+			removeEntry(infoPath);
+		});
+}
+
+void setMaxSize(off_t size, bool trim)
+{
+	maxSize_ = size;
+	if(trim && FS::exists(cacheDir()))
+		evict(0);
+}
+
+off_t maxSize()
+{
+	return maxSize_;
+}
+
+FileIO open(const char *archivePath, FS::FileString &entryName)
+{
+	if(!maxSize_)
+		return {};
+	ArchiveKey key;
+	if(!makeKey(archivePath, key) || !readInfo(key, entryName))
+		return {};
+	FileIO io;
+	if(io.open(entryPath(key, "rom")) != OK)
+	{
+		removeEntry(entryPath(key, "info").data());
+		return {};
+	}
+	// refresh the entry's position in the LRU order
+	writeInfo(key, entryName.data());
+	return io;
+}
+
+FileIO add(const char *archivePath, IO &io, const char *entryName)
+{
+	ArchiveKey key;
+	if(!maxSize_ || !makeKey(archivePath, key))
+		return {};
+	off_t size = io.size();
+	if(size > maxSize_)
+	{
+		logMsg("%s too large to cache", entryName);
+		return {};
+	}
+	FS::create_directory(cacheDir());
+	evict(size);
+	auto tempPath = entryPath(key, "tmp");
+	{
+		FileIO file;
+		if(file.create(tempPath) != OK)
+		{
+			logErr("error creating archive cache file:%s", tempPath.data());
+			return {};
+		}
+		std::vector<char> buff(64 * 1024);
+		off_t bytesLeft = size;
+		while(bytesLeft)
+		{
+			auto bytes = io.read(buff.data(), std::min((off_t)buff.size(), bytesLeft));
+			if(bytes <= 0 || file.write(buff.data(), bytes) != bytes)
+			{
+				logErr("error extracting %s to archive cache", entryName);
+				file.close();
+				FS::remove(tempPath);
+				return {};
+			}
+			bytesLeft -= bytes;
+		}
+	}
+	auto romPath = entryPath(key, "rom");
+	if(::rename(tempPath.data(), romPath.data()) != 0 || !writeInfo(key, entryName))
+	{
+		logErr("error adding %s to archive cache", entryName);
+		FS::remove(tempPath);
+		FS::remove(romPath);
+		return {};
+	}
+	logMsg("cached archive entry %s as %s", entryName, romPath.data());
+	FileIO cachedIO;
+	cachedIO.open(romPath);
+	return cachedIO;
+}
+
+}
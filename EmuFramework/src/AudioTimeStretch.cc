@@ -0,0 +1,130 @@
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <emuframework/AudioTimeStretch.hh>
+#include <emuframework/EmuSystem.hh>
+#include <imagine/audio/Audio.hh>
+#include <imagine/logger/logger.h>
+#include <cmath>
+
+AudioTimeStretcher audioTimeStretcher;
+
+void AudioTimeStretcher::setSpeed(uint speed)
+{
+	speed = std::max(speed, 1u);
+	if(speed == speed_)
+		return;
+	if(speed_ == 1 || speed == 1)
+		reset();
+	speed_ = speed;
+}
+
+void AudioTimeStretcher::reset()
+{
+	in.clear();
+	overlap.clear();
+	pos = 0;
+}
+
+void AudioTimeStretcher::init()
+{
+	format = EmuSystem::pcmFormat;
+	// 10ms segments searched within +/-5ms
+	segFrames = format.rate / 100;
+	seekFrames = format.rate / 200;
+	reset();
+	logMsg("time stretching with %u frame segments", segFrames);
+}
+
+// Find the input segment near nominalPos that best continues the previous
+// output, using a normalized cross-correlation of decimated mono samples
+uint AudioTimeStretcher::bestSegmentPos(uint nominalPos) const
+{
+	static constexpr uint FRAME_STEP = 4, POS_STEP = 2;
+	const uint ch = format.channels;
+	uint start = nominalPos > seekFrames ? nominalPos - seekFrames : 0;
+	uint end = nominalPos + seekFrames;
+	uint bestPos = nominalPos;
+	double bestScore = -2;
+	for(uint p = start; p <= end; p += POS_STEP)
+	{
+		int64_t corr = 0, energy = 0;
+		for(uint i = 0; i < segFrames; i += FRAME_STEP)
+		{
+			int a = overlap[i * ch], b = in[(p + i) * ch];
+			if(ch == 2)
+			{
+				a += overlap[i * ch + 1];
+				b += in[(p + i) * ch + 1];
+			}
+			corr += a * b;
+			energy += b * b;
+		}
+		double score = corr / std::sqrt((double)energy + 1.);
+		if(score > bestScore)
+		{
+			bestScore = score;
+			bestPos = p;
+		}
+	}
+	return bestPos;
+}
+
+void AudioTimeStretcher::write(const void *samples, uint frames)
+{
+	if(EmuSystem::pcmFormat.sample.toBytes() != 2 || EmuSystem::pcmFormat.channels > 2)
+		return; // only 16-bit mono/stereo is supported, drop audio otherwise
+	if(format != EmuSystem::pcmFormat)
+		init();
+	const uint ch = format.channels;
+	auto s = (const int16*)samples;
+	in.insert(in.end(), s, s + frames * ch);
+	uint inFrames = in.size() / ch;
+	out.clear();
+	if(overlap.empty())
+	{
+		// pass the first segment through as-is
+		if(inFrames < segFrames * 2)
+			return;
+		out.insert(out.end(), in.begin(), in.begin() + segFrames * ch);
+		overlap.assign(in.begin() + segFrames * ch, in.begin() + segFrames * 2 * ch);
+		pos = segFrames * speed_;
+	}
+	while(std::lround(pos) + seekFrames + segFrames * 2 <= inFrames)
+	{
+		uint segPos = bestSegmentPos(std::lround(pos));
+		// cross-fade from the previous segment's continuation into the new segment
+		iterateTimes(segFrames, i)
+		{
+			iterateTimes(ch, c)
+			{
+				int prev = overlap[i * ch + c], next = in[(segPos + i) * ch + c];
+				out.push_back((prev * (int)(segFrames - i) + next * (int)i) / (int)segFrames);
+			}
+		}
+		overlap.assign(in.begin() + (segPos + segFrames) * ch, in.begin() + (segPos + segFrames * 2) * ch);
+		pos += segFrames * speed_;
+	}
+	// drop input that can no longer be searched
+	int consumed = std::lround(pos) - (int)seekFrames;
+	if(consumed > 0)
+	{
+		uint dropFrames = std::min((uint)consumed, inFrames);
+		in.erase(in.begin(), in.begin() + dropFrames * ch);
+		pos -= dropFrames;
+	}
+	if(out.size())
+		Audio::writePcm(out.data(), out.size() / ch);
+}
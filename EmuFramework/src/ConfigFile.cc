@@ -189,6 +189,8 @@ static bool readConfig2(IO &io)
 			bcase CFGKEY_FRAME_INTERVAL: optionFrameInterval.readFromIO(io, size);
 			#endif
 			bcase CFGKEY_SKIP_LATE_FRAMES: optionSkipLateFrames.readFromIO(io, size);
+			bcase CFGKEY_FRAME_DELAY: optionFrameDelay.readFromIO(io, size);
+			bcase CFGKEY_SKIP_UNCHANGED_FRAMES: optionSkipUnchangedFrames.readFromIO(io, size);
 			bcase CFGKEY_FRAME_RATE: optionFrameRate.readFromIO(io, size);
 			bcase CFGKEY_FRAME_RATE_PAL: optionFrameRatePAL.readFromIO(io, size);
 			#if defined(CONFIG_BASE_ANDROID)
@@ -236,6 +238,7 @@ static bool readConfig2(IO &io)
 			bcase CFGKEY_HIDE_STATUS_BAR: optionHideStatusBar.readFromIO(io, size);
 			bcase CFGKEY_CONFIRM_OVERWRITE_STATE: optionConfirmOverwriteState.readFromIO(io, size);
 			bcase CFGKEY_FAST_FORWARD_SPEED: optionFastForwardSpeed.readFromIO(io, size);
+			bcase CFGKEY_ARCHIVE_CACHE_SIZE: optionArchiveCacheSize.readFromIO(io, size);
 			#ifdef CONFIG_INPUT_DEVICE_HOTSWAP
 			bcase CFGKEY_NOTIFY_INPUT_DEVICE_CHANGE: optionNotifyInputDeviceChange.readFromIO(io, size);
 			#endif
@@ -250,6 +253,11 @@ static bool readConfig2(IO &io)
 			bcase CFGKEY_PROCESS_PRIORITY: optionProcessPriority.readFromIO(io, size);
 			bcase CFGKEY_MANAGE_CPU_FREQ: optionManageCPUFreq.readFromIO(io, size);
 			#endif
+			#ifdef CONFIG_THREAD_SCHEDULING_HINTS
+			bcase CFGKEY_EMU_THREAD_CPUS: optionEmuThreadCPUs.readFromIO(io, size);
+			bcase CFGKEY_AUDIO_THREAD_CPUS: optionAudioThreadCPUs.readFromIO(io, size);
+			bcase CFGKEY_REALTIME_THREADS: optionRealtimeThreads.readFromIO(io, size);
+			#endif
 			#ifdef CONFIG_BLUETOOTH
 			bcase CFGKEY_KEEP_BLUETOOTH_ACTIVE: optionKeepBluetoothActive.readFromIO(io, size);
 				#ifdef CONFIG_BLUETOOTH_SCAN_CACHE_USAGE
@@ -267,6 +275,8 @@ static bool readConfig2(IO &io)
 			#endif
 			bcase CFGKEY_SAVE_PATH: logMsg("reading save path"); optionSavePath.readFromIO(io, size);
 			bcase CFGKEY_CHECK_SAVE_PATH_WRITE_ACCESS: optionCheckSavePathWriteAccess.readFromIO(io, size);
+			bcase CFGKEY_SHOW_INPUT_LATENCY: optionShowInputLatency.readFromIO(io, size);
+			bcase CFGKEY_SHOW_FRAME_PROFILER: optionShowFrameProfiler.readFromIO(io, size);
 			bcase CFGKEY_SHOW_BUNDLED_GAMES:
 			{
 				if(EmuSystem::hasBundledGames)
@@ -462,6 +472,7 @@ static OptionBase *cfgFileOption[] =
 	&optionSwappedGamepadConfirm,
 	&optionConfirmOverwriteState,
 	&optionFastForwardSpeed,
+	&optionArchiveCacheSize,
 	#ifdef CONFIG_INPUT_DEVICE_HOTSWAP
 	&optionNotifyInputDeviceChange,
 	#endif
@@ -472,6 +483,8 @@ static OptionBase *cfgFileOption[] =
 	&optionFrameInterval,
 	#endif
 	&optionSkipLateFrames,
+	&optionFrameDelay,
+	&optionSkipUnchangedFrames,
 	&optionFrameRate,
 	&optionFrameRatePAL,
 	&optionVibrateOnPush,
@@ -492,6 +505,11 @@ static OptionBase *cfgFileOption[] =
 	&optionProcessPriority,
 	&optionManageCPUFreq,
 	#endif
+	#ifdef CONFIG_THREAD_SCHEDULING_HINTS
+	&optionEmuThreadCPUs,
+	&optionAudioThreadCPUs,
+	&optionRealtimeThreads,
+	#endif
 	#ifdef CONFIG_BLUETOOTH
 	&optionKeepBluetoothActive,
 		#ifdef CONFIG_BLUETOOTH_SCAN_CACHE_USAGE
@@ -511,7 +529,9 @@ static OptionBase *cfgFileOption[] =
 	&optionWindowPixelFormat,
 	#endif
 	&optionShowBundledGames,
-	&optionCheckSavePathWriteAccess
+	&optionCheckSavePathWriteAccess,
+	&optionShowInputLatency,
+	&optionShowFrameProfiler
 };
 
 static void writeConfig2(IO &io)
@@ -20,9 +20,16 @@
 #include <emuframework/FilePicker.hh>
 #include <emuframework/ConfigFile.hh>
 #include <emuframework/EmuView.hh>
+#include <emuframework/InputLatency.hh>
+#include <emuframework/FrameProfiler.hh>
+#include <emuframework/AudioTimeStretch.hh>
+#include <emuframework/InitTaskGraph.hh>
+#include <emuframework/StartupTrace.hh>
+#include <emuframework/ArchiveCache.hh>
 #include <imagine/gui/AlertView.hh>
 #include <imagine/util/assume.h>
 #include <cmath>
+#include <atomic>
 #ifdef __ANDROID__
 #include <imagine/base/android/RootCpufreqParamSetter.hh>
 #endif
@@ -40,6 +47,17 @@ MsgPopup popup;
 BasicViewController modalViewController;
 WorkDirStack<1> workDirStack;
 static bool updateInputDevicesOnResume = false;
+static Base::Timer frameDelayTimer{};
+static uint frameDelayFrames = 0;
+static int64_t frameDelayEmuCostNs = 0; // decaying peak of per-frame emulation time
+static int64_t frameDelayMarginNs = 0;
+static uint frameDelayOnTimeFrames = 0;
+static IG::Time frameEmuStartTime{};
+static int64_t fastForwardFrameCostNs = 0;
+// set when something besides the emulated image may have changed on screen
+static bool emuWindowNeedsPresent = true;
+static bool lastPresentHadOverlay = false;
+static uint fastForwardFrames = 0;
 DelegateFunc<void ()> onUpdateInputDevices;
 #ifdef CONFIG_BLUETOOTH
 BluetoothAdapter *bta{};
@@ -103,20 +121,50 @@ void postDrawToEmuWindows()
 	emuWin->win.postDraw();
 }
 
+static bool emuVideoHasOverlay()
+{
+	return popup.isVisible() || inputLatency.isEnabled() || frameProfiler.isEnabled();
+}
+
 static void drawEmuVideo()
 {
+	emuWindowNeedsPresent = false;
+	lastPresentHadOverlay = emuVideoHasOverlay();
 	if(emuView.layer)
 		emuView.draw();
 	else if(emuView2.layer)
 		emuView2.draw();
 	popup.draw();
+	inputLatency.draw();
+	frameProfiler.draw();
 	Gfx::setClipRect(false);
 	Gfx::presentWindow(emuWin->win);
+	inputLatency.markFramePresented();
+}
+
+static void updateFrameDelayCost(int64_t costNs)
+{
+	if(costNs > frameDelayEmuCostNs)
+		frameDelayEmuCostNs = costNs;
+	else
+		frameDelayEmuCostNs -= (frameDelayEmuCostNs - costNs) / 16;
 }
 
 void updateAndDrawEmuVideo()
 {
-	emuVideo.vidImg.write(0, emuVideo.vidPix, {}, emuVideo.vidPixAlign);
+	if(frameEmuStartTime.nSecs())
+	{
+		updateFrameDelayCost((IG::Time::now() - frameEmuStartTime).nSecs());
+		frameEmuStartTime = {};
+	}
+	inputLatency.markFrameEmulated();
+	bool imageChanged = emuVideo.updateImage();
+	if(!imageChanged && optionSkipUnchangedFrames && !emuWindowNeedsPresent
+		&& !lastPresentHadOverlay && !emuVideoHasOverlay())
+	{
+		// the last presented frame is still correct, leave it on screen
+		return;
+	}
 	drawEmuVideo();
 }
 
@@ -179,12 +227,63 @@ static void updateWindowViewport(AppWindowData &winData, Base::Window::SurfaceCh
 	}
 }
 
+#ifdef CONFIG_THREAD_SCHEDULING_HINTS
+static constexpr int EMU_THREAD_RT_PRIORITY = 10;
+// above the emulation thread so a long frame can't starve the output
+static constexpr int AUDIO_THREAD_RT_PRIORITY = 20;
+static IG::JitterStats frameJitter{};
+// bumped by 2 each time emulation starts or stops, bit 0 set while it runs
+static std::atomic<uint> emuThreadSchedulingState{0};
+static thread_local uint appliedEmuThreadSchedulingState = 0;
+#endif
+
+void applyEmuThreadScheduling()
+{
+	#ifdef CONFIG_THREAD_SCHEDULING_HINTS
+	IG::applySchedulingHint(makeThreadSchedulingHint(optionEmuThreadCPUs, EMU_THREAD_RT_PRIORITY));
+	#endif
+}
+
+void updateEmuWorkerThreadScheduling()
+{
+	#ifdef CONFIG_THREAD_SCHEDULING_HINTS
+	auto state = emuThreadSchedulingState.load(std::memory_order_acquire);
+	if(likely(state == appliedEmuThreadSchedulingState))
+		return;
+	appliedEmuThreadSchedulingState = state;
+	if(state & 1)
+		applyEmuThreadScheduling();
+	else
+		IG::applySchedulingHint({});
+	#endif
+}
+
+#ifdef CONFIG_THREAD_SCHEDULING_HINTS
+static void setEmuThreadSchedulingRunning(bool running)
+{
+	auto state = emuThreadSchedulingState.load(std::memory_order_relaxed);
+	emuThreadSchedulingState.store(((state & ~1u) + 2) | running, std::memory_order_release);
+}
+#endif
+
+void applyAudioThreadScheduling()
+{
+	#ifdef CONFIG_THREAD_SCHEDULING_HINTS
+	Audio::setOutputThreadSchedulingHint(makeThreadSchedulingHint(optionAudioThreadCPUs, AUDIO_THREAD_RT_PRIORITY));
+	#endif
+}
+
 static void setCPUScalingLowLatency()
 {
 	#ifdef __ANDROID__
 	if(cpuFreq)
 		cpuFreq->setLowLatency();
 	#endif
+	// emulation runs on the main thread unless a core starts its own
+	applyEmuThreadScheduling();
+	#ifdef CONFIG_THREAD_SCHEDULING_HINTS
+	setEmuThreadSchedulingRunning(true);
+	#endif
 }
 
 static void setCPUScalingDefaults()
@@ -193,48 +292,169 @@ static void setCPUScalingDefaults()
 	if(cpuFreq)
 		cpuFreq->setDefaults();
 	#endif
+	#ifdef CONFIG_THREAD_SCHEDULING_HINTS
+	// the main thread also runs the menus, so drop back to normal scheduling
+	IG::applySchedulingHint({});
+	setEmuThreadSchedulingRunning(false);
+	frameJitter.log("frame");
+	frameJitter.reset();
+	#endif
+}
+
+static void runEmuFrame(bool renderGfx, bool processGfx, bool renderAudio)
+{
+	EMU_PROFILE_SCOPE(RUN_FRAME);
+	EmuSystem::runFrame(renderGfx, processGfx, renderAudio);
+}
+
+static void startEmuFrames(uint frames)
+{
+	EmuSystem::runFrameOnDraw = true;
+	postDrawToEmuWindows();
+	const uint maxLateFrameSkip = 6;
+	uint maxFrameSkip = optionSkipLateFrames ? maxLateFrameSkip : 0;
+	#if defined CONFIG_BASE_SCREEN_FRAME_INTERVAL
+	if(!optionSkipLateFrames)
+		maxFrameSkip = optionFrameInterval - 1;
+	#endif
+	assumeExpr(maxFrameSkip <= maxLateFrameSkip);
+	if(frames > 1 && maxFrameSkip)
+	{
+		uint framesToSkip = frames - 1;
+		framesToSkip = std::min(framesToSkip, maxFrameSkip);
+		bool renderAudio = optionSound;
+		iterateTimes(framesToSkip, i)
+		{
+			runEmuFrame(false, false, renderAudio);
+		}
+	}
+}
+
+// drops a delayed frame run that hasn't started yet, returning its frame count
+static uint cancelFrameDelay()
+{
+	auto frames = frameDelayFrames;
+	frameDelayTimer.cancel();
+	frameDelayFrames = 0;
+	return frames;
+}
+
+static void resetFrameDelay()
+{
+	cancelFrameDelay();
+	// start conservatively and let the cost estimate converge downwards
+	frameDelayEmuCostNs = Base::frameTimeBaseToNSecs(EmuSystem::timePerVideoFrame) / 2;
+	frameDelayMarginNs = 2000000;
+	frameDelayOnTimeFrames = 0;
+	frameEmuStartTime = {};
+}
+
+// Returns how long to wait after the screen's frame callback before sampling input
+// and running the next frame, leaving enough of the refresh interval for emulation
+static int64_t frameDelayTimeNs(uint elapsedFrames)
+{
+	static constexpr int64_t minMarginNs = 1000000, maxMarginNs = 8000000;
+	if(elapsedFrames > 1)
+	{
+		// a vsync was missed, back off
+		frameDelayMarginNs = std::min(frameDelayMarginNs + 1000000, maxMarginNs);
+		frameDelayOnTimeFrames = 0;
+	}
+	else if(++frameDelayOnTimeFrames == 120)
+	{
+		frameDelayMarginNs = std::max(frameDelayMarginNs - 250000, minMarginNs);
+		frameDelayOnTimeFrames = 0;
+	}
+	int64_t frameTimeNs = Base::frameTimeBaseToNSecs(EmuSystem::timePerVideoFrame);
+	int64_t delayNs = frameTimeNs - (frameDelayEmuCostNs + frameDelayEmuCostNs / 4) - frameDelayMarginNs;
+	return IG::clamp(delayNs, (int64_t)0, frameTimeNs * 3 / 4);
+}
+
+// Runs frames without drawing until the refresh interval's budget is used,
+// leaving time for the frame drawn afterwards
+static uint runMaxSpeedFrames(double frameTime, bool renderAudio)
+{
+	static constexpr uint maxFrames = 32;
+	int64_t budgetNs = (int64_t)(frameTime * 1000000000. * 3. / 4.) - fastForwardFrameCostNs;
+	auto startTime = IG::Time::now();
+	auto frameStartTime = startTime;
+	uint frames = 0;
+	while(frames < maxFrames && (int64_t)(frameStartTime - startTime).nSecs() + fastForwardFrameCostNs <= budgetNs)
+	{
+		runEmuFrame(false, false, renderAudio);
+		frames++;
+		auto now = IG::Time::now();
+		fastForwardFrameCostNs = (fastForwardFrameCostNs * 7 + (int64_t)(now - frameStartTime).nSecs()) / 8;
+		frameStartTime = now;
+	}
+	return frames;
 }
 
 static Base::Screen::OnFrameDelegate onFrameUpdate
 {
 	[](Base::Screen::FrameParams params)
 	{
-		commonUpdateInput();
 		if(unlikely(fastForwardActive))
 		{
+			cancelFrameDelay();
+			commonUpdateInput();
 			EmuSystem::runFrameOnDraw = true;
 			postDrawToEmuWindows();
-			iterateTimes((uint)optionFastForwardSpeed, i)
+			bool renderAudio = optionSound;
+			bool maxSpeed = (uint)optionFastForwardSpeed == FAST_FORWARD_SPEED_AUTO;
+			if(!maxSpeed)
+				fastForwardFrames = optionFastForwardSpeed;
+			// audio of the skipped frames and the drawn frame is compressed into one frame's worth,
+			// at max speed the previous refresh's frame count is used as the estimate
+			audioTimeStretcher.setSpeed(renderAudio && fastForwardFrames ? fastForwardFrames + 1 : 1);
+			if(maxSpeed)
 			{
-				EmuSystem::runFrame(false, false, false);
+				fastForwardFrames = runMaxSpeedFrames(params.screen().frameTime(), renderAudio);
+			}
+			else
+			{
+				iterateTimes(fastForwardFrames, i)
+				{
+					runEmuFrame(false, false, renderAudio);
+				}
 			}
 		}
 		else
 		{
+			#ifdef CONFIG_THREAD_SCHEDULING_HINTS
+			frameJitter.add(Base::frameTimeBaseToNSecs(params.timestampDiff()), params.screen().frameTime() * 1000000000.);
+			#endif
+			audioTimeStretcher.setSpeed(1);
 			uint frames = EmuSystem::advanceFramesWithTime(params.timestamp());
 			//logDMsg("%d frames elapsed (%fs)", frames, Base::frameTimeBaseToSecsDec(params.frameTimeDiff()));
-			if(frames)
+			// the timer from the last callback hasn't fired yet, run its frames now along with
+			// this callback's instead of delaying again, so none run twice or pile up
+			uint delayedFrames = cancelFrameDelay();
+			frames += delayedFrames;
+			if(frames && optionFrameDelay && !delayedFrames)
 			{
-				EmuSystem::runFrameOnDraw = true;
-				postDrawToEmuWindows();
-				const uint maxLateFrameSkip = 6;
-				uint maxFrameSkip = optionSkipLateFrames ? maxLateFrameSkip : 0;
-				#if defined CONFIG_BASE_SCREEN_FRAME_INTERVAL
-				if(!optionSkipLateFrames)
-					maxFrameSkip = optionFrameInterval - 1;
-				#endif
-				assumeExpr(maxFrameSkip <= maxLateFrameSkip);
-				if(frames > 1 && maxFrameSkip)
+				auto delayNs = frameDelayTimeNs(frames);
+				if(delayNs)
 				{
-					uint framesToSkip = frames - 1;
-					framesToSkip = std::min(framesToSkip, maxFrameSkip);
-					bool renderAudio = optionSound;
-					iterateTimes(framesToSkip, i)
-					{
-						EmuSystem::runFrame(false, false, renderAudio);
-					}
+					// input events keep being dispatched while waiting on the timer
+					frameDelayFrames = frames;
+					frameDelayTimer.callbackAfterNSec(
+						[]()
+						{
+							auto frames = frameDelayFrames;
+							frameDelayFrames = 0;
+							commonUpdateInput();
+							startEmuFrames(frames);
+						}, delayNs);
+					params.readdOnFrame();
+					return;
 				}
 			}
+			commonUpdateInput();
+			if(frames)
+			{
+				startEmuFrames(frames);
+			}
 		}
 		params.readdOnFrame();
 	}
@@ -253,6 +473,11 @@ static void startEmulation()
 {
 	setCPUScalingLowLatency();
 	EmuSystem::start();
+	resetFrameDelay();
+	fastForwardFrameCostNs = Base::frameTimeBaseToNSecs(EmuSystem::timePerVideoFrame) / 4;
+	fastForwardFrames = 0;
+	audioTimeStretcher.setSpeed(1);
+	emuWindowNeedsPresent = true;
 	emuWin->win.screen()->addOnFrameOnce(onFrameUpdate);
 }
 
@@ -260,6 +485,7 @@ static void pauseEmulation()
 {
 	EmuSystem::pause();
 	emuWin->win.screen()->removeOnFrame(onFrameUpdate);
+	cancelFrameDelay();
 	setCPUScalingDefaults();
 }
 
@@ -267,21 +493,29 @@ void closeGame(bool allowAutosaveState)
 {
 	EmuSystem::closeGame();
 	emuWin->win.screen()->removeOnFrame(onFrameUpdate);
+	cancelFrameDelay();
 	setCPUScalingDefaults();
 }
 
 static void drawEmuFrame()
 {
-	if(EmuSystem::runFrameOnDraw)
 	{
-		bool renderAudio = optionSound;
-		EmuSystem::runFrame(true, true, renderAudio);
-		EmuSystem::runFrameOnDraw = false;
-	}
-	else
-	{
-		drawEmuVideo();
+		EMU_PROFILE_SCOPE(DRAW_FRAME);
+		if(EmuSystem::runFrameOnDraw)
+		{
+			bool renderAudio = optionSound;
+			if(optionFrameDelay)
+				frameEmuStartTime = IG::Time::now();
+			runEmuFrame(true, true, renderAudio);
+			frameEmuStartTime = {};
+			EmuSystem::runFrameOnDraw = false;
+		}
+		else
+		{
+			drawEmuVideo();
+		}
 	}
+	frameProfiler.endFrame();
 }
 
 static bool allWindowsAreFocused()
@@ -618,46 +852,77 @@ void mainInitCommon(int argc, char** argv)
 			Gfx::bind();
 			handleOpenFileCommand(filename);
 		});
-	initOptions();
-	auto launchGame = parseCmdLineArgs(argc, argv);
-	loadConfigFile();
-	EmuSystem::onOptionsLoaded();
-	AudioManager::setMusicVolumeControlHint();
-	AudioManager::startSession();
-	Base::setIdleDisplayPowerSave(optionIdleDisplayPowerSave);
-	applyOSNavStyle(false);
-
-	#ifdef EMU_FRAMEWORK_WINDOW_PIXEL_FORMAT_OPTION
-	Gfx::init((IG::PixelFormatID)optionWindowPixelFormat.val);
-	#else
-	Gfx::init();
-	#endif
-
-	auto compiled = Gfx::texAlphaProgram.compile();
-	compiled |= Gfx::noTexProgram.compile();
-	compiled |= View::compileGfxPrograms();
-	if(compiled)
-		Gfx::autoReleaseShaderCompiler();
-	if(!optionDitherImage.isConst)
+	struct CmdLine
 	{
-		Gfx::setDither(optionDitherImage);
-	}
+		int argc;
+		char **argv;
+		const char *launchGame;
+	} cmdLine{argc, argv, nullptr};
+	// Core init and font loading don't depend on each other or the config,
+	// on Android they use the main thread's JNI environment
+	InitTaskGraph initTasks;
+	auto coreInit = initTasks.add("core init",
+		[]()
+		{
+			EmuSystem::onInit();
+		}, 0, !Config::envIsAndroid);
+	initTasks.add("font load",
+		[]()
+		{
+			View::defaultFace = ResourceFace::loadSystem();
+			assert(View::defaultFace);
+			// TODO: not used yet
+			//View::defaultSmallFace = ResourceFace::create(View::defaultFace);
+		}, 0, !Config::envIsAndroid);
+	auto configInit = initTasks.add("config load",
+		[&cmdLine]()
+		{
+			initOptions();
+			cmdLine.launchGame = parseCmdLineArgs(cmdLine.argc, cmdLine.argv);
+			loadConfigFile();
+			EmuSystem::onOptionsLoaded();
+			inputLatency.setEnabled(optionShowInputLatency);
+			frameProfiler.setEnabled(optionShowFrameProfiler);
+			applyAudioThreadScheduling();
+			ArchiveCache::setMaxSize((off_t)optionArchiveCacheSize * ARCHIVE_CACHE_SIZE_UNIT);
+			AudioManager::setMusicVolumeControlHint();
+			AudioManager::startSession();
+			Base::setIdleDisplayPowerSave(optionIdleDisplayPowerSave);
+			applyOSNavStyle(false);
+		}, InitTaskGraph::dep(coreInit));
+	initTasks.add("gfx init",
+		[]()
+		{
+			#ifdef EMU_FRAMEWORK_WINDOW_PIXEL_FORMAT_OPTION
+			Gfx::init((IG::PixelFormatID)optionWindowPixelFormat.val);
+			#else
+			Gfx::init();
+			#endif
 
-	#ifdef __ANDROID__
-	if((int8)optionProcessPriority != 0)
-		Base::setProcessPriority(optionProcessPriority);
+			auto compiled = Gfx::texAlphaProgram.compile();
+			compiled |= Gfx::noTexProgram.compile();
+			compiled |= View::compileGfxPrograms();
+			if(compiled)
+				Gfx::autoReleaseShaderCompiler();
+			if(!optionDitherImage.isConst)
+			{
+				Gfx::setDither(optionDitherImage);
+			}
 
-	if(Base::androidSDK() < 14 && optionAndroidTextureStorage == OPTION_ANDROID_TEXTURE_STORAGE_SURFACE_TEXTURE)
-	{
-		optionAndroidTextureStorage = OPTION_ANDROID_TEXTURE_STORAGE_AUTO;
-	}
-	Gfx::Texture::setAndroidStorageImpl(makeAndroidStorageImpl(optionAndroidTextureStorage));
-	#endif
+			#ifdef __ANDROID__
+			if((int8)optionProcessPriority != 0)
+				Base::setProcessPriority(optionProcessPriority);
 
-	View::defaultFace = ResourceFace::loadSystem();
-	assert(View::defaultFace);
-	// TODO: not used yet
-	//View::defaultSmallFace = ResourceFace::create(View::defaultFace);
+			if(Base::androidSDK() < 14 && optionAndroidTextureStorage == OPTION_ANDROID_TEXTURE_STORAGE_SURFACE_TEXTURE)
+			{
+				optionAndroidTextureStorage = OPTION_ANDROID_TEXTURE_STORAGE_AUTO;
+			}
+			Gfx::Texture::setAndroidStorageImpl(makeAndroidStorageImpl(optionAndroidTextureStorage));
+			#endif
+		}, InitTaskGraph::dep(configInit));
+	initTasks.run();
+	auto launchGame = cmdLine.launchGame;
+	auto viewsStartTime = IG::Time::now();
 
 	#ifdef CONFIG_INPUT_ANDROID_MOGA
 	if(optionMOGAInputSystem)
@@ -744,6 +1009,8 @@ void mainInitCommon(int argc, char** argv)
 				Gfx::setClipRect(false);
 				Gfx::presentWindow(win);
 			}
+			if(unlikely(!startupTrace.isDone()))
+				startupTrace.markFirstFrame();
 		});
 
 	Gfx::initWindow(mainWin.win, winConf);
@@ -756,6 +1023,7 @@ void mainInitCommon(int argc, char** argv)
 	}
 
 	applyFrameRates();
+	startupTrace.addPhase("views & window", viewsStartTime, IG::Time::now());
 
 	if(launchGame)
 	{
@@ -843,6 +1111,8 @@ void handleInputEvent(Base::Window &win, Input::Event e)
 	}
 	if(likely(EmuSystem::isActive()))
 	{
+		// on-screen controls may highlight
+		emuWindowNeedsPresent = true;
 		emuView.inputEvent(e);
 	}
 	else if(modalViewController.hasView())
@@ -909,6 +1179,7 @@ void handleOpenFileCommand(const char *filename)
 
 void placeEmuViews()
 {
+	emuWindowNeedsPresent = true;
 	emuView.place();
 	emuView2.place();
 }
@@ -918,6 +1189,8 @@ void placeElements()
 	logMsg("placing app elements");
 	TableView::setDefaultXIndent(mainWin.projectionPlane);
 	popup.place(emuWin->projectionPlane);
+	inputLatency.place(emuWin->projectionPlane);
+	frameProfiler.place(emuWin->projectionPlane);
 	placeEmuViews();
 	viewStack.place(mainWin.viewport().bounds(), mainWin.projectionPlane);
 	modalViewController.place(mainWin.viewport().bounds(), mainWin.projectionPlane);
@@ -952,7 +1225,7 @@ namespace Base
 
 CallResult onInit(int argc, char** argv)
 {
-	EmuSystem::onInit();
+	startupTrace.begin();
 	mainInitCommon(argc, argv);
 	return OK;
 }
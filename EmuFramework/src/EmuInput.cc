@@ -19,6 +19,7 @@
 #include <emuframework/EmuOptions.hh>
 #include <emuframework/EmuApp.hh>
 #include <emuframework/InputManagerView.hh>
+#include <emuframework/FrameProfiler.hh>
 #ifdef CONFIG_EMUFRAMEWORK_VCONTROLS
 #include <emuframework/VController.hh>
 SysVController vController;
@@ -237,6 +238,7 @@ void commonInitInput()
 void commonUpdateInput()
 {
 	using namespace IG;
+	EMU_PROFILE_SCOPE(INPUT);
 	static const uint turboFrames = 4;
 	static uint turboClock = 0;
 
@@ -17,6 +17,7 @@
 #include <emuframework/EmuInput.hh>
 #include <emuframework/VController.hh>
 #include <emuframework/EmuApp.hh>
+#include <emuframework/InputLatency.hh>
 #include <imagine/gui/AlertView.hh>
 #include <emuframework/FilePicker.hh>
 
@@ -69,6 +70,8 @@ void EmuInputView::inputEvent(Input::Event e)
 		else if((touchControlsAreOn && touchControlsApplicable())
 			|| vController.isInKeyboardMode())
 		{
+			if(e.state == Input::PUSHED)
+				inputLatency.addInput(e.time);
 			vController.applyInput(e);
 		}
 		#ifdef CONFIG_VCONTROLS_GAMEPAD
@@ -255,6 +258,8 @@ void EmuInputView::inputEvent(Input::Event e)
 								turboActions.removeEvent(sysAction);
 							}
 						}
+						if(e.state == Input::PUSHED)
+							inputLatency.addInput(e.time);
 						EmuSystem::handleInputAction(e.state, sysAction);
 					}
 				}
@@ -19,6 +19,7 @@
 #include <emuframework/EmuApp.hh>
 #include <emuframework/VideoImageEffect.hh>
 #include <emuframework/VController.hh>
+#include <emuframework/ArchiveCache.hh>
 #ifdef CONFIG_EMUFRAMEWORK_VCONTROLS
 extern SysVController vController;
 #endif
@@ -92,7 +93,8 @@ Byte1Option optionIdleDisplayPowerSave(CFGKEY_IDLE_DISPLAY_POWER_SAVE, 1, !Confi
 Byte1Option optionHideStatusBar(CFGKEY_HIDE_STATUS_BAR, 1, (!Config::envIsAndroid || Config::MACHINE_IS_OUYA) && !Config::envIsIOS);
 OptionSwappedGamepadConfirm optionSwappedGamepadConfirm(CFGKEY_SWAPPED_GAMEPAD_CONFIM, Input::SWAPPED_GAMEPAD_CONFIRM_DEFAULT);
 Byte1Option optionConfirmOverwriteState(CFGKEY_CONFIRM_OVERWRITE_STATE, 1, 0);
-Byte1Option optionFastForwardSpeed(CFGKEY_FAST_FORWARD_SPEED, 4, 0, optionIsValidWithMinMax<2, 7>);
+Byte1Option optionFastForwardSpeed(CFGKEY_FAST_FORWARD_SPEED, 4, 0, optionIsValidWithMinMax<2, FAST_FORWARD_SPEED_AUTO>);
+Byte1Option optionArchiveCacheSize(CFGKEY_ARCHIVE_CACHE_SIZE, ArchiveCache::DEFAULT_MAX_SIZE / ARCHIVE_CACHE_SIZE_UNIT, 0, optionIsValidWithMax<16>);
 #ifdef CONFIG_INPUT_DEVICE_HOTSWAP
 Byte1Option optionNotifyInputDeviceChange(CFGKEY_NOTIFY_INPUT_DEVICE_CHANGE, Config::Input::DEVICE_HOTSWAP, !Config::Input::DEVICE_HOTSWAP);
 #endif
@@ -206,6 +208,8 @@ Byte1Option optionFrameInterval
 	{CFGKEY_FRAME_INTERVAL,	1, !Config::envIsIOS, optionIsValidWithMinMax<1, 4>};
 #endif
 Byte1Option optionSkipLateFrames{CFGKEY_SKIP_LATE_FRAMES, 1, 0};
+Byte1Option optionFrameDelay{CFGKEY_FRAME_DELAY, 0, 0};
+Byte1Option optionSkipUnchangedFrames{CFGKEY_SKIP_UNCHANGED_FRAMES, 0, 0};
 DoubleOption optionFrameRate{CFGKEY_FRAME_RATE, 0, 0, optionFrameTimeIsValid};
 DoubleOption optionFrameRatePAL{CFGKEY_FRAME_RATE_PAL, 1./50., !EmuSystem::hasPALVideoSystem, optionFrameTimePALIsValid};
 
@@ -228,6 +232,27 @@ SByte1Option optionProcessPriority{CFGKEY_PROCESS_PRIORITY, -6, 0, optionIsValid
 Byte1Option optionManageCPUFreq{CFGKEY_MANAGE_CPU_FREQ, 0, 0};
 #endif
 
+#ifdef CONFIG_THREAD_SCHEDULING_HINTS
+Byte1Option optionEmuThreadCPUs{CFGKEY_EMU_THREAD_CPUS, OPTION_THREAD_CPUS_PERFORMANCE,
+	0, optionIsValidWithMax<OPTION_THREAD_CPUS_MAX_VALUE>};
+Byte1Option optionAudioThreadCPUs{CFGKEY_AUDIO_THREAD_CPUS, OPTION_THREAD_CPUS_ANY,
+	0, optionIsValidWithMax<OPTION_THREAD_CPUS_MAX_VALUE>};
+Byte1Option optionRealtimeThreads{CFGKEY_REALTIME_THREADS, 0, 0};
+
+IG::SchedulingHint makeThreadSchedulingHint(uint8 cpus, int realtimePriority)
+{
+	auto &topo = IG::cpuTopology();
+	IG::CPUMask mask = 0;
+	if(cpus == OPTION_THREAD_CPUS_PERFORMANCE)
+		mask = topo.performance;
+	else if(cpus == OPTION_THREAD_CPUS_EFFICIENCY)
+		mask = topo.efficiency; // empty on uniform systems, leaving the thread unpinned
+	if(optionRealtimeThreads)
+		return {mask, IG::ThreadPolicy::FIFO, realtimePriority};
+	return {mask, IG::ThreadPolicy::NORMAL, 0};
+}
+#endif
+
 Byte1Option optionDitherImage(CFGKEY_DITHER_IMAGE, 1, !Config::envIsAndroid);
 
 #ifdef EMU_FRAMEWORK_WINDOW_PIXEL_FORMAT_OPTION
@@ -250,6 +275,8 @@ PathOption optionSavePath(CFGKEY_SAVE_PATH, EmuSystem::savePath_, "");
 Byte1Option optionCheckSavePathWriteAccess{CFGKEY_CHECK_SAVE_PATH_WRITE_ACCESS, 1};
 
 Byte1Option optionShowBundledGames(CFGKEY_SHOW_BUNDLED_GAMES, 1);
+Byte1Option optionShowInputLatency(CFGKEY_SHOW_INPUT_LATENCY, 0);
+Byte1Option optionShowFrameProfiler(CFGKEY_SHOW_FRAME_PROFILER, 0);
 
 [[gnu::weak]] PathOption optionFirmwarePath(0, nullptr, 0, nullptr);
 
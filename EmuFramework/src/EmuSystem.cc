@@ -18,10 +18,15 @@
 #include <emuframework/EmuApp.hh>
 #include <emuframework/FileUtils.hh>
 #include <emuframework/FilePicker.hh>
+#include <emuframework/InputLatency.hh>
+#include <emuframework/FrameProfiler.hh>
+#include <emuframework/ArchiveCache.hh>
+#include <emuframework/AudioTimeStretch.hh>
 #include <imagine/fs/ArchiveFS.hh>
 #include <imagine/audio/Audio.hh>
 #include <imagine/util/assume.h>
 #include <algorithm>
+#include <memory>
 
 EmuSystem::State EmuSystem::state = EmuSystem::State::OFF;
 FS::PathString EmuSystem::gamePath_{};
@@ -51,6 +56,11 @@ double EmuSystem::frameTimePAL = 1./50.;
 
 void saveAutoStateFromTimer();
 
+enum class SoundBufferMode : uint8 { DIRECT, SCRATCH_WRITE, SCRATCH_DISCARD };
+static SoundBufferMode soundBufferMode = SoundBufferMode::SCRATCH_DISCARD;
+static std::unique_ptr<char[]> soundScratch{};
+static uint soundScratchBytes = 0;
+
 void EmuSystem::cancelAutoSaveStateTimer()
 {
 	autoSaveStateTimer.deinit();
@@ -95,12 +105,18 @@ void EmuSystem::stopSound()
 	{
 		//logMsg("stopping sound");
 		Audio::pausePcm();
+		auto stats = Audio::ringStats();
+		logMsg("audio underruns:%u overruns:%u", stats.underruns, stats.overruns);
 	}
 }
 
 void EmuSystem::writeSound(const void *samples, uint framesToWrite)
 {
-	Audio::writePcm(samples, framesToWrite);
+	EMU_PROFILE_SCOPE(AUDIO_WRITE);
+	if(unlikely(audioTimeStretcher.isActive()))
+		audioTimeStretcher.write(samples, framesToWrite);
+	else
+		Audio::writePcm(samples, framesToWrite);
 	if(!Audio::isPlaying() && Audio::framesFree() <= (int)audioFramesPerVideoFrame)
 	{
 		logMsg("starting audio playback with %d frames free in buffer", Audio::framesFree());
@@ -108,9 +124,46 @@ void EmuSystem::writeSound(const void *samples, uint framesToWrite)
 	}
 }
 
+Audio::BufferContext EmuSystem::getSoundBuffer(uint maxFrames, bool renderAudio)
+{
+	if(renderAudio && !audioTimeStretcher.isActive() && Audio::isOpen())
+	{
+		// the play buffer is the free part of the backend's output ring,
+		// nothing is reserved until commitPlayBuffer() so a short one can be dropped
+		auto buffer = Audio::getPlayBuffer(maxFrames);
+		if(buffer && buffer.frames >= maxFrames)
+		{
+			soundBufferMode = SoundBufferMode::DIRECT;
+			return buffer;
+		}
+	}
+	soundBufferMode = renderAudio ? SoundBufferMode::SCRATCH_WRITE : SoundBufferMode::SCRATCH_DISCARD;
+	uint bytes = pcmFormat.framesToBytes(maxFrames);
+	if(bytes > soundScratchBytes)
+	{
+		soundScratch = std::make_unique<char[]>(bytes);
+		soundScratchBytes = bytes;
+	}
+	return {soundScratch.get(), maxFrames};
+}
+
 void EmuSystem::commitSound(Audio::BufferContext buffer, uint frames)
 {
-	Audio::commitPlayBuffer(buffer, frames);
+	switch(soundBufferMode)
+	{
+		bcase SoundBufferMode::SCRATCH_WRITE:
+			// writeSound() has its own profile scope
+			if(frames)
+				writeSound(buffer.data, frames);
+			return;
+		bcase SoundBufferMode::SCRATCH_DISCARD:
+			return;
+		bcase SoundBufferMode::DIRECT:
+		{
+			EMU_PROFILE_SCOPE(AUDIO_WRITE);
+			Audio::commitPlayBuffer(buffer, frames);
+		}
+	}
 	if(!Audio::isPlaying() && Audio::framesFree() <= (int)audioFramesPerVideoFrame)
 	{
 		logMsg("starting audio playback with %d frames free in buffer", Audio::framesFree());
@@ -325,6 +378,18 @@ void EmuSystem::closeGame(bool allowAutosaveState)
 			Audio::clearPcm();
 		if(allowAutosaveState)
 			saveAutoState();
+		if(inputLatency.isEnabled())
+		{
+			inputLatency.logStats();
+			inputLatency.writeStats(FS::makePathStringPrintf("%s/%s.latency.csv", savePath(), gameName_.data()).data());
+			inputLatency.reset();
+		}
+		if(frameProfiler.isEnabled())
+		{
+			frameProfiler.logStats();
+			frameProfiler.writeStats(FS::makePathStringPrintf("%s/%s.profile.csv", savePath(), gameName_.data()).data());
+			frameProfiler.reset();
+		}
 		logMsg("closing game %s", gameName_.data());
 		closeSystem();
 		clearGamePaths();
@@ -443,6 +508,37 @@ bool EmuSystem::setFrameTime(VideoSystem system, double time)
 	return path;
 }
 
+static ArchiveIO openArchiveGameEntry(FS::PathString path)
+{
+	ArchiveIO io{};
+	CallResult res = OK;
+	for(auto &entry : FS::ArchiveIterator{path, res})
+	{
+		if(entry.type() == FS::file_type::directory)
+		{
+			continue;
+		}
+		auto name = entry.name();
+		logMsg("archive file entry:%s", entry.name());
+		if(EmuFilePicker::defaultFsFilter(name))
+		{
+			io = entry.moveIO();
+			break;
+		}
+	}
+	if(res != OK)
+	{
+		logErr("error opening archive:%s", path.data());
+		return {};
+	}
+	if(!io)
+	{
+		logErr("no recognized file extensions in archive:%s", path.data());
+		return {};
+	}
+	return io;
+}
+
 int EmuSystem::loadGameFromPath(FS::PathString path)
 {
 	path = willLoadGameFromPath(path);
@@ -453,31 +549,28 @@ int EmuSystem::loadGameFromPath(FS::PathString path)
 	logMsg("load from path:%s", path.data());
 	if(hasArchiveExtension(path.data()))
 	{
-		ArchiveIO io{};
-		CallResult res = OK;
-		for(auto &entry : FS::ArchiveIterator{path, res})
+		FS::FileString entryName{};
 		{
-			if(entry.type() == FS::file_type::directory)
-			{
-				continue;
-			}
-			auto name = entry.name();
-			logMsg("archive file entry:%s", entry.name());
-			if(EmuFilePicker::defaultFsFilter(name))
+			auto cachedIO = ArchiveCache::open(path.data(), entryName);
+			if(cachedIO)
 			{
-				io = entry.moveIO();
-				break;
+				logMsg("using cached archive entry:%s", entryName.data());
+				return EmuSystem::loadGameFromIO(cachedIO, path.data(), entryName.data());
 			}
 		}
-		if(res != OK)
-		{
-			logErr("error opening archive:%s", path.data());
-			return 0;
-		}
+		auto io = openArchiveGameEntry(path);
 		if(!io)
-		{
-			logErr("no recognized file extensions in archive:%s", path.data());
 			return 0;
+		if(ArchiveCache::maxSize())
+		{
+			string_copy(entryName, io.name());
+			auto cachedIO = ArchiveCache::add(path.data(), io, entryName.data());
+			if(cachedIO)
+				return EmuSystem::loadGameFromIO(cachedIO, path.data(), entryName.data());
+			// caching failed, re-open the entry since its data may have been consumed
+			io = openArchiveGameEntry(path);
+			if(!io)
+				return 0;
 		}
 		return EmuSystem::loadGameFromIO(io, path.data(), io.name());
 	}
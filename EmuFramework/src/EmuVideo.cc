@@ -17,6 +17,8 @@
 #include <emuframework/EmuOptions.hh>
 #include <emuframework/EmuApp.hh>
 #include <emuframework/Screenshot.hh>
+#include <emuframework/FrameProfiler.hh>
+#include <cstring>
 
 void EmuVideo::initPixmap(char *pixBuff, IG::PixelFormat format, uint x, uint y, uint pitch)
 {
@@ -29,6 +31,8 @@ void EmuVideo::initPixmap(char *pixBuff, IG::PixelFormat format, uint x, uint y,
 
 void EmuVideo::reinitImage()
 {
+	cancelFrame();
+	rowHashes = 0;
 	Gfx::TextureConfig conf{vidPix};
 	conf.setWillWriteOften(true);
 	vidImg.init(conf);
@@ -47,6 +51,7 @@ void EmuVideo::clearImage()
 	{
 		vidImg.clear(0);
 	}
+	rowHashes = 0;
 }
 
 void EmuVideo::resizeImage(uint x, uint y, uint pitch)
@@ -56,6 +61,8 @@ void EmuVideo::resizeImage(uint x, uint y, uint pitch)
 
 void EmuVideo::resizeImage(uint xO, uint yO, uint x, uint y, uint totalX, uint totalY, uint pitch)
 {
+	cancelFrame();
+	rowHashes = 0;
 	IG::Pixmap basePix;
 	if(pitch)
 		basePix = {{{(int)totalX, (int)totalY}, vidPix.format()}, pixBuff, {pitch, vidPix.BYTE_UNITS}};
@@ -97,6 +104,16 @@ void EmuVideo::initImage(bool force, uint xO, uint yO, uint x, uint y, uint tota
 
 void EmuVideo::takeGameScreenshot()
 {
+	if(lastFrameDirect)
+	{
+		// the last frame only exists in the texture, copy it back to the core's buffer
+		if(!vidImg.read(0, vidPix))
+		{
+			popup.postError("Error reading back the last frame");
+			return;
+		}
+		lastFrameDirect = false;
+	}
 	FS::PathString path;
 	int screenshotNum = sprintScreenshotFilename(path);
 	if(screenshotNum == -1)
@@ -116,6 +133,132 @@ void EmuVideo::takeGameScreenshot()
 	}
 }
 
+IG::Pixmap EmuVideo::startFrame()
+{
+	// Lets the core render the next frame straight into the texture's mapped
+	// pixel buffer, skipping the copy from its own buffer in updateImage().
+	// The returned pixmap's pitch can differ from vidPix.
+	if(frameBuff)
+		return frameBuff.pixmap();
+	// frames in an external texture couldn't be read back for screenshots
+	if(!vidImg || isExternalTexture())
+		return vidPix;
+	auto used = vidImg.usedPixmapDesc();
+	frameBuff = vidImg.lock(0, {0, 0, (int)used.w(), (int)used.h()});
+	if(!frameBuff)
+		return vidPix;
+	if(frameBuff.pixmap().w() != used.w() || frameBuff.pixmap().h() != used.h())
+	{
+		// direct storage returns the whole texture
+		frameBuff.pixmap() = frameBuff.pixmap().subPixmap({}, used.size());
+	}
+	return frameBuff.pixmap();
+}
+
+static uint64_t hashRow(const char *data, uint bytes)
+{
+	// independent lanes keep several multiplies in flight, the compiler
+	// can also vectorize the main loop on targets with 64-bit multiplies
+	constexpr uint64_t mul = 0x9E3779B97F4A7C15;
+	uint64_t lane[4]{1, 2, 3, 4};
+	uint i = 0;
+	for(; i + 32 <= bytes; i += 32)
+	{
+		uint64_t w[4];
+		std::memcpy(w, data + i, sizeof(w));
+		iterateTimes(4, l)
+		{
+			lane[l] = (lane[l] ^ w[l]) * mul;
+		}
+	}
+	uint64_t h = bytes;
+	for(; i + 8 <= bytes; i += 8)
+	{
+		uint64_t w;
+		std::memcpy(&w, data + i, sizeof(w));
+		h = (h ^ w) * mul;
+	}
+	for(; i < bytes; i++)
+	{
+		h = (h ^ (uint8_t)data[i]) * mul;
+	}
+	iterateTimes(4, l)
+	{
+		h = (h ^ (lane[l] >> 29) ^ lane[l]) * mul;
+	}
+	return h;
+}
+
+bool EmuVideo::findChangedRows(uint &firstRow, uint &endRow)
+{
+	uint rows = vidPix.h();
+	uint rowBytes = vidPix.format().pixelBytes(vidPix.w());
+	bool hashesValid = rowHashes == rows;
+	if(!rowHash || rowHashes < rows)
+	{
+		rowHash = std::make_unique<uint64_t[]>(rows);
+	}
+	rowHashes = rows;
+	firstRow = rows;
+	endRow = 0;
+	auto data = (const char*)vidPix.pixel({});
+	iterateTimes(rows, y)
+	{
+		auto h = hashRow(data + y * vidPix.pitchBytes(), rowBytes);
+		if(hashesValid && h == rowHash[y])
+			continue;
+		rowHash[y] = h;
+		if(firstRow == rows)
+			firstRow = y;
+		endRow = y + 1;
+	}
+	return firstRow != rows;
+}
+
+bool EmuVideo::updateImage()
+{
+	if(frameBuff)
+	{
+		EMU_PROFILE_SCOPE(TEXTURE_UPLOAD);
+		vidImg.unlock(frameBuff);
+		frameBuff = {};
+		lastFrameDirect = true;
+		rowHashes = 0;
+		return true;
+	}
+	lastFrameDirect = false;
+	uint firstRow, endRow;
+	bool changed;
+	{
+		EMU_PROFILE_SCOPE(VIDEO_CONVERT);
+		changed = findChangedRows(firstRow, endRow);
+	}
+	if(changed)
+	{
+		EMU_PROFILE_SCOPE(TEXTURE_UPLOAD);
+		if(vidImg.hasDirectStorage() || (firstRow == 0 && endRow == vidPix.h()))
+		{
+			vidImg.write(0, vidPix, {}, vidPixAlign);
+		}
+		else
+		{
+			// upload only the span of rows that changed
+			auto rowsPix = vidPix.subPixmap({0, (int)firstRow}, {(int)vidPix.w(), (int)(endRow - firstRow)});
+			vidImg.write(0, rowsPix, {0, (int)firstRow}, vidImg.bestAlignment(rowsPix));
+		}
+	}
+	return changed;
+}
+
+void EmuVideo::cancelFrame()
+{
+	if(!frameBuff)
+		return;
+	logMsg("texture changed during frame, discarding locked buffer");
+	vidImg.unlock(frameBuff);
+	frameBuff = {};
+}
+
 bool EmuVideo::isExternalTexture()
 {
 	#ifdef __ANDROID__
@@ -45,6 +45,13 @@ void EmuFilePicker::init(bool pickingDir, EmuNameFilterFunc filter, bool singleD
 					else
 						return false;
 				}, singleDir);
+	// only filters with a fixed identity can share cached listings between runs
+	if(filter == defaultFsFilter)
+		setListingCacheName(singleDir ? "gameFiles" : "games");
+	else if(filter == defaultBenchmarkFsFilter)
+		setListingCacheName(singleDir ? "benchmarkFiles" : "benchmark");
+	else if(!filter && !singleDir)
+		setListingCacheName("dirs");
 	if(setPath(FS::current_path().data()) != OK)
 	{
 		setPath(Base::storagePath());
@@ -0,0 +1,205 @@
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <emuframework/FrameProfiler.hh>
+#include <emuframework/EmuApp.hh>
+#include <imagine/gui/View.hh>
+#include <imagine/gfx/GeomRect.hh>
+#include <imagine/io/FileIO.hh>
+#include <imagine/util/assume.h>
+#include <algorithm>
+
+FrameProfiler frameProfiler;
+
+static const char *scopeNameStr[FrameProfiler::SCOPES]
+{
+	"run_frame",
+	"video_convert",
+	"texture_upload",
+	"audio_write",
+	"input",
+	"draw_frame",
+	"core_cpu",
+	"core_video",
+	"core_sound",
+};
+
+const char *FrameProfiler::scopeName(Scope scope)
+{
+	assumeExpr(scope < SCOPES);
+	return scopeNameStr[scope];
+}
+
+void FrameProfiler::setEnabled(bool on)
+{
+	#ifdef CONFIG_EMUFRAMEWORK_FRAME_PROFILER
+	enabled = on;
+	reset();
+	#endif
+}
+
+void FrameProfiler::reset()
+{
+	for(auto &nsecs : frameNSecs)
+	{
+		nsecs.store(0, std::memory_order_relaxed);
+	}
+	history = {};
+	totalUSecs = {};
+	maxUSecs = {};
+	historyIdx = 0;
+	historyFrames = 0;
+	frames = 0;
+	lastFrame = {};
+	framesSinceOverlayUpdate = OVERLAY_UPDATE_FRAMES;
+	str = {};
+}
+
+void FrameProfiler::endFrame()
+{
+	if(likely(!enabled))
+		return;
+	auto now = IG::Time::now();
+	iterateTimes(SCOPES, i)
+	{
+		uint usecs = std::min(frameNSecs[i].exchange(0, std::memory_order_relaxed) / 1000, (uint64_t)UINT32_MAX);
+		history[i][historyIdx] = usecs;
+		totalUSecs[i] += usecs;
+		maxUSecs[i] = std::max(maxUSecs[i], usecs);
+	}
+	history[SCOPES][historyIdx] = lastFrame.nSecs() ? std::min((now - lastFrame).uSecs(), (uint64_t)UINT32_MAX) : 0;
+	lastFrame = now;
+	historyIdx = (historyIdx + 1) % HISTORY_FRAMES;
+	historyFrames = std::min(historyFrames + 1, HISTORY_FRAMES);
+	frames++;
+	if(++framesSinceOverlayUpdate >= OVERLAY_UPDATE_FRAMES)
+	{
+		updateOverlayText();
+		framesSinceOverlayUpdate = 0;
+	}
+}
+
+uint FrameProfiler::percentileUSecs(uint historyRow, uint percent) const
+{
+	if(!historyFrames)
+		return 0;
+	std::array<uint32, HISTORY_FRAMES> sorted;
+	std::copy_n(history[historyRow].begin(), historyFrames, sorted.begin());
+	uint idx = std::min((historyFrames * percent + 99) / 100, historyFrames) - 1;
+	std::nth_element(sorted.begin(), sorted.begin() + idx, sorted.begin() + historyFrames);
+	return sorted[idx];
+}
+
+void FrameProfiler::logStats()
+{
+	if(!frames)
+		return;
+	iterateTimes(SCOPES, i)
+	{
+		if(!totalUSecs[i])
+			continue;
+		logMsg("%s: avg %uus, p50 %uus, p95 %uus, max %uus over %u frames",
+			scopeName((Scope)i), (uint)(totalUSecs[i] / frames), percentileUSecs(i, 50),
+			percentileUSecs(i, 95), maxUSecs[i], frames);
+	}
+}
+
+bool FrameProfiler::writeStats(const char *path)
+{
+	FileIO file;
+	if(file.create(path) != OK)
+	{
+		logErr("error creating profile stats file:%s", path);
+		return false;
+	}
+	std::array<char, 96> line;
+	string_printf(line, "scope,frames,total_us,avg_us,max_us\n");
+	file.write(line.data(), strlen(line.data()));
+	iterateTimes(SCOPES, i)
+	{
+		string_printf(line, "%s,%u,%llu,%u,%u\n", scopeName((Scope)i), frames,
+			(unsigned long long)totalUSecs[i], frames ? (uint)(totalUSecs[i] / frames) : 0, maxUSecs[i]);
+		file.write(line.data(), strlen(line.data()));
+	}
+	logMsg("wrote profile stats to %s", path);
+	return true;
+}
+
+void FrameProfiler::updateOverlayText()
+{
+	auto strEnd = str.data() + str.size();
+	auto s = str.data();
+	s += snprintf(s, strEnd - s, "Frame: %.1fms p50 %.1fms p95 %.1fms p99",
+		percentileUSecs(SCOPES, 50) / 1000., percentileUSecs(SCOPES, 95) / 1000., percentileUSecs(SCOPES, 99) / 1000.);
+	uint lines = 1;
+	iterateTimes(SCOPES, i)
+	{
+		if(!totalUSecs[i] || s >= strEnd)
+			continue;
+		s += snprintf(s, strEnd - s, "\n%s: %.2fms p50 %.2fms p95", scopeName((Scope)i),
+			percentileUSecs(i, 50) / 1000., percentileUSecs(i, 95) / 1000.);
+		lines++;
+	}
+	if(!text.face)
+		text.init(str.data(), View::defaultFace);
+	text.maxLines = lines;
+	text.compile(projP);
+}
+
+void FrameProfiler::place(const Gfx::ProjectionPlane &projP)
+{
+	var_selfs(projP);
+	if(text.face && strlen(str.data()))
+		text.compile(projP);
+}
+
+void FrameProfiler::draw()
+{
+	using namespace Gfx;
+	if(likely(!enabled) || !strlen(str.data()))
+		return;
+	noTexProgram.use(projP.makeTranslate());
+	setBlendMode(BLEND_MODE_ALPHA);
+	// stats text above a graph of the recent frames
+	Gfx::GC graphH = text.nominalHeight * 3;
+	Gfx::GC graphW = projP.w / 3;
+	Gfx::GCRect rect{-projP.wHalf(), -projP.hHalf(),
+		-projP.wHalf() + std::max(text.xSize + text.nominalHeight, graphW), -projP.hHalf() + graphH + text.ySize + text.nominalHeight};
+	setColor(0., 0., 0., .5);
+	GeomRect::draw(rect);
+	if(historyFrames)
+	{
+		// bars scaled so two frame budgets fill the graph, with a line at one budget
+		Gfx::GC budgetUSecs = Base::frameTimeBaseToNSecs(EmuSystem::timePerVideoFrame) / 1000.;
+		Gfx::GC scale = budgetUSecs ? graphH / (budgetUSecs * 2) : 0;
+		Gfx::GC barW = graphW / HISTORY_FRAMES;
+		iterateTimes(historyFrames, i)
+		{
+			uint idx = (historyIdx + HISTORY_FRAMES - historyFrames + i) % HISTORY_FRAMES;
+			Gfx::GC x = rect.x + i * barW;
+			Gfx::GC intervalH = std::min(history[SCOPES][idx] * scale, graphH);
+			Gfx::GC drawH = std::min(history[DRAW_FRAME][idx] * scale, graphH);
+			setColor(.2, .4, 1., .75);
+			GeomRect::draw(Gfx::GCRect{x, rect.y, x + barW, rect.y + intervalH});
+			setColor(1., .6, 0., .75);
+			GeomRect::draw(Gfx::GCRect{x, rect.y, x + barW, rect.y + drawH});
+		}
+		setColor(1., 0., 0., 1.);
+		GeomRect::draw(Gfx::GCRect{rect.x, rect.y + graphH / 2, rect.x + graphW, rect.y + graphH / 2 + projP.unprojectYSize(1)});
+	}
+	setColor(1., 1., 1., 1.);
+	texAlphaProgram.use();
+	text.draw(projP.alignXToPixel(rect.x + text.nominalHeight / 2.f), projP.alignYToPixel(rect.y2 - text.nominalHeight / 4.f), LT2DO, projP);
+}
@@ -0,0 +1,119 @@
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#define LOGTAG "InitTasks"
+#include <emuframework/InitTaskGraph.hh>
+#include <emuframework/StartupTrace.hh>
+#include <imagine/logger/logger.h>
+#include <imagine/thread/TaskPool.hh>
+#include <algorithm>
+
+static constexpr uint MAX_WORKERS = 2;
+
+InitTaskGraph::TaskId InitTaskGraph::add(const char *name, TaskFunc func, uint32 deps, bool anyThread)
+{
+	assert(tasks < MAX_TASKS);
+	assert(deps < dep(tasks));
+	task[tasks] = {name, func, deps, anyThread};
+	return tasks++;
+}
+
+int InitTaskGraph::nextReadyTask(bool onMainThread) const
+{
+	int anyThreadIdx = -1;
+	iterateTimes(tasks, i)
+	{
+		if((startedMask & dep(i)) || (task[i].deps & doneMask) != task[i].deps)
+			continue;
+		if(!task[i].anyThread)
+		{
+			// main thread only tasks are usually on the critical path, take them first
+			if(onMainThread)
+				return i;
+			continue;
+		}
+		if(anyThreadIdx == -1)
+			anyThreadIdx = i;
+	}
+	return anyThreadIdx;
+}
+
+void InitTaskGraph::runTask(uint idx)
+{
+	StartupTracer::Phase phase{startupTrace, task[idx].name};
+	task[idx].func();
+}
+
+bool InitTaskGraph::runNextTask(bool onMainThread)
+{
+	int idx = nextReadyTask(onMainThread);
+	if(idx == -1)
+		return false;
+	startedMask |= dep(idx);
+	mutex.unlock();
+	runTask(idx);
+	mutex.lock();
+	doneMask |= dep(idx);
+	cond.notify_all();
+	return true;
+}
+
+void InitTaskGraph::runWorker()
+{
+	mutex.lock();
+	while(startedMask != dep(tasks) - 1)
+	{
+		if(!runNextTask(false))
+			cond.wait(mutex);
+	}
+	mutex.unlock();
+}
+
+void InitTaskGraph::run()
+{
+	uint anyThreadTasks = 0;
+	iterateTimes(tasks, i)
+	{
+		if(task[i].anyThread)
+			anyThreadTasks++;
+	}
+	auto &pool = IG::TaskPool::shared();
+	if(!pool.threads() || !anyThreadTasks)
+	{
+		iterateTimes(tasks, i)
+		{
+			runTask(i);
+		}
+		return;
+	}
+	uint workers = std::min({pool.threads(), anyThreadTasks, MAX_WORKERS});
+	logMsg("running %u init tasks with %u pool workers", tasks, workers);
+	// workers run as pool tasks, the pool threads outlive init for its later users
+	IG::TaskPool::TaskGroup group{pool};
+	iterateTimes(workers, i)
+	{
+		group.run([this](){ runWorker(); });
+	}
+	mutex.lock();
+	uint32 allMask = dep(tasks) - 1;
+	while(doneMask != allMask)
+	{
+		if(!runNextTask(true))
+			cond.wait(mutex);
+	}
+	mutex.unlock();
+	// don't let the graph go out of scope while a worker still references it
+	group.wait();
+}
@@ -0,0 +1,211 @@
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <emuframework/InputLatency.hh>
+#include <emuframework/EmuApp.hh>
+#include <imagine/gui/View.hh>
+#include <imagine/gfx/GeomRect.hh>
+#include <imagine/io/FileIO.hh>
+
+InputLatencyTracer inputLatency;
+
+void LatencyHistogram::add(IG::Time time)
+{
+	uint usecs = std::min(time.uSecs(), (uint64_t)UINT32_MAX);
+	uint idx = std::min(usecs / BUCKET_USECS, BUCKETS - 1);
+	bucket[idx]++;
+	samples_++;
+	totalUSecs += usecs;
+	maxUSecs_ = std::max(maxUSecs_, usecs);
+}
+
+void LatencyHistogram::reset()
+{
+	*this = {};
+}
+
+uint LatencyHistogram::avgUSecs() const
+{
+	if(!samples_)
+		return 0;
+	return totalUSecs / samples_;
+}
+
+uint LatencyHistogram::percentileUSecs(uint percent) const
+{
+	if(!samples_)
+		return 0;
+	uint target = ((uint64_t)samples_ * percent + 99) / 100;
+	uint count = 0;
+	iterateTimes(BUCKETS, i)
+	{
+		count += bucket[i];
+		if(count >= target)
+		{
+			// report the upper bound of the bucket
+			return std::min((i + 1) * BUCKET_USECS, maxUSecs_);
+		}
+	}
+	return maxUSecs_;
+}
+
+void InputLatencyTracer::setEnabled(bool on)
+{
+	enabled = on;
+	reset();
+}
+
+void InputLatencyTracer::reset()
+{
+	inputToFrame.reset();
+	frameToSwap.reset();
+	trace = {};
+	traceIdx = 0;
+	pendingInput = {};
+	frameEmulated = {};
+	frameHasInput = false;
+	framesSinceOverlayUpdate = OVERLAY_UPDATE_FRAMES;
+	str = {};
+}
+
+void InputLatencyTracer::addInput(Input::Time time)
+{
+	if(likely(!enabled) || pendingInput.nSecs())
+		return; // only the first input since the last emulated frame is traced
+	auto now = IG::Time::now();
+	IG::Time inputTime = time;
+	// fall back to the dispatch time if the event's clock doesn't match the monotonic clock
+	if(!inputTime.nSecs() || inputTime > now || (now - inputTime).secs() >= 1)
+		inputTime = now;
+	pendingInput = inputTime;
+}
+
+void InputLatencyTracer::markFrameEmulated()
+{
+	if(likely(!enabled))
+		return;
+	frameEmulated = IG::Time::now();
+	frameHasInput = pendingInput.nSecs();
+	if(frameHasInput)
+	{
+		inputToFrame.add(frameEmulated - pendingInput);
+		auto &entry = trace[traceIdx];
+		entry = {};
+		entry.input = pendingInput;
+		entry.frameEmulated = frameEmulated;
+		pendingInput = {};
+	}
+}
+
+void InputLatencyTracer::markFramePresented()
+{
+	if(likely(!enabled) || !frameEmulated.nSecs())
+		return;
+	auto now = IG::Time::now();
+	frameToSwap.add(now - frameEmulated);
+	frameEmulated = {};
+	if(frameHasInput)
+	{
+		trace[traceIdx].framePresented = now;
+		traceIdx = (traceIdx + 1) % TRACE_ENTRIES;
+		frameHasInput = false;
+	}
+	if(++framesSinceOverlayUpdate >= OVERLAY_UPDATE_FRAMES)
+	{
+		updateOverlayText();
+		framesSinceOverlayUpdate = 0;
+	}
+}
+
+void InputLatencyTracer::logStats()
+{
+	logMsg("input->frame latency: %u samples, avg %uus, p50 %uus, p95 %uus, max %uus",
+		inputToFrame.samples(), inputToFrame.avgUSecs(), inputToFrame.percentileUSecs(50),
+		inputToFrame.percentileUSecs(95), inputToFrame.maxUSecs());
+	logMsg("frame->swap latency: %u samples, avg %uus, p50 %uus, p95 %uus, max %uus",
+		frameToSwap.samples(), frameToSwap.avgUSecs(), frameToSwap.percentileUSecs(50),
+		frameToSwap.percentileUSecs(95), frameToSwap.maxUSecs());
+}
+
+bool InputLatencyTracer::writeStats(const char *path)
+{
+	FileIO file;
+	if(file.create(path) != OK)
+	{
+		logErr("error creating latency stats file:%s", path);
+		return false;
+	}
+	std::array<char, 64> line;
+	string_printf(line, "bucket_us,input_to_frame,frame_to_swap\n");
+	file.write(line.data(), strlen(line.data()));
+	iterateTimes(LatencyHistogram::BUCKETS, i)
+	{
+		if(!inputToFrame.bucketSamples(i) && !frameToSwap.bucketSamples(i))
+			continue;
+		string_printf(line, "%u,%u,%u\n", i * LatencyHistogram::BUCKET_USECS,
+			inputToFrame.bucketSamples(i), frameToSwap.bucketSamples(i));
+		file.write(line.data(), strlen(line.data()));
+	}
+	// most recent traced inputs, oldest first, after a blank line
+	string_printf(line, "\ninput_to_frame_us,frame_to_swap_us\n");
+	file.write(line.data(), strlen(line.data()));
+	iterateTimes(TRACE_ENTRIES, i)
+	{
+		auto &entry = trace[(traceIdx + i) % TRACE_ENTRIES];
+		if(!entry.framePresented.nSecs())
+			continue;
+		string_printf(line, "%u,%u\n", (uint)(entry.frameEmulated - entry.input).uSecs(),
+			(uint)(entry.framePresented - entry.frameEmulated).uSecs());
+		file.write(line.data(), strlen(line.data()));
+	}
+	logMsg("wrote latency stats to %s", path);
+	return true;
+}
+
+void InputLatencyTracer::updateOverlayText()
+{
+	string_printf(str, "Input->Frame: %.1fms avg %.1fms p95 (%u)\nFrame->Swap: %.1fms avg %.1fms p95",
+		inputToFrame.avgUSecs() / 1000., inputToFrame.percentileUSecs(95) / 1000., inputToFrame.samples(),
+		frameToSwap.avgUSecs() / 1000., frameToSwap.percentileUSecs(95) / 1000.);
+	if(!text.face)
+	{
+		text.init(str.data(), View::defaultFace);
+		text.maxLines = 2;
+	}
+	text.compile(projP);
+}
+
+void InputLatencyTracer::place(const Gfx::ProjectionPlane &projP)
+{
+	var_selfs(projP);
+	if(text.face && strlen(str.data()))
+		text.compile(projP);
+}
+
+void InputLatencyTracer::draw()
+{
+	using namespace Gfx;
+	if(likely(!enabled) || !strlen(str.data()))
+		return;
+	noTexProgram.use(projP.makeTranslate());
+	setBlendMode(BLEND_MODE_ALPHA);
+	setColor(0., 0., 0., .5);
+	Gfx::GCRect rect{-projP.wHalf(), projP.hHalf() - (text.ySize * 2.5f),
+		-projP.wHalf() + text.xSize + text.ySize, projP.hHalf()};
+	GeomRect::draw(rect);
+	setColor(1., 1., 1., 1.);
+	texAlphaProgram.use();
+	text.draw(projP.alignXToPixel(rect.x + text.ySize / 2.f), projP.alignYToPixel(rect.y2 - text.ySize / 4.f), LT2DO, projP);
+}
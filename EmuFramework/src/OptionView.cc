@@ -16,6 +16,8 @@
 #include <emuframework/OptionView.hh>
 #include <emuframework/EmuApp.hh>
 #include <emuframework/FilePicker.hh>
+#include <emuframework/InputLatency.hh>
+#include <emuframework/ArchiveCache.hh>
 #include <imagine/gui/TextEntry.hh>
 #include <algorithm>
 #ifdef __ANDROID__
@@ -118,16 +120,34 @@ void OptionView::fastForwardSpeedinit()
 	static const char *str[] =
 	{
 		"3x", "4x", "5x",
-		"6x", "7x", "8x"
+		"6x", "7x", "8x",
+		"Max"
 	};
 	int val = 0;
-	if(optionFastForwardSpeed >= MIN_FAST_FORWARD_SPEED && optionFastForwardSpeed <= 7)
+	if(optionFastForwardSpeed >= MIN_FAST_FORWARD_SPEED && optionFastForwardSpeed <= FAST_FORWARD_SPEED_AUTO)
 	{
 		val = optionFastForwardSpeed - MIN_FAST_FORWARD_SPEED;
 	}
 	fastForwardSpeed.init(str, val, sizeofArray(str));
 }
 
+static const uint8 archiveCacheSizeVal[] {0, 2, 4, 8, 16};
+
+void OptionView::archiveCacheSizeInit()
+{
+	static const char *str[] = { "Off", "128MB", "256MB", "512MB", "1GB" };
+	int val = 3;
+	iterateTimes(sizeofArray(archiveCacheSizeVal), i)
+	{
+		if(optionArchiveCacheSize == archiveCacheSizeVal[i])
+		{
+			val = i;
+			break;
+		}
+	}
+	archiveCacheSize.init(str, val, sizeofArray(str));
+}
+
 
 static void uiVisibiltyInit(const Byte1Option &option, MultiChoiceSelectMenuItem &menuItem)
 {
@@ -786,6 +806,8 @@ void OptionView::loadVideoItems(MenuItem *item[], uint &items)
 	frameIntervalInit(); item[items++] = &frameInterval;
 	#endif
 	dropLateFrames.init(optionSkipLateFrames); item[items++] = &dropLateFrames;
+	frameDelay.init(optionFrameDelay); item[items++] = &frameDelay;
+	skipUnchangedFrames.init(optionSkipUnchangedFrames); item[items++] = &skipUnchangedFrames;
 	if(!optionFrameRate.isConst)
 	{
 		printFrameRateStr(frameRateStr);
@@ -863,10 +885,23 @@ void OptionView::loadSystemItems(MenuItem *item[], uint &items)
 	savePath.init(savePathStr, true); item[items++] = &savePath;
 	checkSavePathWriteAccess.init(optionCheckSavePathWriteAccess); item[items++] = &checkSavePathWriteAccess;
 	fastForwardSpeedinit(); item[items++] = &fastForwardSpeed;
+	archiveCacheSizeInit(); item[items++] = &archiveCacheSize;
 	#ifdef __ANDROID__
 	processPriorityInit(); item[items++] = &processPriority;
 	manageCPUFreq.init(optionManageCPUFreq); item[items++] = &manageCPUFreq;
 	#endif
+	#ifdef CONFIG_THREAD_SCHEDULING_HINTS
+	{
+		static const char *str[] = { "Any", "Performance", "Efficiency" };
+		emuThreadCPUs.init(str, optionEmuThreadCPUs, sizeofArray(str)); item[items++] = &emuThreadCPUs;
+		audioThreadCPUs.init(str, optionAudioThreadCPUs, sizeofArray(str)); item[items++] = &audioThreadCPUs;
+	}
+	realtimeThreads.init(optionRealtimeThreads); item[items++] = &realtimeThreads;
+	#endif
+	showInputLatency.init(optionShowInputLatency); item[items++] = &showInputLatency;
+	#ifdef CONFIG_EMUFRAMEWORK_FRAME_PROFILER
+	showFrameProfiler.init(optionShowFrameProfiler); item[items++] = &showFrameProfiler;
+	#endif
 }
 
 void OptionView::loadGUIItems(MenuItem *item[], uint &items)
@@ -1054,6 +1089,24 @@ OptionView::OptionView(Base::Window &win):
 			optionSkipLateFrames.val = item.on;
 		}
 	},
+	frameDelay
+	{
+		"Auto Frame Delay",
+		[this](BoolMenuItem &item, View &, Input::Event e)
+		{
+			item.toggle(*this);
+			optionFrameDelay.val = item.on;
+		}
+	},
+	skipUnchangedFrames
+	{
+		"Skip Unchanged Frames",
+		[this](BoolMenuItem &item, View &, Input::Event e)
+		{
+			item.toggle(*this);
+			optionSkipUnchangedFrames.val = item.on;
+		}
+	},
 	frameRate
 	{
 		"",
@@ -1447,6 +1500,15 @@ OptionView::OptionView(Base::Window &win):
 			optionFastForwardSpeed = val + MIN_FAST_FORWARD_SPEED;
 		}
 	},
+	archiveCacheSize
+	{
+		"Archive Extraction Cache",
+		[](MultiChoiceMenuItem &, View &, int val)
+		{
+			optionArchiveCacheSize = archiveCacheSizeVal[val];
+			ArchiveCache::setMaxSize((off_t)optionArchiveCacheSize * ARCHIVE_CACHE_SIZE_UNIT, true);
+		}
+	},
 	#if defined __ANDROID__
 	processPriority
 	{
@@ -1485,6 +1547,60 @@ OptionView::OptionView(Base::Window &win):
 		}
 	},
 	#endif
+	#ifdef CONFIG_THREAD_SCHEDULING_HINTS
+	emuThreadCPUs
+	{
+		"Emulation Thread CPUs",
+		[](MultiChoiceMenuItem &, View &, int val)
+		{
+			optionEmuThreadCPUs = val;
+			// applied when emulation next starts
+		}
+	},
+	audioThreadCPUs
+	{
+		"Audio Thread CPUs",
+		[](MultiChoiceMenuItem &, View &, int val)
+		{
+			optionAudioThreadCPUs = val;
+			applyAudioThreadScheduling();
+		}
+	},
+	realtimeThreads
+	{
+		"Real-time Thread Priority",
+		[this](BoolMenuItem &item, View &, Input::Event e)
+		{
+			item.toggle(*this);
+			optionRealtimeThreads = item.on;
+			applyAudioThreadScheduling();
+			if(item.on)
+				popup.post("Needs RLIMIT_RTPRIO permission, otherwise thread priority is only raised");
+		}
+	},
+	#endif
+	showInputLatency
+	{
+		"Show Input Latency Stats",
+		[this](BoolMenuItem &item, View &, Input::Event e)
+		{
+			item.toggle(*this);
+			optionShowInputLatency = item.on;
+			inputLatency.setEnabled(item.on);
+		}
+	},
+	#ifdef CONFIG_EMUFRAMEWORK_FRAME_PROFILER
+	showFrameProfiler
+	{
+		"Show Frame Profiler",
+		[this](BoolMenuItem &item, View &, Input::Event e)
+		{
+			item.toggle(*this);
+			optionShowFrameProfiler = item.on;
+			frameProfiler.setEnabled(item.on);
+		}
+	},
+	#endif
 	// GUI
 	pauseUnfocused
 	{
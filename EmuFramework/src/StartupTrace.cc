@@ -0,0 +1,62 @@
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#define LOGTAG "StartupTrace"
+#include <emuframework/StartupTrace.hh>
+#include <imagine/logger/logger.h>
+#include <pthread.h>
+
+StartupTracer startupTrace;
+static pthread_t mainThreadId;
+
+StartupTracer::Phase::Phase(StartupTracer &tracer, const char *name):
+	tracer{tracer}, name{name}, start{IG::Time::now()}
+{}
+
+StartupTracer::Phase::~Phase()
+{
+	tracer.addPhase(name, start, IG::Time::now());
+}
+
+void StartupTracer::begin()
+{
+	startTime = IG::Time::now();
+	mainThreadId = pthread_self();
+}
+
+void StartupTracer::addPhase(const char *name, IG::Time start, IG::Time end)
+{
+	if(done)
+		return;
+	uint idx = phases.fetch_add(1, std::memory_order_relaxed);
+	if(idx >= MAX_PHASES)
+		return;
+	phase[idx] = {name, start - startTime, end - start, (bool)pthread_equal(pthread_self(), mainThreadId)};
+}
+
+void StartupTracer::markFirstFrame()
+{
+	if(done)
+		return;
+	done = true;
+	auto firstFrame = IG::Time::now() - startTime;
+	iterateTimes(std::min(phases.load(std::memory_order_acquire), MAX_PHASES), i)
+	{
+		auto &p = phase[i];
+		logMsg("%s: +%.3fms, took %.3fms%s", p.name, (double)p.start * 1000., (double)p.duration * 1000.,
+			p.mainThread ? "" : " (worker thread)");
+	}
+	logMsg("time to first frame: %.3fms", (double)firstFrame * 1000.);
+}
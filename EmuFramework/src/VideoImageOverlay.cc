@@ -58,7 +58,14 @@ alignas(8) static uint32 crtRgbPixmapBuff[] =
 
 void VideoImageOverlay::setEffect(uint effect)
 {
+	// the texture is made on the next place() so startup doesn't pay for it
 	var_selfs(effect);
+	spr.deinit();
+	img.deinit();
+}
+
+void VideoImageOverlay::initImage()
+{
 	IG::Pixmap pix;
 	switch(effect)
 	{
@@ -88,6 +95,8 @@ void VideoImageOverlay::setEffect(uint effect)
 
 void VideoImageOverlay::place(const Gfx::Sprite &disp, uint lines)
 {
+	if(effect != NO_EFFECT && !spr.image())
+		initImage();
 	if(spr.image())
 	{
 		using namespace Gfx;
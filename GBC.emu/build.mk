@@ -25,6 +25,7 @@ src/sound/channel1.cpp \
 src/sound/channel2.cpp \
 src/sound/channel3.cpp \
 src/sound/channel4.cpp \
+src/sound/blip_buffer.cpp \
 src/sound/duty_unit.cpp \
 src/sound/envelope_unit.cpp \
 src/sound/length_counter.cpp \
@@ -46,17 +47,6 @@ main/Cheats.cc \
 main/Palette.cc \
 $(addprefix $(libgambattePath)/,$(libgambatteSrc))
 
-gambatteCommonSrc := resample/src/resamplerinfo.cpp \
-resample/src/makesinckernel.cpp \
-resample/src/chainresampler.cpp \
-resample/src/u48div.cpp \
-resample/src/i0.cpp \
-resample/src/kaiser50sinc.cpp \
-resample/src/kaiser70sinc.cpp
-
-gambatteCommonPath := common
-SRC +=  $(addprefix $(gambatteCommonPath)/,$(gambatteCommonSrc))
-
 include $(EMUFRAMEWORK_PATH)/package/emuframework.mk
 include $(IMAGINE_PATH)/make/package/zlib.mk
 include $(IMAGINE_PATH)/make/package/stdc++.mk
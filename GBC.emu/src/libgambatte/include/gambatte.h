@@ -55,36 +55,53 @@ public:
 	LoadRes load(const void *romdata, std::size_t size, std::string const &romfilename, unsigned const flags = 0);
 
 	/**
-	  * Emulates until at least 'samples' audio samples are produced in the
-	  * supplied audio buffer, or until a video frame has been drawn.
+	  * Emulates until at least 'samples' audio clock ticks (2097152 Hz) have elapsed,
+	  * or until a video frame has been drawn.
 	  *
-	  * There are 35112 audio (stereo) samples in a video frame.
-	  * May run for up to 2064 audio samples too long.
+	  * There are 35112 audio clock ticks in a video frame.
+	  * May run for up to 2064 ticks too long.
 	  *
-	  * An audio sample consists of two native endian 2s complement 16-bit PCM samples,
-	  * with the left sample preceding the right one. Usually casting audioBuf to
-	  * int16_t* is OK. The reason for using an uint_least32_t* in the interface is to
-	  * avoid implementation-defined behavior without compromising performance.
-	  * libgambatte is strictly c++98, so fixed-width types are not an option (and even
-	  * c99/c++11 cannot guarantee their availability).
+	  * Audio is synthesized band-limited at the rate set with setSampleRate while
+	  * emulating, and the generated samples are fetched with readSamples.
 	  *
 	  * Returns early when a new video frame has finished drawing in the video buffer,
 	  * such that the caller may update the video output before the frame is overwritten.
 	  * The return value indicates whether a new video frame has been drawn, and the
-	  * exact time (in number of samples) at which it was completed.
+	  * exact time (in number of audio clock ticks) at which it was completed.
 	  *
 	  * @param videoBuf 160x144 RGB32 (native endian) video frame buffer or 0
 	  * @param pitch distance in number of pixels (not bytes) from the start of one line
 	  *              to the next in videoBuf.
-	  * @param audioBuf buffer with space >= samples + 2064
-	  * @param samples  in: number of stereo samples to produce,
-	  *                out: actual number of samples produced
-	  * @return sample offset in audioBuf at which the video frame was completed, or -1
+	  * @param samples  in: number of audio clock ticks to run,
+	  *                out: actual number of ticks run
+	  * @return tick offset at which the video frame was completed, or -1
 	  *         if no new video frame was completed.
 	  */
 	std::ptrdiff_t runFor(gambatte::PixelType *videoBuf, std::ptrdiff_t pitch,
-	                      gambatte::uint_least32_t *audioBuf, std::size_t &samples,
-	                      void (*videoFrameCallback)());
+	                      std::size_t &samples, void (*videoFrameCallback)());
+
+	/**
+	  * Sets the output sample rate of the band-limited audio synthesis.
+	  * Any samples not yet read are discarded.
+	  */
+	void setSampleRate(unsigned long rate);
+
+	/**
+	  * Reads up to maxSamples audio samples generated by runFor.
+	  *
+	  * An audio sample consists of two native endian 2s complement 16-bit PCM samples,
+	  * with the left sample preceding the right one. Usually casting audioBuf to
+	  * int16_t* is OK. The reason for using an uint_least32_t* in the interface is to
+	  * avoid implementation-defined behavior without compromising performance.
+	  * libgambatte is strictly c++98, so fixed-width types are not an option (and even
+	  * c99/c++11 cannot guarantee their availability).
+	  *
+	  * @return number of samples written to audioBuf
+	  */
+	std::size_t readSamples(gambatte::uint_least32_t *audioBuf, std::size_t maxSamples);
+
+	/** Number of audio samples generated by runFor that haven't been read yet. */
+	std::size_t samplesAvail() const;
 
 	/**
 	  * Reset to initial state.
@@ -62,8 +62,10 @@ public:
 	bool loaded() const { return mem_.loaded(); }
 	char const * romTitle() const { return mem_.romTitle(); }
 	PakInfo const pakInfo(bool multicartCompat) const { return mem_.pakInfo(multicartCompat); }
-	void setSoundBuffer(uint_least32_t *buf) { mem_.setSoundBuffer(buf); }
 	std::size_t fillSoundBuffer() { return mem_.fillSoundBuffer(cycleCounter_); }
+	void setSampleRate(unsigned long rate) { mem_.setSampleRate(rate); }
+	std::size_t readSamples(uint_least32_t *buf, std::size_t maxSamples) { return mem_.readSamples(buf, maxSamples); }
+	std::size_t samplesAvail() const { return mem_.samplesAvail(); }
 	bool isCgb() const { return mem_.isCgb(); }
 
 	void setDmgPaletteColor(int palNum, int colorNum, unsigned long rgb32) {
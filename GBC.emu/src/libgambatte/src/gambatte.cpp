@@ -57,14 +57,13 @@ GB::~GB() {
 }
 
 std::ptrdiff_t GB::runFor(gambatte::PixelType *const videoBuf, std::ptrdiff_t const pitch,
-                          gambatte::uint_least32_t *const soundBuf, std::size_t &samples, void (*videoFrameCallback)()) {
+                          std::size_t &samples, void (*videoFrameCallback)()) {
 	if (!p_->cpu.loaded()) {
 		samples = 0;
 		return -1;
 	}
 
 	p_->cpu.setVideoBuffer(videoBuf, pitch);
-	p_->cpu.setSoundBuffer(soundBuf);
 
 	long const cyclesSinceBlit = p_->cpu.runFor(samples * 2);
 	if(videoFrameCallback)
@@ -77,6 +76,18 @@ std::ptrdiff_t GB::runFor(gambatte::PixelType *const videoBuf, std::ptrdiff_t co
 	     : cyclesSinceBlit;
 }
 
+void GB::setSampleRate(unsigned long rate) {
+	p_->cpu.setSampleRate(rate);
+}
+
+std::size_t GB::readSamples(gambatte::uint_least32_t *audioBuf, std::size_t maxSamples) {
+	return p_->cpu.readSamples(audioBuf, maxSamples);
+}
+
+std::size_t GB::samplesAvail() const {
+	return p_->cpu.samplesAvail();
+}
+
 void GB::reset() {
 	if (p_->cpu.loaded()) {
 		p_->cpu.saveSavedata();
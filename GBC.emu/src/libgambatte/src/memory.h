@@ -97,8 +97,10 @@ public:
 	void setSaveDir(std::string const &dir) { cart_.setSaveDir(dir); }
 	void setInputGetter(InputGetter *getInput) { getInput_ = getInput; }
 	void setEndtime(unsigned long cc, unsigned long inc);
-	void setSoundBuffer(uint_least32_t *buf) { psg_.setBuffer(buf); }
 	std::size_t fillSoundBuffer(unsigned long cc);
+	void setSampleRate(unsigned long rate) { psg_.setSampleRate(rate); }
+	std::size_t readSamples(uint_least32_t *buf, std::size_t maxSamples) { return psg_.readSamples(buf, maxSamples); }
+	std::size_t samplesAvail() const { return psg_.samplesAvail(); }
 
 	void setVideoBuffer(PixelType *videoBuf, std::ptrdiff_t pitch) {
 		lcd_.setVideoBuffer(videoBuf, pitch);
@@ -19,7 +19,6 @@
 #include "sound.h"
 #include "savestate.h"
 #include <algorithm>
-#include <cstring>
 
 /*
 	Frame Sequencer
@@ -46,11 +45,9 @@ Clock) clock timer on transition to step.
 namespace gambatte {
 
 PSG::PSG()
-: buffer_(0)
-, bufferPos_(0)
+: bufferPos_(0)
 , lastUpdate_(0)
 , soVol_(0)
-, rsum_(0x8000) // initialize to 0x8000 to prevent borrows from high word, xor away later
 , enabled_(false)
 {
 }
@@ -91,12 +88,10 @@ void PSG::loadState(SaveState const &state) {
 }
 
 void PSG::accumulateChannels(unsigned long const cycles) {
-	uint_least32_t *const buf = buffer_ + bufferPos_;
-	std::memset(buf, 0, cycles * sizeof *buf);
-	ch1_.update(buf, soVol_, cycles);
-	ch2_.update(buf, soVol_, cycles);
-	ch3_.update(buf, soVol_, cycles);
-	ch4_.update(buf, soVol_, cycles);
+	ch1_.update(blip_, bufferPos_, soVol_, cycles);
+	ch2_.update(blip_, bufferPos_, soVol_, cycles);
+	ch3_.update(blip_, bufferPos_, soVol_, cycles);
+	ch4_.update(blip_, bufferPos_, soVol_, cycles);
 }
 
 void PSG::generateSamples(unsigned long const cycleCounter, bool const doubleSpeed) {
@@ -115,45 +110,18 @@ void PSG::resetCounter(unsigned long newCc, unsigned long oldCc, bool doubleSpee
 }
 
 std::size_t PSG::fillBuffer() {
-	uint_least32_t sum = rsum_;
-	uint_least32_t *b = buffer_;
-	std::size_t n = bufferPos_;
-
-	if (std::size_t n2 = n >> 3) {
-		n -= n2 << 3;
-
-		do {
-			sum += b[0];
-			b[0] = sum ^ 0x8000;
-			sum += b[1];
-			b[1] = sum ^ 0x8000;
-			sum += b[2];
-			b[2] = sum ^ 0x8000;
-			sum += b[3];
-			b[3] = sum ^ 0x8000;
-			sum += b[4];
-			b[4] = sum ^ 0x8000;
-			sum += b[5];
-			b[5] = sum ^ 0x8000;
-			sum += b[6];
-			b[6] = sum ^ 0x8000;
-			sum += b[7];
-			b[7] = sum ^ 0x8000;
-
-			b += 8;
-		} while (--n2);
-	}
-
-	while (n--) {
-		sum += *b;
-		// xor away the initial rsum value of 0x8000 (which prevents
-		// borrows from the high word) from the low word
-		*b++ = sum ^ 0x8000;
-	}
-
-	rsum_ = sum;
-
-	return bufferPos_;
+	std::size_t const cycles = bufferPos_;
+	blip_.endFrame(cycles);
+	bufferPos_ = 0;
+	return cycles;
+}
+
+void PSG::setSampleRate(unsigned long rate) {
+	if (rate == blip_.sampleRate())
+		return;
+
+	blip_.setRates(2097152, rate);
+	blip_.clear();
 }
 
 static bool isBigEndianSampleOrder() {
@@ -23,6 +23,7 @@
 #include "sound/channel2.h"
 #include "sound/channel3.h"
 #include "sound/channel4.h"
+#include "sound/blip_buffer.h"
 
 namespace gambatte {
 
@@ -38,7 +39,9 @@ public:
 	void generateSamples(unsigned long cycleCounter, bool doubleSpeed);
 	void resetCounter(unsigned long newCc, unsigned long oldCc, bool doubleSpeed);
 	std::size_t fillBuffer();
-	void setBuffer(uint_least32_t *buf) { buffer_ = buf; bufferPos_ = 0; }
+	void setSampleRate(unsigned long rate);
+	std::size_t readSamples(uint_least32_t *buf, std::size_t maxSamples) { return blip_.readSamples(buf, maxSamples); }
+	std::size_t samplesAvail() const { return blip_.samplesAvail(); }
 
 	bool isEnabled() const { return enabled_; }
 	void setEnabled(bool value) { enabled_ = value; }
@@ -76,11 +79,10 @@ private:
 	Channel2 ch2_;
 	Channel3 ch3_;
 	Channel4 ch4_;
-	uint_least32_t *buffer_;
+	BlipBuffer blip_;
 	std::size_t bufferPos_;
 	unsigned long lastUpdate_;
 	unsigned long soVol_;
-	uint_least32_t rsum_;
 	bool enabled_;
 
 	void accumulateChannels(unsigned long cycles);
@@ -0,0 +1,154 @@
+//
+//   This program is free software; you can redistribute it and/or modify
+//   it under the terms of the GNU General Public License version 2 as
+//   published by the Free Software Foundation.
+//
+//   This program is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//   GNU General Public License version 2 for more details.
+//
+//   You should have received a copy of the GNU General Public License
+//   version 2 along with this program; if not, write to the
+//   Free Software Foundation, Inc.,
+//   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+//
+
+#include "blip_buffer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace gambatte {
+
+namespace {
+
+enum { frac_bits = 32 };
+
+// pass band edge relative to the output rate
+double const cutoff = 0.45;
+
+inline int lane(unsigned long v) {
+	return static_cast<int>((v & 0xFFFF) ^ 0x8000) - 0x8000;
+}
+
+inline uint_least32_t clampSample(int v) {
+	v = std::min(std::max(v, -0x8000), 0x7FFF);
+	return v & 0xFFFF;
+}
+
+}
+
+BlipBuffer::BlipBuffer()
+: factor_(0)
+, offset_(0)
+, sampleRate_(0)
+, avail_(0)
+, sumLo_(0)
+, sumHi_(0)
+{
+	makeKernel();
+	std::memset(bufLo_, 0, sizeof bufLo_);
+	std::memset(bufHi_, 0, sizeof bufHi_);
+}
+
+void BlipBuffer::makeKernel() {
+	double const pi = 3.14159265358979323846;
+
+	for (int p = 0; p < phases; ++p) {
+		double taps[width];
+		double sum = 0;
+
+		for (int k = 0; k < width; ++k) {
+			double const t = k - (half_width - 1) - static_cast<double>(p) / phases;
+			double const x = 2 * cutoff * t;
+			double const sinc = x == 0 ? 1 : std::sin(pi * x) / (pi * x);
+			double const w = 0.42 + 0.5 * std::cos(pi * t / half_width)
+			               + 0.08 * std::cos(2 * pi * t / half_width);
+			taps[k] = std::abs(t) < half_width ? sinc * w : 0;
+			sum += taps[k];
+		}
+
+		// each impulse must integrate to exactly 1 << kernel_bits so steps settle
+		// on the exact target amplitude, put the rounding error on the largest tap
+		int isum = 0;
+		int peak = 0;
+		for (int k = 0; k < width; ++k) {
+			kernel_[p][k] = static_cast<short>(std::floor(taps[k] / sum * (1 << kernel_bits) + 0.5));
+			isum += kernel_[p][k];
+			if (kernel_[p][k] > kernel_[p][peak])
+				peak = k;
+		}
+
+		kernel_[p][peak] += (1 << kernel_bits) - isum;
+	}
+}
+
+void BlipBuffer::setRates(unsigned long clockRate, unsigned long sampleRate) {
+	sampleRate_ = sampleRate;
+	factor_ = (static_cast<unsigned long long>(sampleRate) << frac_bits) / clockRate;
+}
+
+void BlipBuffer::clear() {
+	// settle pending steps into the running sums, the channels keep
+	// emitting deltas relative to the current output level
+	for (std::size_t i = 0; i < buffer_size + width; ++i) {
+		sumLo_ += bufLo_[i];
+		sumHi_ += bufHi_[i];
+	}
+
+	std::memset(bufLo_, 0, sizeof bufLo_);
+	std::memset(bufHi_, 0, sizeof bufHi_);
+	offset_ = 0;
+	avail_ = 0;
+}
+
+void BlipBuffer::addDeltaImpl(unsigned long const time, uint_least32_t const delta) {
+	unsigned long long const pos = offset_ + time * factor_;
+	std::size_t const index = std::min(static_cast<std::size_t>(pos >> frac_bits),
+	                                   static_cast<std::size_t>(buffer_size - 1));
+	short const *const k = kernel_[pos >> (frac_bits - phase_bits) & (phases - 1)];
+	int const dLo = lane(delta);
+	int const dHi = lane((delta - dLo) >> 16);
+	int *const lo = bufLo_ + index;
+	int *const hi = bufHi_ + index;
+
+	for (int i = 0; i < width; ++i) {
+		lo[i] += dLo * k[i];
+		hi[i] += dHi * k[i];
+	}
+}
+
+void BlipBuffer::endFrame(unsigned long const time) {
+	offset_ += time * factor_;
+	avail_ = std::min(static_cast<std::size_t>(offset_ >> frac_bits),
+	                  static_cast<std::size_t>(buffer_size));
+}
+
+std::size_t BlipBuffer::readSamples(uint_least32_t *out, std::size_t maxSamples) {
+	std::size_t const n = std::min(maxSamples, avail_);
+	int sumLo = sumLo_;
+	int sumHi = sumHi_;
+
+	for (std::size_t i = 0; i < n; ++i) {
+		sumLo += bufLo_[i];
+		sumHi += bufHi_[i];
+		out[i] = clampSample(sumHi >> kernel_bits) << 16
+		       | clampSample(sumLo >> kernel_bits);
+	}
+
+	sumLo_ = sumLo;
+	sumHi_ = sumHi;
+
+	// shift the unread samples and the impulse tails past them to the front
+	std::size_t const remain = avail_ - n + width;
+	std::memmove(bufLo_, bufLo_ + n, remain * sizeof *bufLo_);
+	std::memmove(bufHi_, bufHi_ + n, remain * sizeof *bufHi_);
+	std::memset(bufLo_ + remain, 0, n * sizeof *bufLo_);
+	std::memset(bufHi_ + remain, 0, n * sizeof *bufHi_);
+	offset_ -= static_cast<unsigned long long>(n) << frac_bits;
+	avail_ -= n;
+	return n;
+}
+
+}
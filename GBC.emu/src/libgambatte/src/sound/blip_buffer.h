@@ -0,0 +1,70 @@
+//
+//   This program is free software; you can redistribute it and/or modify
+//   it under the terms of the GNU General Public License version 2 as
+//   published by the Free Software Foundation.
+//
+//   This program is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//   GNU General Public License version 2 for more details.
+//
+//   You should have received a copy of the GNU General Public License
+//   version 2 along with this program; if not, write to the
+//   Free Software Foundation, Inc.,
+//   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+//
+
+#ifndef BLIP_BUFFER_H
+#define BLIP_BUFFER_H
+
+#include "gbint.h"
+#include <cstddef>
+
+namespace gambatte {
+
+// Band-limited step synthesis straight to the output sample rate.
+// Channels add packed stereo amplitude deltas (same lane layout as the
+// output samples) at their clock time, each delta is spread over a short
+// windowed-sinc impulse at the matching sub-sample phase, and reading
+// integrates the impulses back into band-limited square waves. This
+// replaces rendering every 2 MHz clock and resampling afterwards.
+class BlipBuffer {
+public:
+	enum { phase_bits = 5, phases = 1 << phase_bits };
+	enum { half_width = 8, width = half_width * 2 };
+	enum { kernel_bits = 14 };
+	enum { buffer_size = 4096 };
+
+	BlipBuffer();
+	void setRates(unsigned long clockRate, unsigned long sampleRate);
+	unsigned long sampleRate() const { return sampleRate_; }
+	// discards unread samples, keeping the current output level
+	void clear();
+
+	void addDelta(unsigned long time, uint_least32_t delta) {
+		if (delta)
+			addDeltaImpl(time, delta);
+	}
+
+	void endFrame(unsigned long time);
+	std::size_t samplesAvail() const { return avail_; }
+	std::size_t readSamples(uint_least32_t *out, std::size_t maxSamples);
+
+private:
+	int bufLo_[buffer_size + width];
+	int bufHi_[buffer_size + width];
+	short kernel_[phases][width];
+	unsigned long long factor_;
+	unsigned long long offset_;
+	unsigned long sampleRate_;
+	std::size_t avail_;
+	int sumLo_;
+	int sumHi_;
+
+	void addDeltaImpl(unsigned long time, uint_least32_t delta);
+	void makeKernel();
+};
+
+}
+
+#endif
@@ -214,7 +214,7 @@ void Channel1::loadState(SaveState const &state) {
 	master_ = state.spu.ch1.master;
 }
 
-void Channel1::update(uint_least32_t *buf, unsigned long const soBaseVol, unsigned long cycles) {
+void Channel1::update(BlipBuffer &blip, unsigned long time, unsigned long const soBaseVol, unsigned long cycles) {
 	unsigned long const outBase = envelopeUnit_.dacIsOn() ? soBaseVol & soMask_ : 0;
 	unsigned long const outLow = outBase * (0 - 15ul);
 	unsigned long const endCycles = cycleCounter_ + cycles;
@@ -227,9 +227,9 @@ void Channel1::update(uint_least32_t *buf, unsigned long const soBaseVol, unsign
 		unsigned long out = dutyUnit_.isHighState() ? outHigh : outLow;
 
 		while (dutyUnit_.counter() <= nextMajorEvent) {
-			*buf = out - prevOut_;
+			blip.addDelta(time, out - prevOut_);
 			prevOut_ = out;
-			buf += dutyUnit_.counter() - cycleCounter_;
+			time += dutyUnit_.counter() - cycleCounter_;
 			cycleCounter_ = dutyUnit_.counter();
 
 			dutyUnit_.event();
@@ -237,9 +237,9 @@ void Channel1::update(uint_least32_t *buf, unsigned long const soBaseVol, unsign
 		}
 
 		if (cycleCounter_ < nextMajorEvent) {
-			*buf = out - prevOut_;
+			blip.addDelta(time, out - prevOut_);
 			prevOut_ = out;
-			buf += nextMajorEvent - cycleCounter_;
+			time += nextMajorEvent - cycleCounter_;
 			cycleCounter_ = nextMajorEvent;
 		}
 
@@ -19,6 +19,7 @@
 #ifndef SOUND_CHANNEL1_H
 #define SOUND_CHANNEL1_H
 
+#include "blip_buffer.h"
 #include "duty_unit.h"
 #include "envelope_unit.h"
 #include "gbint.h"
@@ -40,7 +41,7 @@ public:
 	void setNr4(unsigned data);
 	void setSo(unsigned long soMask);
 	bool isActive() const { return master_; }
-	void update(uint_least32_t *buf, unsigned long soBaseVol, unsigned long cycles);
+	void update(BlipBuffer &blip, unsigned long time, unsigned long soBaseVol, unsigned long cycles);
 	void reset();
 	void init(bool cgb);
 	void saveState(SaveState &state);
@@ -113,7 +113,7 @@ void Channel2::loadState(SaveState const &state) {
 	master_ = state.spu.ch2.master;
 }
 
-void Channel2::update(uint_least32_t *buf, unsigned long const soBaseVol, unsigned long cycles) {
+void Channel2::update(BlipBuffer &blip, unsigned long time, unsigned long const soBaseVol, unsigned long cycles) {
 	unsigned long const outBase = envelopeUnit_.dacIsOn() ? soBaseVol & soMask_ : 0;
 	unsigned long const outLow = outBase * (0 - 15ul);
 	unsigned long const endCycles = cycleCounter_ + cycles;
@@ -126,9 +126,9 @@ void Channel2::update(uint_least32_t *buf, unsigned long const soBaseVol, unsign
 		unsigned long out = dutyUnit_.isHighState() ? outHigh : outLow;
 
 		while (dutyUnit_.counter() <= nextMajorEvent) {
-			*buf += out - prevOut_;
+			blip.addDelta(time, out - prevOut_);
 			prevOut_ = out;
-			buf += dutyUnit_.counter() - cycleCounter_;
+			time += dutyUnit_.counter() - cycleCounter_;
 			cycleCounter_ = dutyUnit_.counter();
 
 			dutyUnit_.event();
@@ -136,9 +136,9 @@ void Channel2::update(uint_least32_t *buf, unsigned long const soBaseVol, unsign
 		}
 
 		if (cycleCounter_ < nextMajorEvent) {
-			*buf += out - prevOut_;
+			blip.addDelta(time, out - prevOut_);
 			prevOut_ = out;
-			buf += nextMajorEvent - cycleCounter_;
+			time += nextMajorEvent - cycleCounter_;
 			cycleCounter_ = nextMajorEvent;
 		}
 
@@ -142,7 +142,7 @@ void Channel3::updateWaveCounter(unsigned long const cc) {
 	}
 }
 
-void Channel3::update(uint_least32_t *buf, unsigned long const soBaseVol, unsigned long cycles) {
+void Channel3::update(BlipBuffer &blip, unsigned long time, unsigned long const soBaseVol, unsigned long cycles) {
 	unsigned long const outBase = nr0_/* & 0x80*/ ? soBaseVol & soMask_ : 0;
 
 	if (outBase && rshift_ != 4) {
@@ -157,9 +157,9 @@ void Channel3::update(uint_least32_t *buf, unsigned long const soBaseVol, unsign
 			out *= outBase;
 
 			while (waveCounter_ <= nextMajorEvent) {
-				*buf += out - prevOut_;
+				blip.addDelta(time, out - prevOut_);
 				prevOut_ = out;
-				buf += waveCounter_ - cycleCounter_;
+				time += waveCounter_ - cycleCounter_;
 				cycleCounter_ = waveCounter_;
 
 				lastReadTime_ = waveCounter_;
@@ -172,9 +172,9 @@ void Channel3::update(uint_least32_t *buf, unsigned long const soBaseVol, unsign
 			}
 
 			if (cycleCounter_ < nextMajorEvent) {
-				*buf += out - prevOut_;
+				blip.addDelta(time, out - prevOut_);
 				prevOut_ = out;
-				buf += nextMajorEvent - cycleCounter_;
+				time += nextMajorEvent - cycleCounter_;
 				cycleCounter_ = nextMajorEvent;
 			}
 
@@ -185,7 +185,7 @@ void Channel3::update(uint_least32_t *buf, unsigned long const soBaseVol, unsign
 		}
 	} else {
 		unsigned long const out = outBase * (0 - 15ul);
-		*buf += out - prevOut_;
+		blip.addDelta(time, out - prevOut_);
 		prevOut_ = out;
 		cycleCounter_ += cycles;
 
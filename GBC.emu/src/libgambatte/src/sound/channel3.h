@@ -19,6 +19,7 @@
 #ifndef SOUND_CHANNEL3_H
 #define SOUND_CHANNEL3_H
 
+#include "blip_buffer.h"
 #include "gbint.h"
 #include "length_counter.h"
 #include "master_disabler.h"
@@ -42,7 +43,7 @@ public:
 	void setNr3(unsigned data) { nr3_ = data; }
 	void setNr4(unsigned data);
 	void setSo(unsigned long soMask);
-	void update(uint_least32_t *buf, unsigned long soBaseVol, unsigned long cycles);
+	void update(BlipBuffer &blip, unsigned long time, unsigned long soBaseVol, unsigned long cycles);
 
 	unsigned waveRamRead(unsigned index) const {
 		if (master_) {
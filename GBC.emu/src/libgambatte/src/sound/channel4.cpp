@@ -215,7 +215,7 @@ void Channel4::loadState(SaveState const &state) {
 	master_ = state.spu.ch4.master;
 }
 
-void Channel4::update(uint_least32_t *buf, unsigned long const soBaseVol, unsigned long cycles) {
+void Channel4::update(BlipBuffer &blip, unsigned long time, unsigned long const soBaseVol, unsigned long cycles) {
 	unsigned long const outBase = envelopeUnit_.dacIsOn() ? soBaseVol & soMask_ : 0;
 	unsigned long const outLow = outBase * (0 - 15ul);
 	unsigned long const endCycles = cycleCounter_ + cycles;
@@ -226,9 +226,9 @@ void Channel4::update(uint_least32_t *buf, unsigned long const soBaseVol, unsign
 		unsigned long out = lfsr_.isHighState() ? outHigh : outLow;
 
 		while (lfsr_.counter() <= nextMajorEvent) {
-			*buf += out - prevOut_;
+			blip.addDelta(time, out - prevOut_);
 			prevOut_ = out;
-			buf += lfsr_.counter() - cycleCounter_;
+			time += lfsr_.counter() - cycleCounter_;
 			cycleCounter_ = lfsr_.counter();
 
 			lfsr_.event();
@@ -236,9 +236,9 @@ void Channel4::update(uint_least32_t *buf, unsigned long const soBaseVol, unsign
 		}
 
 		if (cycleCounter_ < nextMajorEvent) {
-			*buf += out - prevOut_;
+			blip.addDelta(time, out - prevOut_);
 			prevOut_ = out;
-			buf += nextMajorEvent - cycleCounter_;
+			time += nextMajorEvent - cycleCounter_;
 			cycleCounter_ = nextMajorEvent;
 		}
 
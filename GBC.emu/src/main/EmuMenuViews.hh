@@ -35,31 +35,6 @@ class SystemOptionView : public OptionView
 		}
 	};
 
-	MultiChoiceSelectMenuItem resampler
-	{
-		"Resampler",
-		[](MultiChoiceMenuItem &, View &, int val)
-		{
-			optionAudioResampler = val;
-			EmuSystem::configAudioPlayback();
-		}
-	};
-
-	const char *resamplerName[4] {nullptr};
-
-	void resamplerInit()
-	{
-		logMsg("%d resamplers", (int)ResamplerInfo::num());
-		auto resamplers = std::min(ResamplerInfo::num(), sizeofArray(resamplerName));
-		iterateTimes(resamplers, i)
-		{
-			ResamplerInfo r = ResamplerInfo::get(i);
-			logMsg("%d %s", i, r.desc);
-			resamplerName[i] = r.desc;
-		}
-		resampler.init(resamplerName, int(optionAudioResampler), resamplers);
-	}
-
 	BoolMenuItem reportAsGba
 	{
 		"Report Hardware as GBA",
@@ -87,12 +62,6 @@ class SystemOptionView : public OptionView
 public:
 	SystemOptionView(Base::Window &win): OptionView(win) {}
 
-	void loadAudioItems(MenuItem *item[], uint &items)
-	{
-		OptionView::loadAudioItems(item, items);
-		resamplerInit(); item[items++] = &resampler;
-	}
-
 	void loadVideoItems(MenuItem *item[], uint &items)
 	{
 		OptionView::loadVideoItems(item, items);
@@ -19,15 +19,12 @@
 #include <emuframework/EmuOptions.hh>
 #include <emuframework/CommonFrameworkIncludes.hh>
 #include <gambatte.h>
-#include <resample/resampler.h>
-#include <resample/resamplerinfo.h>
 #include <main/Cheats.hh>
 #include <main/Palette.hh>
 
 const char *creditsViewStr = CREDITS_INFO_STRING "(c) 2011-2014\nRobert Broglia\nwww.explusalpha.com\n\n(c) 2011\nthe Gambatte Team\ngambatte.sourceforge.net";
 gambatte::GB gbEmu;
-static Resampler *resampler{};
-static uint8 activeResampler = 1;
+static long audioOutputRate = 0;
 static const GBPalette *gameBuiltinPalette{};
 
 // controls
@@ -77,7 +74,6 @@ static Byte1Option optionGBPal
 		(CFGKEY_GB_PAL_IDX, 0, 0, optionIsValidWithMax<sizeofArray(gbPal)-1>);
 static Byte1Option optionUseBuiltinGBPalette(CFGKEY_USE_BUILTIN_GB_PAL, 1);
 static Byte1Option optionReportAsGba(CFGKEY_REPORT_AS_GBA, 0);
-static Byte1Option optionAudioResampler(CFGKEY_AUDIO_RESAMPLER, 1);
 
 static void applyGBPalette()
 {
@@ -159,7 +155,6 @@ bool EmuSystem::readConfig(IO &io, uint key, uint readSize)
 		bcase CFGKEY_GB_PAL_IDX: optionGBPal.readFromIO(io, readSize);
 		bcase CFGKEY_REPORT_AS_GBA: optionReportAsGba.readFromIO(io, readSize);
 		bcase CFGKEY_FULL_GBC_SATURATION: optionFullGbcSaturation.readFromIO(io, readSize);
-		bcase CFGKEY_AUDIO_RESAMPLER: optionAudioResampler.readFromIO(io, readSize);
 		bcase CFGKEY_USE_BUILTIN_GB_PAL: optionUseBuiltinGBPalette.readFromIO(io, readSize);
 	}
 	return 1;
@@ -170,7 +165,6 @@ void EmuSystem::writeConfig(IO &io)
 	optionGBPal.writeWithKeyIfNotDefault(io);
 	optionReportAsGba.writeWithKeyIfNotDefault(io);
 	optionFullGbcSaturation.writeWithKeyIfNotDefault(io);
-	optionAudioResampler.writeWithKeyIfNotDefault(io);
 	optionUseBuiltinGBPalette.writeWithKeyIfNotDefault(io);
 }
 
@@ -399,15 +393,11 @@ void EmuSystem::configAudioRate(double frameTime)
 {
 	pcmFormat.rate = optionSoundRate;
 	long outputRate = std::round(optionSoundRate * (59.73 * frameTime));
-	long inputRate = 2097152;
-	if(optionAudioResampler >= ResamplerInfo::num())
-		optionAudioResampler = std::min((int)ResamplerInfo::num(), 1);
-	if(!resampler || optionAudioResampler != activeResampler || resampler->outRate() != outputRate)
+	if(outputRate != audioOutputRate)
 	{
-		logMsg("setting up resampler %d for input rate %ldHz", (int)optionAudioResampler, inputRate);
-		delete resampler;
-		resampler = ResamplerInfo::get(optionAudioResampler).create(inputRate, outputRate, 35112 + 2064);
-		activeResampler = optionAudioResampler;
+		logMsg("setting audio synthesis rate to %ldHz", outputRate);
+		gbEmu.setSampleRate(outputRate);
+		audioOutputRate = outputRate;
 	}
 }
 
@@ -418,10 +408,14 @@ static void commitVideoFrame()
 
 void EmuSystem::runFrame(bool renderGfx, bool processGfx, bool renderAudio)
 {
-	alignas(std::max_align_t) uint8 snd[(35112+2064)*4];
 	size_t samples = 35112;
-	int frameSample = gbEmu.runFor(processGfx ? screenBuff : nullptr, 160, (uint_least32_t*)snd, samples,
+	int frameSample = gbEmu.runFor(processGfx ? screenBuff : nullptr, 160, samples,
 		renderGfx ? commitVideoFrame : nullptr);
+	// video rendered in runFor(), audio is synthesized at the output rate while emulating
+	const uint destBuffFrames = Audio::maxRate()/54;
+	auto soundBuff = getSoundBuffer(destBuffFrames, renderAudio);
+	auto destBuff = (gambatte::uint_least32_t*)soundBuff.data;
+	uint destFrames = gbEmu.readSamples(destBuff, destBuffFrames);
 	if(renderAudio)
 	{
 		if(frameSample == -1)
@@ -431,21 +425,19 @@ void EmuSystem::runFrame(bool renderGfx, bool processGfx, bool renderAudio)
 		//else logMsg("emulated frame at %d with %d samples", frameSample, samples);
 		if(unlikely(samples < 34000))
 		{
-			uint repeatPos = std::max((int)samples-1, 0);
-			uint32 *sndFrame = (uint32*)snd;
-			logMsg("only %d, repeat %d", (int)samples, (int)sndFrame[repeatPos]);
-			for(uint i = samples; i < 35112; i++)
+			// pad the short frame with its last sample to keep the output rate steady
+			auto repeatSample = destFrames ? destBuff[destFrames-1] : 0;
+			uint padFrames = (35112 - samples) * audioOutputRate / 2097152;
+			uint frames = std::min(destFrames + padFrames, destBuffFrames);
+			logMsg("only %d, repeat %d", (int)samples, (int)repeatSample);
+			for(uint i = destFrames; i < frames; i++)
 			{
-				sndFrame[i] = sndFrame[repeatPos];
+				destBuff[i] = repeatSample;
 			}
-			samples = 35112;
+			destFrames = frames;
 		}
-		// video rendered in runFor()
-		short destBuff[(Audio::maxRate()/54)*2];
-		uint destFrames = resampler->resample(destBuff, (const short*)snd, samples);
-		assert(Audio::pcmFormat.framesToBytes(destFrames) <= sizeof(destBuff));
-		EmuSystem::writeSound(destBuff, destFrames);
 	}
+	commitSound(soundBuff, destFrames);
 }
 
 bool EmuSystem::hasInputOptions() { return false; }
@@ -293,15 +293,17 @@ void EmuSystem::runFrame(bool renderGfx, bool processGfx, bool renderAudio)
 {
 	//logMsg("frame start");
 	RAMCheatUpdate();
-	system_frame(!processGfx, renderGfx);
-
-	int16 audioBuff[snd.buffer_size * 2];
-	int frames = audio_update(audioBuff);
-	if(renderAudio)
 	{
-		//logMsg("%d frames", frames);
-		writeSound(audioBuff, frames);
+		// includes VDP rendering, which runs per line with the 68K
+		EMU_PROFILE_SCOPE(CORE_CPU);
+		system_frame(!processGfx, renderGfx);
 	}
+
+	EMU_PROFILE_SCOPE(CORE_SOUND);
+	auto audioBuff = getSoundBuffer(snd.buffer_size, renderAudio);
+	int frames = audio_update((int16*)audioBuff.data);
+	//logMsg("%d frames", frames);
+	commitSound(audioBuff, frames);
 	//logMsg("frame end");
 }
 
@@ -241,17 +241,22 @@ static void fix_value_init(void) {
 
 #define fix_add(x, y) ((((READ_WORD(memory.vid.ram + 0xEA00 + (((y-1)&31)*2 + 64 * (x/6))) >> (5-(x%6))*2) & 3) ^ 3))
 
+#include "video_simd.h"
+
 /* Drawing function generation */
 #define RENAME(name) name##_tile
 #define PUTPIXEL(dst,src) dst=src
+#define TILE_BLEND TILE_BLEND_NORM
 #include "video_template.h"
 
 #define RENAME(name) name##_tile_50
 #define PUTPIXEL(dst,src) dst=BLEND16_50(src,dst)
+#define TILE_BLEND TILE_BLEND_50
 #include "video_template.h"
 
 #define RENAME(name) name##_tile_25
 #define PUTPIXEL(dst,src) dst=BLEND16_25(src,dst)
+#define TILE_BLEND TILE_BLEND_25
 #include "video_template.h"
 
 #ifdef PROCESSOR_ARM
@@ -387,6 +392,12 @@ static __inline__ void draw_fix_char(unsigned char *buf, int start, int end) {
 #else
 			paldata = (unsigned int *) &current_pc_pal[16 * byte2];
 			gfxdata = (unsigned int *) &current_fix[ byte1 << 5];
+#ifdef HAVE_TILE_SIMD
+			if (tile_simd) {
+				draw_fix_char_simd(gfxdata, paldata, br, buffer->w);
+				continue;
+			}
+#endif
 
 			for (yy = 0; yy < 8; yy++) {
 				myword = gfxdata[yy];
@@ -864,5 +875,8 @@ void init_video(void) {
 	mem_video = memory.vid.ram;
 #endif
 	fix_value_init();
+#ifdef HAVE_TILE_SIMD
+	tile_simd_init();
+#endif
 	memory.vid.modulo = 1;
 }
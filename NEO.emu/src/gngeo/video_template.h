@@ -1,6 +1,7 @@
 /* Tile drawing template
    use RENAME to set the name of the function
    use PUTPIXEL(dest,src) to set the putpixel function/macro
+   use TILE_BLEND to set the matching SIMD blend mode
 */
 
 
@@ -31,6 +32,21 @@ static __inline__ void RENAME(draw)(unsigned int tileno,int sx,int sy,int zx,int
     else
         l_y_skip=dda_y_skip;
 
+#ifdef HAVE_TILE_SIMD
+    if (tile_simd) {
+#ifdef DEBUG_VIDEO
+        int pitch=544;
+#else
+        int pitch=buffer->pitch>>1;
+#endif
+        if (sx+16<=pitch) {
+            br= (unsigned short *)bmp+(yflip ? (zy-1)+sy : sy)*pitch+sx;
+            draw_tile_simd(gfxdata,paldata,br,yflip ? -pitch : pitch,zx,zy,l_y_skip,xflip,TILE_BLEND);
+            return;
+        }
+    }
+#endif
+
     if (zx==16) {
         if (xflip) {
             l=0;
@@ -331,6 +347,22 @@ static inline void RENAME(draw_scanline)(unsigned int tileno,int yoffs,int sx,in
   
     if (gfxdata[1]+gfxdata[0]==0) return;
 
+#ifdef HAVE_TILE_SIMD
+    if (tile_simd) {
+#ifdef DEBUG_VIDEO
+        int pitch=512+32;
+#else
+        int pitch=buffer->pitch>>1;
+#endif
+        /* zx is the zoom table index here, 16 when unzoomed */
+        if (sx+16<=pitch) {
+            draw_scanline_tile_simd(gfxdata,paldata,(unsigned short *)bmp+(line)*pitch+sx,
+                                    zx==16 ? 16 : zx+1,xflip,TILE_BLEND);
+            return;
+        }
+    }
+#endif
+
     if (zx==16) {
         if (xflip)
         {
@@ -446,3 +478,4 @@ static inline void RENAME(draw_scanline)(unsigned int tileno,int yoffs,int sx,in
 
 #undef RENAME
 #undef PUTPIXEL
+#undef TILE_BLEND
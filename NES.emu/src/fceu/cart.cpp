@@ -44,7 +44,7 @@ uint8 *VPageG[8];
 uint8 *MMC5SPRVPage[8];
 uint8 *MMC5BGVPage[8];
 
-static uint8 PRGIsRAM[32];  /* This page is/is not PRG RAM. */
+uint8 PRGIsRAM[32];  /* This page is/is not PRG RAM. */
 
 /* 16 are (sort of) reserved for UNIF/iNES and 16 to map other stuff. */
 uint8 CHRram[32];
@@ -90,6 +90,7 @@ static INLINE void setpageptr(int s, uint32 A, uint8 *p, int ram) {
 			PRGIsRAM[AB + x] = 0;
 			Page[AB + x] = 0;
 		}
+	FCEU_UpdateMemPages(A, A + (s << 10) - 1);
 }
 
 static uint8 nothing[8192];
@@ -103,6 +104,7 @@ void ResetCartMapping(void) {
 		PRGptr[x] = CHRptr[x] = 0;
 		PRGsize[x] = CHRsize[x] = 0;
 	}
+	FCEU_UpdateMemPages(0, 0xFFFF);
 	for (x = 0; x < 8; x++) {
 		MMC5SPRVPage[x] = MMC5BGVPage[x] = VPageR[x] = nothing - 0x400 * x;
 	}
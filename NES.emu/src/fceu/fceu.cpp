@@ -277,6 +277,7 @@ void FlushGenieRW(void) {
 		AReadG = NULL;
 		BWriteG = NULL;
 		RWWrap = 0;
+		FCEU_UpdateMemHandlers(0x8000, 0xFFFF);
 	}
 }
 
@@ -303,6 +304,7 @@ void SetReadHandler(int32 start, int32 end, readfunc func) {
 	else
 		for (x = end; x >= start; x--)
 			ARead[x] = func;
+	FCEU_UpdateMemHandlers(start, end);
 }
 
 writefunc GetWriteHandler(int32 a) {
@@ -328,6 +330,7 @@ void SetWriteHandler(int32 start, int32 end, writefunc func) {
 	else
 		for (x = end; x >= start; x--)
 			BWrite[x] = func;
+	FCEU_UpdateMemHandlers(start, end);
 }
 
 uint8 GameMemBlock[GAME_MEM_BLOCK_SIZE];
@@ -371,6 +374,50 @@ static DECLFR(ARAMH) {
 	return RAM[A & 0x7FF];
 }
 
+uint8 *RdPage[0x100];
+uint8 *WrPage[0x100];
+//handler shared by every address of a page, NULL if they differ
+static readfunc RdPageHandler[0x100];
+static writefunc WrPageHandler[0x100];
+
+void FCEU_UpdateMemHandlers(uint32 start, uint32 end) {
+	for (uint32 p = start >> 8; p <= (end >> 8) && p < 0x100; p++) {
+		uint32 A = p << 8;
+		readfunc r = ARead[A];
+		writefunc w = BWrite[A];
+		for (uint32 x = A + 1; x < A + 0x100; x++) {
+			if (ARead[x] != r)
+				r = NULL;
+			if (BWrite[x] != w)
+				w = NULL;
+		}
+		RdPageHandler[p] = r;
+		WrPageHandler[p] = w;
+	}
+	FCEU_UpdateMemPages(start, end);
+}
+
+//Pages get a direct pointer only when the page's handler plainly accesses RAM or
+//cartridge memory, so the CPU can skip the handler call without side effects
+void FCEU_UpdateMemPages(uint32 start, uint32 end) {
+	for (uint32 p = start >> 8; p <= (end >> 8) && p < 0x100; p++) {
+		uint32 A = p << 8;
+		readfunc r = RdPageHandler[p];
+		writefunc w = WrPageHandler[p];
+		uint8 *rp = NULL, *wp = NULL;
+		if (r == ARAML || r == ARAMH)
+			rp = RAM + (A & 0x7FF) - A;
+		else if (r == CartBR || r == CartBROB)
+			rp = Page[A >> 11];
+		if (w == BRAML || w == BRAMH)
+			wp = RAM + (A & 0x7FF) - A;
+		else if (w == CartBW && PRGIsRAM[A >> 11])
+			wp = Page[A >> 11];
+		RdPage[p] = rp;
+		WrPage[p] = wp;
+	}
+}
+
 
 void ResetGameLoaded(void) {
 	if (GameInfo) FCEU_CloseGame();
@@ -58,6 +58,15 @@ uint8 FCEU_ReadRomByte(uint32 i);
 extern readfunc ARead[0x10000];
 extern writefunc BWrite[0x10000];
 
+//direct pointers to the memory of each 256 byte CPU page, indexed by the full address,
+//NULL when the page must go through ARead/BWrite
+extern uint8 *RdPage[0x100];
+extern uint8 *WrPage[0x100];
+//call after changing ARead/BWrite entries without SetReadHandler/SetWriteHandler
+void FCEU_UpdateMemHandlers(uint32 start, uint32 end);
+//call after changing Page/PRGIsRAM entries
+void FCEU_UpdateMemPages(uint32 start, uint32 end);
+
 enum GI {
 	GI_RESETM2	=1,
 	GI_POWER =2,
@@ -12,6 +12,17 @@
 
 #include <cmath>
 #include <cstdio>
+#ifdef FCEU_BENCHMARK_FILTER
+#include <chrono>
+#include <vector>
+#endif
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__SSE4_1__)
+#include <smmintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 static int32 sq2coeffs[SQ2NCOEFFS];
 static int32 coeffs[NCOEFFS];
@@ -91,6 +102,72 @@ template void SexyFilter(FCEU_SoundSample *in, FCEU_SoundSample *out, int32 coun
 
 //static uint32 mva=1000;
 
+/* Computes the FIR output for the input sample at S and the one after it.
+   The coefficient tables are symmetric so both walk forward through memory.
+   Each product is shifted before accumulating, exactly like the original
+   scalar loop, so the vector versions give bit-identical results.
+   n must be a multiple of 4.
+*/
+#if defined(__SSE2__) && !defined(__SSE4_1__)
+static inline __m128i mullo_epi32(__m128i a, __m128i b)
+{
+ __m128i even=_mm_mul_epu32(a,b);
+ __m128i odd=_mm_mul_epu32(_mm_srli_epi64(a,32),_mm_srli_epi64(b,32));
+ return _mm_unpacklo_epi32(_mm_shuffle_epi32(even,_MM_SHUFFLE(0,0,2,0)),_mm_shuffle_epi32(odd,_MM_SHUFFLE(0,0,2,0)));
+}
+#endif
+
+static inline void FIRPairScalar(const FCEU_SoundSample2 *S, const int32 *D, uint32 n, int32 &accOut, int32 &acc2Out)
+{
+ int32 acc=0,acc2=0;
+ for(uint32 i=0;i<n;i++)
+ {
+  acc+=(S[i]*D[i])>>6;
+  acc2+=(S[i+1]*D[i])>>6;
+ }
+ accOut=acc;
+ acc2Out=acc2;
+}
+
+static inline void FIRPair(const FCEU_SoundSample2 *S, const int32 *D, uint32 n, int32 &accOut, int32 &acc2Out)
+{
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+ int32x4_t acc=vdupq_n_s32(0),acc2=vdupq_n_s32(0);
+ for(uint32 i=0;i<n;i+=4)
+ {
+  int32x4_t d=vld1q_s32(D+i);
+  acc=vaddq_s32(acc,vshrq_n_s32(vmulq_s32(vld1q_s32(S+i),d),6));
+  acc2=vaddq_s32(acc2,vshrq_n_s32(vmulq_s32(vld1q_s32(S+i+1),d),6));
+ }
+ int32x2_t sum=vpadd_s32(vadd_s32(vget_low_s32(acc),vget_high_s32(acc)),
+  vadd_s32(vget_low_s32(acc2),vget_high_s32(acc2)));
+ accOut=vget_lane_s32(sum,0);
+ acc2Out=vget_lane_s32(sum,1);
+#elif defined(__SSE2__)
+ #ifdef __SSE4_1__
+ #define FIR_MULLO _mm_mullo_epi32
+ #else
+ #define FIR_MULLO mullo_epi32
+ #endif
+ __m128i acc=_mm_setzero_si128(),acc2=_mm_setzero_si128();
+ for(uint32 i=0;i<n;i+=4)
+ {
+  __m128i d=_mm_loadu_si128((const __m128i*)(D+i));
+  acc=_mm_add_epi32(acc,_mm_srai_epi32(FIR_MULLO(_mm_loadu_si128((const __m128i*)(S+i)),d),6));
+  acc2=_mm_add_epi32(acc2,_mm_srai_epi32(FIR_MULLO(_mm_loadu_si128((const __m128i*)(S+i+1)),d),6));
+ }
+ #undef FIR_MULLO
+ // horizontal sums, giving acc in lane 0 and acc2 in lane 1
+ __m128i lo=_mm_unpacklo_epi32(acc,acc2),hi=_mm_unpackhi_epi32(acc,acc2);
+ __m128i sum=_mm_add_epi32(lo,hi);
+ sum=_mm_add_epi32(sum,_mm_shuffle_epi32(sum,_MM_SHUFFLE(1,0,3,2)));
+ accOut=_mm_cvtsi128_si32(sum);
+ acc2Out=_mm_cvtsi128_si32(_mm_shuffle_epi32(sum,_MM_SHUFFLE(1,1,1,1)));
+#else
+ FIRPairScalar(S,D,n,accOut,acc2Out);
+#endif
+}
+
 /* This filtering code assumes that almost all input values stay below 32767.
    Do not adjust the volume in the wlookup tables and the expansion sound
    code to be higher, or you *might* overflow the FIR code.
@@ -112,16 +189,8 @@ int32 NeoFilterSound(FCEU_SoundSample2 *in, FCEU_SoundSample2 *out, uint32 inlen
 	if(FSettings.soundq==2)
          for(x=mrindex;x<max;x+=mrratio)
          {
-          int32 acc=0,acc2=0;
-          unsigned int c;
-          const FCEU_SoundSample2 *S;
-          const int32 *D;
-         
-          for(c=SQ2NCOEFFS,S=&in[(x>>16)-SQ2NCOEFFS],D=sq2coeffs;c;c--,D++)
-          {
-           acc+=(S[c]**D)>>6;
-           acc2+=(S[1+c]**D)>>6;
-          }
+          int32 acc,acc2;
+          FIRPair(&in[(x>>16)-SQ2NCOEFFS+1],sq2coeffs,SQ2NCOEFFS,acc,acc2);
 
           acc=((int64)acc*(65536-(x&65535))+(int64)acc2*(x&65535))>>(16+11);
           *out=acc;
@@ -131,16 +200,8 @@ int32 NeoFilterSound(FCEU_SoundSample2 *in, FCEU_SoundSample2 *out, uint32 inlen
 	else
          for(x=mrindex;x<max;x+=mrratio)
          {
-          int32 acc=0,acc2=0;
-          unsigned int c;
-          const FCEU_SoundSample2 *S;
-          const int32 *D;
- 
-          for(c=NCOEFFS,S=&in[(x>>16)-NCOEFFS],D=coeffs;c;c--,D++)
- 	  {
- 	   acc+=(S[c]**D)>>6;
- 	   acc2+=(S[1+c]**D)>>6;
- 	  }
+          int32 acc,acc2;
+          FIRPair(&in[(x>>16)-NCOEFFS+1],coeffs,NCOEFFS,acc,acc2);
  
           acc=((int64)acc*(65536-(x&65535))+(int64)acc2*(x&65535))>>(16+11);  
           *out=acc;
@@ -212,3 +273,62 @@ void MakeFilters(int32 rate)
  }
  #endif
 }
+
+#ifdef FCEU_BENCHMARK_FILTER
+/* Microbenchmark for FIRPair(). Runs pseudo-random APU output through every
+   coefficient table with both FIRPair() and the scalar loop, checks that each
+   output pair matches exactly, and prints how long each version took. Build with
+   -DFCEU_BENCHMARK_FILTER in a debug build to run it at startup.
+*/
+void FCEU_BenchmarkFilter()
+{
+ using namespace std::chrono;
+ const int32 *tabs[12]={C44100NTSC,C44100PAL,C48000NTSC,C48000PAL,C96000NTSC,C96000PAL,
+  SQ2C44100NTSC,SQ2C44100PAL,SQ2C48000NTSC,SQ2C48000PAL,SQ2C96000NTSC,SQ2C96000PAL};
+ const uint32 outputs=4096,step=40;
+ std::vector<FCEU_SoundSample2> in(outputs*step+SQ2NCOEFFS+1);
+ uint32 seed=1;
+ for(auto &s : in)
+ {
+  seed=seed*1103515245+12345;
+  s=(seed>>16)&0x7FFF;
+ }
+ std::vector<int32> D(SQ2NCOEFFS);
+ for(int t=0;t<12;t++)
+ {
+  uint32 n=t<6?NCOEFFS:SQ2NCOEFFS;
+  for(uint32 x=0;x<n>>1;x++)
+   D[x]=D[n-1-x]=tabs[t][x];
+  int32 vecSum=0,refSum=0;
+  uint32 mismatches=0;
+  auto start=steady_clock::now();
+  for(uint32 o=0;o<outputs;o++)
+  {
+   int32 acc,acc2;
+   FIRPair(&in[o*step],D.data(),n,acc,acc2);
+   vecSum+=acc^acc2;
+  }
+  auto vecTime=steady_clock::now()-start;
+  start=steady_clock::now();
+  for(uint32 o=0;o<outputs;o++)
+  {
+   int32 acc,acc2;
+   FIRPairScalar(&in[o*step],D.data(),n,acc,acc2);
+   refSum+=acc^acc2;
+  }
+  auto refTime=steady_clock::now()-start;
+  for(uint32 o=0;o<outputs;o++)
+  {
+   int32 acc,acc2,refAcc,refAcc2;
+   FIRPair(&in[o*step],D.data(),n,acc,acc2);
+   FIRPairScalar(&in[o*step],D.data(),n,refAcc,refAcc2);
+   if(acc!=refAcc || acc2!=refAcc2)
+    mismatches++;
+  }
+  FCEU_printf("FIR table %d (%u taps): %lldus vs %lldus scalar, %u mismatches%s\n",t,n,
+   (long long)duration_cast<microseconds>(vecTime).count(),
+   (long long)duration_cast<microseconds>(refTime).count(),
+   mismatches,vecSum!=refSum?" (checksum differs)":"");
+ }
+}
+#endif
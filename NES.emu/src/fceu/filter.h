@@ -4,3 +4,6 @@ int32 NeoFilterSound(FCEU_SoundSample2 *in, FCEU_SoundSample2 *out, uint32 inlen
 void MakeFilters(int32 rate);
 template<class InSample>
 void SexyFilter(InSample *in, FCEU_SoundSample *out, int32 count);
+#ifdef FCEU_BENCHMARK_FILTER
+void FCEU_BenchmarkFilter();
+#endif
@@ -1217,6 +1217,9 @@ static void Fixit1(void) {
 // native pixel buffer
 NATIVE_PIX_TYPE nativeCol[256];
 NATIVE_PIX_TYPE	nativePixBuff[nesPixX*nesVisiblePixY] __attribute__ ((aligned (8))) {0};
+// where DoLine() writes, the frontend's video buffer for committed frames
+static NATIVE_PIX_TYPE *nativePixOut = nativePixBuff;
+static uint nativePixPitch = nesPixX;
 static uint8 lineBuffer[272] __attribute__ ((aligned (4)));
 
 void MMC5_hb(int);     //Ugh ugh ugh.
@@ -1252,8 +1255,8 @@ static void DoLine(void) {
 			}
 		}
 		uint y =  scanline - 8;
-		assert(y*nesPixX < nesPixX*nesVisiblePixY);
-		NATIVE_PIX_TYPE *outLine = &nativePixBuff[(y*nesPixX)];
+		assert(y < nesVisiblePixY);
+		NATIVE_PIX_TYPE *outLine = &nativePixOut[(y*nativePixPitch)];
 		if((PPU[1] >> 5) == 0x7)
 		{
 			//for(x=63;x>=0;x--)
@@ -1717,6 +1720,7 @@ void FCEUPPU_Power(void) {
 		BWrite[x + 7] = B2007;
 	}
 	BWrite[0x4014] = B4014;
+	FCEU_UpdateMemHandlers(0x2000, 0x40FF);
 }
 
 int FCEUPPU_Loop(int skip, bool commit) {
@@ -1806,6 +1810,14 @@ int FCEUPPU_Loop(int skip, bool commit) {
 			int x, max, maxref;
 
 			deemp = PPU[1] >> 5;
+			extern NATIVE_PIX_TYPE *FCEUD_startVideo(uint &pitch);
+			if(commit)
+				nativePixOut = FCEUD_startVideo(nativePixPitch);
+			else
+			{
+				nativePixOut = nativePixBuff;
+				nativePixPitch = nesPixX;
+			}
 			for (scanline = 0; scanline < 240; ) {      //scanline is incremented in  DoLine.  Evil. :/
 				deempcnt[deemp]++;
 				DEBUG(FCEUD_UpdatePPUView(scanline, 1));
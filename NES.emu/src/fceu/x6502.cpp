@@ -45,13 +45,20 @@ void (*MapIRQHook)(int a);
 //normal memory read
 static INLINE uint8 RdMem(unsigned int A)
 {
+ uint8 *p=RdPage[A>>8];
+ if(p)
+  return(_DB=p[A]);
  return(_DB=ARead[A](A));
 }
 
 //normal memory write
 static INLINE void WrMem(unsigned int A, uint8 V)
 {
-	BWrite[A](A,V);
+	uint8 *p=WrPage[A>>8];
+	if(p)
+		p[A]=V;
+	else
+		BWrite[A](A,V);
 	#ifdef _S9XLUA_H
 	CallRegisteredLuaMemHook(A, 1, V, LUAMEMHOOK_WRITE);
 	#endif
@@ -60,7 +67,7 @@ static INLINE void WrMem(unsigned int A, uint8 V)
 static INLINE uint8 RdRAM(unsigned int A) 
 {
   //bbit edited: this was changed so cheat substituion would work
-  return(_DB=ARead[A](A));
+  return RdMem(A);
   // return(_DB=RAM[A]); 
 }
 
@@ -75,13 +82,17 @@ static INLINE void WrRAM(unsigned int A, uint8 V)
 uint8 X6502_DMR(uint32 A)
 {
  ADDCYC(1);
- return(X.DB=ARead[A](A));
+ return RdMem(A);
 }
 
 void X6502_DMW(uint32 A, uint8 V)
 {
  ADDCYC(1);
- BWrite[A](A,V);
+ uint8 *p=WrPage[A>>8];
+ if(p)
+  p[A]=V;
+ else
+  BWrite[A](A,V);
  #ifdef _S9XLUA_H
  CallRegisteredLuaMemHook(A, 1, V, LUAMEMHOOK_WRITE);
  #endif
@@ -120,6 +120,25 @@ public:
 		videoSystem.init(str, std::min((int)optionVideoSystem, (int)sizeofArray(str)-1), sizeofArray(str));
 	}
 
+	MultiChoiceSelectMenuItem soundQuality
+	{
+		"Sound Quality",
+		[](MultiChoiceMenuItem &, View &, int val)
+		{
+			optionSoundQuality = val;
+			FCEUI_SetSoundQuality(val);
+		}
+	};
+
+	void soundQualityInit()
+	{
+		static const char *str[] =
+		{
+			"Normal", "High", "Highest"
+		};
+		soundQuality.init(str, std::min((int)optionSoundQuality, (int)sizeofArray(str)-1), sizeofArray(str));
+	}
+
 public:
 	SystemOptionView(Base::Window &win): OptionView(win) {}
 
@@ -129,6 +148,12 @@ public:
 		videoSystemInit(); item[items++] = &videoSystem;
 	}
 
+	void loadAudioItems(MenuItem *item[], uint &items)
+	{
+		OptionView::loadAudioItems(item, items);
+		soundQualityInit(); item[items++] = &soundQuality;
+	}
+
 	void loadInputItems(MenuItem *item[], uint &items)
 	{
 		OptionView::loadInputItems(item, items);
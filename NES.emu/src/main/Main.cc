@@ -18,6 +18,7 @@
 #include <emuframework/EmuInput.hh>
 #include <emuframework/CommonFrameworkIncludes.hh>
 #include "EmuConfig.hh"
+#include <emuframework/EmuOptions.hh>
 
 const char *creditsViewStr = CREDITS_INFO_STRING "(c) 2011-2014\nRobert Broglia\nwww.explusalpha.com\n\nPortions (c) the\nFCEUX Team\nfceux.com";
 uint fceuCheats = 0;
@@ -29,6 +30,7 @@ uint fceuCheats = 0;
 #include <fceu/fds.h>
 #include <fceu/input.h>
 #include <fceu/cheat.h>
+#include <fceu/filter.h>
 
 static bool hasFDSBIOSExtension(const char *name)
 {
@@ -75,13 +77,14 @@ static ESI nesInputPortDev[2]{SI_UNSET, SI_UNSET};
 
 enum {
 	CFGKEY_FDS_BIOS_PATH = 270, CFGKEY_FOUR_SCORE = 271,
-	CFGKEY_VIDEO_SYSTEM = 272,
+	CFGKEY_VIDEO_SYSTEM = 272, CFGKEY_SOUND_QUALITY = 273,
 };
 
 FS::PathString fdsBiosPath{};
 static PathOption optionFdsBiosPath(CFGKEY_FDS_BIOS_PATH, fdsBiosPath, "");
 static Byte1Option optionFourScore(CFGKEY_FOUR_SCORE, 0);
 static Byte1Option optionVideoSystem(CFGKEY_VIDEO_SYSTEM, 0);
+static Byte1Option optionSoundQuality(CFGKEY_SOUND_QUALITY, 1, false, optionIsValidWithMax<2>);
 static uint autoDetectedVidSysPAL = 0;
 
 const char *EmuSystem::inputFaceBtnName = "A/B";
@@ -141,7 +144,10 @@ static void setDirOverrides()
 
 void EmuSystem::initOptions() {}
 
-void EmuSystem::onOptionsLoaded() {}
+void EmuSystem::onOptionsLoaded()
+{
+	FCEUI_SetSoundQuality(optionSoundQuality);
+}
 
 bool EmuSystem::readConfig(IO &io, uint key, uint readSize)
 {
@@ -151,6 +157,7 @@ bool EmuSystem::readConfig(IO &io, uint key, uint readSize)
 		bcase CFGKEY_FOUR_SCORE: optionFourScore.readFromIO(io, readSize);
 		bcase CFGKEY_FDS_BIOS_PATH: optionFdsBiosPath.readFromIO(io, readSize);
 		bcase CFGKEY_VIDEO_SYSTEM: optionVideoSystem.readFromIO(io, readSize);
+		bcase CFGKEY_SOUND_QUALITY: optionSoundQuality.readFromIO(io, readSize);
 		logMsg("fds bios path %s", fdsBiosPath.data());
 	}
 	return 1;
@@ -160,6 +167,7 @@ void EmuSystem::writeConfig(IO &io)
 {
 	optionFourScore.writeWithKeyIfNotDefault(io);
 	optionVideoSystem.writeWithKeyIfNotDefault(io);
+	optionSoundQuality.writeWithKeyIfNotDefault(io);
 	optionFdsBiosPath.writeToIO(io);
 }
 
@@ -522,6 +530,13 @@ void FCEUD_RenderPPULine(uint8 *line, uint y)
 }
 #endif
 
+NATIVE_PIX_TYPE *FCEUD_startVideo(uint &pitch)
+{
+	auto pix = emuVideo.startFrame();
+	pitch = pix.pitchPixels();
+	return (NATIVE_PIX_TYPE*)pix.pixel({});
+}
+
 void FCEUD_commitVideo()
 {
 	updateAndDrawEmuVideo();
@@ -530,11 +545,11 @@ void FCEUD_commitVideo()
 void FCEUD_emulateSound()
 {
 	const uint maxAudioFrames = EmuSystem::audioFramesPerVideoFrame+2;
-	int16 sound[maxAudioFrames];
-	uint frames = FlushEmulateSound(sound);
+	auto soundBuff = EmuSystem::getSoundBuffer(maxAudioFrames);
+	uint frames = FlushEmulateSound((int16*)soundBuff.data);
 	assert(frames <= maxAudioFrames);
 	//logMsg("%d frames", frames);
-	EmuSystem::writeSound(sound, frames);
+	EmuSystem::commitSound(soundBuff, frames);
 }
 
 void EmuSystem::runFrame(bool renderGfx, bool processGfx, bool renderAudio)
@@ -612,6 +627,8 @@ CallResult EmuSystem::onInit()
 	{
 		bug_exit("error in FCEUI_Initialize");
 	}
-	//FCEUI_SetSoundQuality(2);
+	#ifdef FCEU_BENCHMARK_FILTER
+	FCEU_BenchmarkFilter();
+	#endif
 	return OK;
 }
@@ -333,9 +333,9 @@ void EmuSystem::runFrame(bool renderGfx, bool processGfx, bool renderAudio)
 
 	if(renderAudio)
 	{
-		uint16 destBuff[audioFramesPerVideoFrame];
-		sound_update(destBuff, audioFramesPerVideoFrame*2);
-		writeSound(destBuff, audioFramesPerVideoFrame);
+		auto soundBuff = getSoundBuffer(audioFramesPerVideoFrame);
+		sound_update((uint16*)soundBuff.data, audioFramesPerVideoFrame*2);
+		commitSound(soundBuff, audioFramesPerVideoFrame);
 	}
 }
 
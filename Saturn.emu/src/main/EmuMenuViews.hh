@@ -58,6 +58,26 @@ public:
 		}
 
 		sh2Core.init(str, setting, cores);
+		sh2Core.active = !yinit.usesh2thread;
+	}
+
+	// the slave SH2 thread runs both SH2s on the interpreter, whatever the core
+	MultiChoiceSelectMenuItem sh2Thread
+	{
+		"Slave SH2 Thread",
+		[this](MultiChoiceMenuItem &, View &, int val)
+		{
+			optionSH2Thread = val;
+			yinit.usesh2thread = val;
+			sh2Core.active = !val;
+			postDraw();
+		}
+	};
+
+	void sh2ThreadInit()
+	{
+		static const char *str[] = { "Off", "On", "Serial Check" };
+		sh2Thread.init(str, int(optionSH2Thread), sizeofArray(str));
 	}
 
 public:
@@ -72,6 +92,7 @@ public:
 		{
 			sh2CoreInit(); item[items++] = &sh2Core;
 		}
+		sh2ThreadInit(); item[items++] = &sh2Thread;
 		printBiosMenuEntryStr(biosPathStr);
 		biosPath.init(biosPathStr); item[items++] = &biosPath;
 	}
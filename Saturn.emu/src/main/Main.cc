@@ -1,6 +1,7 @@
 #define LOGTAG "main"
 #include <emuframework/EmuSystem.hh>
 #include <emuframework/EmuInput.hh>
+#include <emuframework/EmuOptions.hh>
 #include <emuframework/CommonFrameworkIncludes.hh>
 #include "EmuConfig.hh"
 
@@ -197,7 +198,8 @@ enum
 };
 
 enum {
-	CFGKEY_BIOS_PATH = 279, CFGKEY_SH2_CORE = 280
+	CFGKEY_BIOS_PATH = 279, CFGKEY_SH2_CORE = 280,
+	CFGKEY_SH2_THREAD = 281
 };
 
 static bool OptionSH2CoreIsValid(uint8 val)
@@ -217,6 +219,7 @@ static bool OptionSH2CoreIsValid(uint8 val)
 FS::PathString biosPath{};
 static PathOption optionBiosPath(CFGKEY_BIOS_PATH, biosPath, "");
 static Byte1Option optionSH2Core(CFGKEY_SH2_CORE, defaultSH2CoreID, false, OptionSH2CoreIsValid);
+static Byte1Option optionSH2Thread(CFGKEY_SH2_THREAD, SH2THREAD_OFF, false, optionIsValidWithMax<SH2THREAD_CHECK>);
 
 static yabauseinit_struct yinit =
 {
@@ -286,6 +289,7 @@ void EmuSystem::initOptions()
 void EmuSystem::onOptionsLoaded()
 {
 	yinit.sh2coretype = optionSH2Core;
+	yinit.usesh2thread = optionSH2Thread;
 }
 
 bool EmuSystem::readConfig(IO &io, uint key, uint readSize)
@@ -295,6 +299,7 @@ bool EmuSystem::readConfig(IO &io, uint key, uint readSize)
 		default: return 0;
 		bcase CFGKEY_BIOS_PATH: optionBiosPath.readFromIO(io, readSize);
 		bcase CFGKEY_SH2_CORE: optionSH2Core.readFromIO(io, readSize);
+		bcase CFGKEY_SH2_THREAD: optionSH2Thread.readFromIO(io, readSize);
 	}
 	return 1;
 }
@@ -303,6 +308,7 @@ void EmuSystem::writeConfig(IO &io)
 {
 	optionBiosPath.writeToIO(io);
 	optionSH2Core.writeWithKeyIfNotDefault(io);
+	optionSH2Thread.writeWithKeyIfNotDefault(io);
 }
 
 EmuNameFilterFunc EmuFilePicker::defaultFsFilter = hasCDExtension;
@@ -427,6 +433,11 @@ CLINK void YuiSwapBuffers()
 	}
 }
 
+CLINK void YuiUpdateThreadScheduling()
+{
+	updateEmuWorkerThreadScheduling();
+}
+
 CLINK void YuiSetVideoAttribute(int type, int val) { }
 CLINK int YuiSetVideoMode(int width, int height, int bpp, int fullscreen) { return 0; }
 
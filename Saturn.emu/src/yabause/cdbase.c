@@ -27,6 +27,14 @@
 #include "error.h"
 #include "debug.h"
 
+#ifndef _WIN32
+#define ISOCD_ASYNC_IO
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
 #ifndef HAVE_STRICMP
 #ifdef HAVE_STRCASECMP
 #define stricmp strcasecmp
@@ -244,6 +252,8 @@ typedef struct
    int file_size;
    int file_id;
    int interleaved_sub;
+   u8 *map;
+   size_t map_size;
 } track_info_struct;
 
 typedef struct
@@ -332,6 +342,431 @@ static disc_info_struct disc;
 
 #define MSF_TO_FAD(m,s,f) ((m * 4500) + (s * 75) + f)
 
+//////////////////////////////////////////////////////////////////////////////
+// Image file access
+//
+// Track files are memory mapped when possible, with upcoming sectors
+// requested from the kernel as the drive reads ahead. Otherwise a worker
+// thread prefetches the blocks following the read position into a small
+// cache, so sequential reads don't wait on the storage device.
+//////////////////////////////////////////////////////////////////////////////
+
+#define ISO_READ_AHEAD_SIZE 0x40000
+
+#ifdef ISOCD_ASYNC_IO
+
+typedef struct
+{
+   FILE *fp;
+   u8 *map;
+   size_t size;
+} iso_file_map_struct;
+
+#define ISO_MAX_MAPS 100
+static iso_file_map_struct isoMap[ISO_MAX_MAPS];
+static int isoMapNum;
+static u64 isoAdvisedStart, isoAdvisedEnd;
+static u8 *isoAdvisedMap;
+
+#define ISO_CACHE_BLOCK_SIZE 0x10000
+#define ISO_CACHE_BLOCKS 16
+
+enum { ISO_BLOCK_EMPTY, ISO_BLOCK_QUEUED, ISO_BLOCK_LOADING, ISO_BLOCK_READY };
+
+typedef struct
+{
+   int fd;
+   u64 offset;
+   u32 size;
+   int state;
+   u32 last_use;
+   u8 *data;
+} iso_cache_block_struct;
+
+static struct
+{
+   pthread_t id;
+   pthread_mutex_t mutex;
+   pthread_cond_t request_cond;
+   pthread_cond_t ready_cond;
+   iso_cache_block_struct block[ISO_CACHE_BLOCKS];
+   u8 *data;
+   u32 use_count;
+   int running;
+   int quit;
+} IsoCache;
+
+//////////////////////////////////////////////////////////////////////////////
+
+static u8 *ISOMapFile(FILE *fp, size_t *size)
+{
+   struct stat st;
+   void *map;
+   int i;
+
+   for (i = 0; i < isoMapNum; i++)
+   {
+      if (isoMap[i].fp == fp)
+      {
+         *size = isoMap[i].size;
+         return isoMap[i].map;
+      }
+   }
+
+   if (isoMapNum == ISO_MAX_MAPS || fstat(fileno(fp), &st) != 0 || st.st_size <= 0)
+      return NULL;
+
+   // Fails on 32-bit systems with a fragmented address space, reads then
+   // go through the cache instead
+   map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fileno(fp), 0);
+   if (map == MAP_FAILED)
+      return NULL;
+
+   isoMap[isoMapNum].fp = fp;
+   isoMap[isoMapNum].map = map;
+   isoMap[isoMapNum].size = *size = st.st_size;
+   isoMapNum++;
+   return map;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+static void ISOUnmapFiles(void)
+{
+   int i;
+
+   for (i = 0; i < isoMapNum; i++)
+      munmap(isoMap[i].map, isoMap[i].size);
+   isoMapNum = 0;
+   isoAdvisedMap = NULL;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+static void ISOReadBlock(iso_cache_block_struct *block)
+{
+   ssize_t ret = pread(block->fd, block->data, ISO_CACHE_BLOCK_SIZE, block->offset);
+   block->size = ret > 0 ? ret : 0;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+static void *ISOCacheThread(UNUSED void *arg)
+{
+   pthread_mutex_lock(&IsoCache.mutex);
+   while (!IsoCache.quit)
+   {
+      iso_cache_block_struct *next = NULL;
+      int i;
+
+      // Load queued blocks in file order
+      for (i = 0; i < ISO_CACHE_BLOCKS; i++)
+      {
+         iso_cache_block_struct *block = &IsoCache.block[i];
+         if (block->state == ISO_BLOCK_QUEUED && (!next || block->offset < next->offset))
+            next = block;
+      }
+
+      if (!next)
+      {
+         pthread_cond_wait(&IsoCache.request_cond, &IsoCache.mutex);
+         continue;
+      }
+
+      next->state = ISO_BLOCK_LOADING;
+      pthread_mutex_unlock(&IsoCache.mutex);
+      ISOReadBlock(next);
+      pthread_mutex_lock(&IsoCache.mutex);
+      next->state = ISO_BLOCK_READY;
+      pthread_cond_broadcast(&IsoCache.ready_cond);
+   }
+   pthread_mutex_unlock(&IsoCache.mutex);
+   return NULL;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+static int ISOCacheStart(void)
+{
+   int i;
+
+   if (IsoCache.running)
+      return 0;
+
+   memset(&IsoCache, 0, sizeof(IsoCache));
+   if ((IsoCache.data = malloc(ISO_CACHE_BLOCKS * ISO_CACHE_BLOCK_SIZE)) == NULL)
+      return -1;
+
+   for (i = 0; i < ISO_CACHE_BLOCKS; i++)
+      IsoCache.block[i].data = IsoCache.data + i * ISO_CACHE_BLOCK_SIZE;
+
+   pthread_mutex_init(&IsoCache.mutex, NULL);
+   pthread_cond_init(&IsoCache.request_cond, NULL);
+   pthread_cond_init(&IsoCache.ready_cond, NULL);
+
+   if (pthread_create(&IsoCache.id, NULL, ISOCacheThread, NULL) != 0)
+   {
+      pthread_cond_destroy(&IsoCache.ready_cond);
+      pthread_cond_destroy(&IsoCache.request_cond);
+      pthread_mutex_destroy(&IsoCache.mutex);
+      free(IsoCache.data);
+      IsoCache.data = NULL;
+      return -1;
+   }
+
+   IsoCache.running = 1;
+   return 0;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+static void ISOCacheStop(void)
+{
+   if (!IsoCache.running)
+      return;
+
+   pthread_mutex_lock(&IsoCache.mutex);
+   IsoCache.quit = 1;
+   pthread_cond_signal(&IsoCache.request_cond);
+   pthread_mutex_unlock(&IsoCache.mutex);
+   pthread_join(IsoCache.id, NULL);
+
+   pthread_cond_destroy(&IsoCache.ready_cond);
+   pthread_cond_destroy(&IsoCache.request_cond);
+   pthread_mutex_destroy(&IsoCache.mutex);
+   free(IsoCache.data);
+   IsoCache.data = NULL;
+   IsoCache.running = 0;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+// Called with the cache mutex held
+
+static iso_cache_block_struct *ISOCacheFind(int fd, u64 offset)
+{
+   int i;
+
+   for (i = 0; i < ISO_CACHE_BLOCKS; i++)
+   {
+      iso_cache_block_struct *block = &IsoCache.block[i];
+      if (block->state != ISO_BLOCK_EMPTY && block->fd == fd && block->offset == offset)
+         return block;
+   }
+
+   return NULL;
+}
+
+static iso_cache_block_struct *ISOCacheClaim(int fd, u64 offset, int state)
+{
+   iso_cache_block_struct *victim = NULL;
+   int i;
+
+   for (i = 0; i < ISO_CACHE_BLOCKS; i++)
+   {
+      iso_cache_block_struct *block = &IsoCache.block[i];
+      if (block->state == ISO_BLOCK_QUEUED || block->state == ISO_BLOCK_LOADING)
+         continue;
+      if (!victim || block->state == ISO_BLOCK_EMPTY ||
+          (victim->state != ISO_BLOCK_EMPTY && block->last_use < victim->last_use))
+         victim = block;
+   }
+
+   if (victim)
+   {
+      victim->fd = fd;
+      victim->offset = offset;
+      victim->size = 0;
+      victim->state = state;
+      victim->last_use = IsoCache.use_count++;
+   }
+
+   return victim;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+static void ISOCacheRead(FILE *fp, u64 offset, u8 *dest, u32 size)
+{
+   int fd = fileno(fp);
+
+   pthread_mutex_lock(&IsoCache.mutex);
+   while (size)
+   {
+      u64 block_offset = offset & ~(u64)(ISO_CACHE_BLOCK_SIZE - 1);
+      u32 start = offset - block_offset;
+      u32 len = ISO_CACHE_BLOCK_SIZE - start;
+      iso_cache_block_struct *block = ISOCacheFind(fd, block_offset);
+
+      if (len > size)
+         len = size;
+
+      if (!block)
+      {
+         if ((block = ISOCacheClaim(fd, block_offset, ISO_BLOCK_LOADING)) == NULL)
+         {
+            // Every block is in flight, read around the cache
+            pthread_mutex_unlock(&IsoCache.mutex);
+            if (pread(fd, dest, len, offset) != (ssize_t)len)
+               memset(dest, 0, len);
+            pthread_mutex_lock(&IsoCache.mutex);
+            offset += len;
+            dest += len;
+            size -= len;
+            continue;
+         }
+         pthread_mutex_unlock(&IsoCache.mutex);
+         ISOReadBlock(block);
+         pthread_mutex_lock(&IsoCache.mutex);
+         block->state = ISO_BLOCK_READY;
+      }
+
+      // Only happens if reading ahead didn't keep up
+      while (block->state != ISO_BLOCK_READY)
+         pthread_cond_wait(&IsoCache.ready_cond, &IsoCache.mutex);
+
+      block->last_use = IsoCache.use_count++;
+      if (start < block->size)
+      {
+         u32 avail = block->size - start;
+         memcpy(dest, block->data + start, avail < len ? avail : len);
+         if (avail < len)
+            memset(dest + avail, 0, len - avail);
+      }
+      else
+         memset(dest, 0, len);
+
+      offset += len;
+      dest += len;
+      size -= len;
+   }
+   pthread_mutex_unlock(&IsoCache.mutex);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+static void ISOCacheQueue(FILE *fp, u64 offset, u32 size)
+{
+   int fd = fileno(fp);
+   u64 block_offset = offset & ~(u64)(ISO_CACHE_BLOCK_SIZE - 1);
+   int queued = 0;
+
+   pthread_mutex_lock(&IsoCache.mutex);
+   for (; block_offset < offset + size; block_offset += ISO_CACHE_BLOCK_SIZE)
+   {
+      iso_cache_block_struct *block = ISOCacheFind(fd, block_offset);
+      if (block)
+      {
+         // Keep upcoming blocks from being evicted before they're used
+         block->last_use = IsoCache.use_count++;
+         continue;
+      }
+      if (ISOCacheClaim(fd, block_offset, ISO_BLOCK_QUEUED) == NULL)
+         break;
+      queued = 1;
+   }
+   if (queued)
+      pthread_cond_signal(&IsoCache.request_cond);
+   pthread_mutex_unlock(&IsoCache.mutex);
+}
+
+#endif
+
+//////////////////////////////////////////////////////////////////////////////
+
+static void ISOReadTrackFile(track_info_struct *track, u64 offset, void *buffer, u32 size)
+{
+#ifdef ISOCD_ASYNC_IO
+   if (track->map)
+   {
+      if (offset < track->map_size)
+      {
+         size_t avail = track->map_size - offset;
+         memcpy(buffer, track->map + offset, avail < size ? avail : size);
+      }
+      return;
+   }
+
+   if (IsoCache.running)
+   {
+      ISOCacheRead(track->fp, offset, buffer, size);
+      return;
+   }
+#endif
+
+   fseek(track->fp, offset, SEEK_SET);
+   fread(buffer, size, 1, track->fp);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+static void ISOReadAheadTrackFile(track_info_struct *track, u64 offset)
+{
+#ifdef ISOCD_ASYNC_IO
+   if (track->map)
+   {
+      // Advise a new window once the read position is halfway through the
+      // last one, rather than a syscall per sector
+      if (track->map != isoAdvisedMap || offset < isoAdvisedStart ||
+          offset + ISO_READ_AHEAD_SIZE / 2 > isoAdvisedEnd)
+      {
+         long page_size = sysconf(_SC_PAGESIZE);
+         u64 start = offset & ~(u64)(page_size - 1);
+         u64 end = offset + ISO_READ_AHEAD_SIZE;
+
+         if (start >= track->map_size)
+            return;
+         if (end > track->map_size)
+            end = track->map_size;
+         madvise(track->map + start, end - start, MADV_WILLNEED);
+         isoAdvisedMap = track->map;
+         isoAdvisedStart = start;
+         isoAdvisedEnd = end;
+      }
+      return;
+   }
+
+   if (IsoCache.running)
+      ISOCacheQueue(track->fp, offset, ISO_READ_AHEAD_SIZE);
+#endif
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+static void ISOOpenTrackFiles(void)
+{
+#ifdef ISOCD_ASYNC_IO
+   int i, j, unmapped = 0;
+
+   for (i = 0; i < disc.session_num; i++)
+   {
+      for (j = 0; j < disc.session[i].track_num; j++)
+      {
+         track_info_struct *track = &disc.session[i].track[j];
+         if (!track->fp)
+            continue;
+         if ((track->map = ISOMapFile(track->fp, &track->map_size)) == NULL)
+            unmapped = 1;
+      }
+   }
+
+   if (unmapped && ISOCacheStart() != 0)
+   {
+      CDLOG("Warning: couldn't start the read-ahead thread");
+   }
+#endif
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+static void ISOCloseTrackFiles(void)
+{
+#ifdef ISOCD_ASYNC_IO
+   ISOCacheStop();
+   ISOUnmapFiles();
+#endif
+}
+
 //////////////////////////////////////////////////////////////////////////////
 
 static int LoadBinCue(const char *cuefilename, FILE *iso_file)
@@ -865,6 +1300,7 @@ static int ISOCDInit(const char * iso) {
    }   
 
    BuildTOC();
+   ISOOpenTrackFiles();
    return 0;
 }
 
@@ -872,6 +1308,7 @@ static int ISOCDInit(const char * iso) {
 
 static void ISOCDDeInit(void) {
    int i, j, k;
+   ISOCloseTrackFiles();
    if (disc.session)
    {
       for (i = 0; i < disc.session_num; i++)
@@ -915,14 +1352,10 @@ static s32 ISOCDReadTOC(u32 * TOC) {
 
 //////////////////////////////////////////////////////////////////////////////
 
-static int ISOCDReadSectorFAD(u32 FAD, void *buffer) {
+static track_info_struct *ISOCDFindTrack(u32 FAD) {
    int i,j;
    track_info_struct *track=NULL;
 
-   assert(disc.session);
-
-   memset(buffer, 0, 2448);
-
    for (i = 0; i < disc.session_num; i++)
    {
       for (j = 0; j < disc.session[i].track_num; j++)
@@ -936,17 +1369,32 @@ static int ISOCDReadSectorFAD(u32 FAD, void *buffer) {
       }
    }
 
+   return track;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+static int ISOCDReadSectorFAD(u32 FAD, void *buffer) {
+   int i;
+   track_info_struct *track;
+   u64 offset;
+
+   assert(disc.session);
+
+   memset(buffer, 0, 2448);
+
+   track = ISOCDFindTrack(FAD);
    if (track == NULL)
    {
       CDLOG("Warning: Sector not found in track list");
       return 0;
    }
 
-   fseek(track->fp, track->file_offset + (FAD-track->fad_start) * track->sector_size, SEEK_SET);
+   offset = track->file_offset + (u64)(FAD-track->fad_start) * track->sector_size;
    if (track->sector_size == 2448)
    {
       if (!track->interleaved_sub)
-         fread(buffer, 2448, 1, track->fp);
+         ISOReadTrackFile(track, offset, buffer, 2448);
       else
       {
          const u16 deint_offsets[] = {
@@ -959,15 +1407,13 @@ static int ISOCDReadSectorFAD(u32 FAD, void *buffer) {
             72, 138, 197, 263, 172, 122, 222, 247, 80, 105, 130, 155, 
             180, 205, 230, 255, 88, 113, 97, 163, 188, 213, 238, 147
          };
-         u8 subcode_buffer[96 * 3];
+         u8 subcode_buffer[96 * 3] = { 0 };
 
-         fread(buffer, 2352, 1, track->fp);
+         ISOReadTrackFile(track, offset, buffer, 2352);
 
-         fread(subcode_buffer, 96, 1, track->fp);
-         fseek(track->fp, 2352, SEEK_CUR);
-         fread(subcode_buffer+96, 96, 1, track->fp);
-         fseek(track->fp, 2352, SEEK_CUR);
-         fread(subcode_buffer+192, 96, 1, track->fp);
+         ISOReadTrackFile(track, offset + 2352, subcode_buffer, 96);
+         ISOReadTrackFile(track, offset + 2352 * 2 + 96, subcode_buffer+96, 96);
+         ISOReadTrackFile(track, offset + 2352 * 3 + 96 * 2, subcode_buffer+192, 96);
          for (i = 0; i < 96; i++)
             ((u8 *)buffer)[2352+i] = subcode_buffer[deint_offsets[i]];
       }
@@ -975,21 +1421,24 @@ static int ISOCDReadSectorFAD(u32 FAD, void *buffer) {
    else if (track->sector_size == 2352)
    {
       // Generate subcodes here
-      fread(buffer, 2352, 1, track->fp);
+      ISOReadTrackFile(track, offset, buffer, 2352);
    }
    else if (track->sector_size == 2048)
    {
       memcpy(buffer, syncHdr, 12);
-      fread((char *)buffer + 0x10, 2048, 1, track->fp);
+      ISOReadTrackFile(track, offset, (char *)buffer + 0x10, 2048);
    }
 	return 1;
 }
 
 //////////////////////////////////////////////////////////////////////////////
 
-static void ISOCDReadAheadFAD(UNUSED u32 FAD)
+static void ISOCDReadAheadFAD(u32 FAD)
 {
-	// No-op
+   track_info_struct *track = ISOCDFindTrack(FAD);
+
+   if (track)
+      ISOReadAheadTrackFile(track, track->file_offset + (u64)(FAD-track->fad_start) * track->sector_size);
 }
 
 //////////////////////////////////////////////////////////////////////////////
@@ -513,6 +513,17 @@ void MappedMemoryInit()
 
 //////////////////////////////////////////////////////////////////////////////
 
+// While the slave SH2 runs on its own thread, every access the other CPU
+// could observe goes through SH2SyncBegin()/SH2SyncEnd(), so both threads
+// see work RAM change in SH2 cycle order, cached or not. Only the BIOS ROM,
+// which nothing writes, is left out.
+static INLINE int MappedMemoryNeedsSync(u32 addr)
+{
+   return ((addr >> 16) & 0xFFF) >= 0x010;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
 u8 FASTCALL MappedMemoryReadByte(u32 addr)
 {
    switch (addr >> 29)
@@ -522,6 +533,16 @@ u8 FASTCALL MappedMemoryReadByte(u32 addr)
       case 0x5:
       {
          // Cache/Non-Cached
+         if (UNLIKELY(SH2InParallel) && MappedMemoryNeedsSync(addr))
+         {
+            u8 val;
+            SH2SyncBegin();
+            val = ReadByteList[(addr >> 16) & 0xFFF](addr);
+            if (UNLIKELY(SH2ThreadCheck))
+               SH2ThreadCheckAccess(addr, val, 1, 0);
+            SH2SyncEnd();
+            return val;
+         }
          return ReadByteList[(addr >> 16) & 0xFFF](addr);
       }
 /*
@@ -573,6 +594,16 @@ u16 FASTCALL MappedMemoryReadWord(u32 addr)
       case 0x5:
       {
          // Cache/Non-Cached
+         if (UNLIKELY(SH2InParallel) && MappedMemoryNeedsSync(addr))
+         {
+            u16 val;
+            SH2SyncBegin();
+            val = ReadWordList[(addr >> 16) & 0xFFF](addr);
+            if (UNLIKELY(SH2ThreadCheck))
+               SH2ThreadCheckAccess(addr, val, 2, 0);
+            SH2SyncEnd();
+            return val;
+         }
          return ReadWordList[(addr >> 16) & 0xFFF](addr);
       }
 /*
@@ -624,6 +655,16 @@ u32 FASTCALL MappedMemoryReadLong(u32 addr)
       case 0x5:
       {
          // Cache/Non-Cached
+         if (UNLIKELY(SH2InParallel) && MappedMemoryNeedsSync(addr))
+         {
+            u32 val;
+            SH2SyncBegin();
+            val = ReadLongList[(addr >> 16) & 0xFFF](addr);
+            if (UNLIKELY(SH2ThreadCheck))
+               SH2ThreadCheckAccess(addr, val, 4, 0);
+            SH2SyncEnd();
+            return val;
+         }
          return ReadLongList[(addr >> 16) & 0xFFF](addr);
       }
 /*
@@ -679,6 +720,15 @@ void FASTCALL MappedMemoryWriteByte(u32 addr, u8 val)
       case 0x5:
       {
          // Cache/Non-Cached
+         if (UNLIKELY(SH2InParallel) && MappedMemoryNeedsSync(addr))
+         {
+            SH2SyncBegin();
+            WriteByteList[(addr >> 16) & 0xFFF](addr, val);
+            if (UNLIKELY(SH2ThreadCheck))
+               SH2ThreadCheckAccess(addr, val, 1, 1);
+            SH2SyncEnd();
+            return;
+         }
          WriteByteList[(addr >> 16) & 0xFFF](addr, val);
          return;
       }
@@ -732,6 +782,15 @@ void FASTCALL MappedMemoryWriteWord(u32 addr, u16 val)
       case 0x5:
       {
          // Cache/Non-Cached
+         if (UNLIKELY(SH2InParallel) && MappedMemoryNeedsSync(addr))
+         {
+            SH2SyncBegin();
+            WriteWordList[(addr >> 16) & 0xFFF](addr, val);
+            if (UNLIKELY(SH2ThreadCheck))
+               SH2ThreadCheckAccess(addr, val, 2, 1);
+            SH2SyncEnd();
+            return;
+         }
          WriteWordList[(addr >> 16) & 0xFFF](addr, val);
          return;
       }
@@ -785,6 +844,15 @@ void FASTCALL MappedMemoryWriteLong(u32 addr, u32 val)
       case 0x5:
       {
          // Cache/Non-Cached
+         if (UNLIKELY(SH2InParallel) && MappedMemoryNeedsSync(addr))
+         {
+            SH2SyncBegin();
+            WriteLongList[(addr >> 16) & 0xFFF](addr, val);
+            if (UNLIKELY(SH2ThreadCheck))
+               SH2ThreadCheckAccess(addr, val, 4, 1);
+            SH2SyncEnd();
+            return;
+         }
          WriteLongList[(addr >> 16) & 0xFFF](addr, val);
          return;
       }
@@ -19,11 +19,16 @@
 */
 
 // SH2 Shared Code
+#include <stdio.h>
 #include <stdlib.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
 #include "sh2core.h"
 #include "debug.h"
 #include "memory.h"
 #include "yabause.h"
+#include "yui.h"
 
 #if defined(SH2_DYNAREC)
 #include "sh2_dynarec/sh2_dynarec.h"
@@ -31,15 +36,83 @@
 
 SH2_struct *MSH2=NULL;
 SH2_struct *SSH2=NULL;
+#undef CurrentSH2
 SH2_struct *CurrentSH2;
+static SH2_struct **const MainCurrentSH2 = &CurrentSH2;
+#define CurrentSH2 SH2_CURRENT
 SH2Interface_struct *SH2Core=NULL;
 extern SH2Interface_struct *SH2CoreList[];
 
+// Slices are a tenth of a line, so both threads spin a while rather than
+// sleep when waiting on each other
+#define SH2_THREAD_SPIN (1 << 14)
+
+typedef struct
+{
+   pthread_t id;
+   pthread_mutex_t mutex;
+   pthread_cond_t cond;
+   u32 cycles;
+   u32 queued;
+   u32 done[2];  // current slice finished, indexed by isslave
+   u8 idle;
+   u8 quit;
+   u8 running;
+   u8 check;
+} SH2Thread_struct;
+
+static SH2Thread_struct SH2Thread;
+static SH2_struct *SlaveCurrentSH2;
+u8 SH2InParallel = 0;
+
+// The serial check logs each SH2's work RAM accesses during a parallel
+// slice, then replays both logs merged in SH2 cycle order, the order a
+// single thread running them would use, and compares every byte read
+// against what that replay holds at the same point. Bytes the slice didn't
+// write take the value of their first read in that order.
+
+// Slices are at most a line, so far fewer accesses than this
+#define SH2_CHECK_LOG_SIZE 0x1000
+// Room for every byte both full logs can touch at half load
+#define SH2_CHECK_SHADOW_BITS 16
+#define SH2_CHECK_REPORTS 16
+
+typedef struct
+{
+   u32 cycles;
+   u32 addr;
+   u32 val;
+   u8 size;
+   u8 write;
+} SH2CheckAccess_struct;
+
+typedef struct
+{
+   u32 addr;
+   u32 slice;  // entry is empty unless it matches the current slice
+   u8 val;
+} SH2CheckByte_struct;
+
+typedef struct
+{
+   SH2CheckAccess_struct *log[2];  // indexed by isslave
+   u32 count[2];
+   u8 overflow[2];
+   SH2CheckByte_struct *shadow;
+   u32 slice;
+   u32 mismatches;
+   u32 skipped;
+} SH2Check_struct;
+
+static SH2Check_struct SH2Checker;
+u8 SH2ThreadCheck = 0;
+
 void OnchipReset(SH2_struct *context);
 void FRTExec(u32 cycles);
 void WDTExec(u32 cycles);
 u8 SCIReceiveByte(void);
 void SCITransmitByte(u8);
+static void SH2InputCapture(SH2_struct *context);
 
 //////////////////////////////////////////////////////////////////////////////
 
@@ -96,6 +169,8 @@ int SH2Init(int coreid)
 
 void SH2DeInit()
 {
+   SH2StopSlaveThread();
+
    if (SH2Core)
       SH2Core->DeInit();
    SH2Core = NULL;
@@ -184,10 +259,384 @@ void FASTCALL SH2Exec(SH2_struct *context, u32 cycles)
       context->cycles -= cycles;
 }
 
+//////////////////////////////////////////////////////////////////////////////
+// Slave Thread
+//////////////////////////////////////////////////////////////////////////////
+
+// With the slave on its own thread both SH2s run each slice at the same
+// time. Every data access the other CPU could observe, work RAM and device
+// registers alike, is ordered by SH2 time between SH2SyncBegin() and
+// SH2SyncEnd(), so the slice sees memory change in the same order it would
+// if one thread interleaved both CPUs cycle by cycle. Instruction fetches
+// and BIOS ROM reads don't wait. Interrupts and input captures aimed at the
+// other CPU are held until the end of the slice.
+
+SH2_struct **SH2ThreadCurrentSlot(void)
+{
+   if (pthread_equal(pthread_self(), SH2Thread.id))
+      return &SlaveCurrentSH2;
+
+   return MainCurrentSH2;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+static void SH2FlushPending(SH2_struct *context)
+{
+   u32 i;
+
+   if (context->inputCapturePending)
+   {
+      context->inputCapturePending = 0;
+      SH2InputCapture(context);
+   }
+
+   for (i = 0; i < context->NumberOfPendingInterrupts; i++)
+      SH2Core->SendInterrupt(context, context->pendingInterrupts[i].vector,
+                             context->pendingInterrupts[i].level);
+   context->NumberOfPendingInterrupts = 0;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+static void SH2WaitDone(int isslave)
+{
+   int spin;
+
+   for (spin = 0; !__atomic_load_n(&SH2Thread.done[isslave], __ATOMIC_ACQUIRE); spin++)
+   {
+      if (spin >= SH2_THREAD_SPIN)
+         sched_yield();
+   }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+static void *SH2SlaveThread(UNUSED void *arg)
+{
+   u32 done = 0;
+
+   SlaveCurrentSH2 = SSH2;
+
+   for (;;)
+   {
+      int spin;
+
+      for (spin = 0; __atomic_load_n(&SH2Thread.queued, __ATOMIC_ACQUIRE) == done &&
+                     !__atomic_load_n(&SH2Thread.quit, __ATOMIC_ACQUIRE); spin++)
+      {
+         if (spin < SH2_THREAD_SPIN)
+            continue;
+
+         pthread_mutex_lock(&SH2Thread.mutex);
+         __atomic_store_n(&SH2Thread.idle, 1, __ATOMIC_SEQ_CST);
+         while (__atomic_load_n(&SH2Thread.queued, __ATOMIC_SEQ_CST) == done && !SH2Thread.quit)
+            pthread_cond_wait(&SH2Thread.cond, &SH2Thread.mutex);
+         __atomic_store_n(&SH2Thread.idle, 0, __ATOMIC_SEQ_CST);
+         pthread_mutex_unlock(&SH2Thread.mutex);
+      }
+
+      if (__atomic_load_n(&SH2Thread.quit, __ATOMIC_ACQUIRE))
+         break;
+
+      // the master side spins on this thread, keep it at the same priority
+      YuiUpdateThreadScheduling();
+      done++;
+      SH2Exec(SSH2, SH2Thread.cycles);
+      __atomic_store_n(&SH2Thread.done[1], 1, __ATOMIC_RELEASE);
+   }
+
+   return NULL;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+static void SH2ThreadCheckDeInit(void)
+{
+   free(SH2Checker.log[0]);
+   free(SH2Checker.log[1]);
+   free(SH2Checker.shadow);
+   memset(&SH2Checker, 0, sizeof(SH2Checker));
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+static int SH2ThreadCheckInit(void)
+{
+   memset(&SH2Checker, 0, sizeof(SH2Checker));
+   SH2Checker.log[0] = (SH2CheckAccess_struct *)malloc(SH2_CHECK_LOG_SIZE * sizeof(SH2CheckAccess_struct));
+   SH2Checker.log[1] = (SH2CheckAccess_struct *)malloc(SH2_CHECK_LOG_SIZE * sizeof(SH2CheckAccess_struct));
+   SH2Checker.shadow = (SH2CheckByte_struct *)calloc(1 << SH2_CHECK_SHADOW_BITS, sizeof(SH2CheckByte_struct));
+
+   if (SH2Checker.log[0] == NULL || SH2Checker.log[1] == NULL || SH2Checker.shadow == NULL)
+   {
+      SH2ThreadCheckDeInit();
+      return -1;
+   }
+
+   return 0;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+static SH2CheckByte_struct *SH2ThreadCheckShadow(u32 addr)
+{
+   const u32 mask = (1 << SH2_CHECK_SHADOW_BITS) - 1;
+   u32 i = (addr * 2654435761U) >> (32 - SH2_CHECK_SHADOW_BITS);
+
+   while (SH2Checker.shadow[i].slice == SH2Checker.slice &&
+          SH2Checker.shadow[i].addr != addr)
+      i = (i + 1) & mask;
+
+   return &SH2Checker.shadow[i];
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+static void SH2ThreadCheckSlice(void)
+{
+   u32 i[2] = { 0, 0 };
+   u32 *count = SH2Checker.count;
+
+   if (SH2Checker.overflow[0] || SH2Checker.overflow[1])
+   {
+      SH2Checker.skipped++;
+      count[0] = count[1] = 0;
+      SH2Checker.overflow[0] = SH2Checker.overflow[1] = 0;
+      return;
+   }
+
+   // 0 marks unused shadow entries
+   if (++SH2Checker.slice == 0)
+   {
+      memset(SH2Checker.shadow, 0, (1 << SH2_CHECK_SHADOW_BITS) * sizeof(SH2CheckByte_struct));
+      SH2Checker.slice = 1;
+   }
+
+   while (i[0] < count[0] || i[1] < count[1])
+   {
+      // the master goes first on a tie, as in SH2SyncBegin()
+      int isslave = i[0] == count[0] ||
+         (i[1] < count[1] && SH2Checker.log[1][i[1]].cycles < SH2Checker.log[0][i[0]].cycles);
+      SH2CheckAccess_struct *access = &SH2Checker.log[isslave][i[isslave]++];
+      u32 b;
+
+      for (b = 0; b < access->size; b++)
+      {
+         SH2CheckByte_struct *shadow = SH2ThreadCheckShadow(access->addr + b);
+         u8 val = (u8)(access->val >> ((access->size - 1 - b) * 8));
+
+         if (shadow->slice != SH2Checker.slice)
+         {
+            shadow->addr = access->addr + b;
+            shadow->slice = SH2Checker.slice;
+            shadow->val = val;
+         }
+         else if (access->write)
+            shadow->val = val;
+         else if (shadow->val != val)
+         {
+            if (SH2Checker.mismatches < SH2_CHECK_REPORTS)
+            {
+               char msg[128];
+               sprintf(msg, "SH2 thread check: %s read %02X from %08X at cycle %u, serial order has %02X",
+                       isslave ? "slave" : "master", val, (unsigned)(access->addr + b),
+                       (unsigned)access->cycles, shadow->val);
+               YuiErrorMsg(msg);
+            }
+            SH2Checker.mismatches++;
+            // report each diverged byte once
+            shadow->val = val;
+         }
+      }
+   }
+
+   count[0] = count[1] = 0;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+int SH2StartSlaveThread(int check)
+{
+   if (SH2Thread.running)
+      return 0;
+
+   // Both threads spin while waiting on each other, pointless on one core
+   if (sysconf(_SC_NPROCESSORS_ONLN) < 2)
+      return -1;
+
+   if (check && SH2ThreadCheckInit() != 0)
+      return -1;
+
+   SH2Thread.queued = 0;
+   SH2Thread.idle = 0;
+   SH2Thread.quit = 0;
+   SH2Thread.check = check;
+   pthread_mutex_init(&SH2Thread.mutex, NULL);
+   pthread_cond_init(&SH2Thread.cond, NULL);
+
+   if (pthread_create(&SH2Thread.id, NULL, SH2SlaveThread, NULL) != 0)
+   {
+      pthread_cond_destroy(&SH2Thread.cond);
+      pthread_mutex_destroy(&SH2Thread.mutex);
+      SH2ThreadCheckDeInit();
+      return -1;
+   }
+
+   SH2Thread.running = 1;
+   SH2ThreadCheck = check;
+   return 0;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+void SH2StopSlaveThread(void)
+{
+   if (!SH2Thread.running)
+      return;
+
+   pthread_mutex_lock(&SH2Thread.mutex);
+   __atomic_store_n(&SH2Thread.quit, 1, __ATOMIC_RELEASE);
+   pthread_cond_signal(&SH2Thread.cond);
+   pthread_mutex_unlock(&SH2Thread.mutex);
+   pthread_join(SH2Thread.id, NULL);
+
+   pthread_cond_destroy(&SH2Thread.cond);
+   pthread_mutex_destroy(&SH2Thread.mutex);
+   SH2Thread.running = 0;
+
+   if (SH2Thread.check)
+   {
+      char msg[128];
+      sprintf(msg, "SH2 thread check: %u mismatched reads, %u slices too long to check",
+              (unsigned)SH2Checker.mismatches, (unsigned)SH2Checker.skipped);
+      YuiErrorMsg(msg);
+   }
+   SH2ThreadCheck = 0;
+   SH2Thread.check = 0;
+   SH2ThreadCheckDeInit();
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+void SH2ExecParallel(u32 cycles)
+{
+   SH2Thread.done[0] = SH2Thread.done[1] = 0;
+   SH2Thread.cycles = cycles;
+   // what each side orders against until the SH2s publish from this slice
+   MSH2->syncCycles = MSH2->cycles;
+   SSH2->syncCycles = SSH2->cycles;
+   SH2InParallel = 1;
+
+   __atomic_add_fetch(&SH2Thread.queued, 1, __ATOMIC_SEQ_CST);
+   if (__atomic_load_n(&SH2Thread.idle, __ATOMIC_SEQ_CST))
+   {
+      pthread_mutex_lock(&SH2Thread.mutex);
+      pthread_cond_signal(&SH2Thread.cond);
+      pthread_mutex_unlock(&SH2Thread.mutex);
+   }
+
+   SH2Exec(MSH2, cycles);
+   __atomic_store_n(&SH2Thread.done[0], 1, __ATOMIC_RELEASE);
+   SH2WaitDone(1);
+
+   SH2InParallel = 0;
+   if (SH2Thread.check)
+      SH2ThreadCheckSlice();
+   SH2FlushPending(MSH2);
+   SH2FlushPending(SSH2);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+void SH2SyncBegin(void)
+{
+   SH2_struct *self = CurrentSH2;
+   SH2_struct *other;
+   int spin;
+
+   if (self->syncDepth++)
+      return;
+
+   // The interpreter publishes after each instruction, but accesses made
+   // outside its loop can be further along. Without this both SH2s could
+   // wait on each other's stale counts.
+   __atomic_store_n(&self->syncCycles, self->cycles, __ATOMIC_SEQ_CST);
+
+   // Let the other SH2 get past this point in time first, the master going
+   // first on a tie. Its published count only grows during the slice and
+   // is never ahead of its next access, so an old value just means waiting
+   // a little longer.
+   other = self->isslave ? MSH2 : SSH2;
+   for (spin = 0; !__atomic_load_n(&SH2Thread.done[other->isslave], __ATOMIC_ACQUIRE); spin++)
+   {
+      u32 cycles = __atomic_load_n(&other->syncCycles, __ATOMIC_SEQ_CST);
+
+      if (cycles > self->cycles || (cycles == self->cycles && !self->isslave))
+         break;
+
+      if (spin >= SH2_THREAD_SPIN)
+         sched_yield();
+   }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+void SH2SyncEnd(void)
+{
+   // the access is published with the next cycle count or the done flag,
+   // both release stores
+   CurrentSH2->syncDepth--;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+void SH2ThreadCheckAccess(u32 addr, u32 val, int size, int write)
+{
+   SH2_struct *self = CurrentSH2;
+   u32 area = (addr >> 16) & 0xFFF;
+   u32 *count = &SH2Checker.count[self->isslave];
+   SH2CheckAccess_struct *access;
+
+   // only work RAM, device reads aren't a function of earlier writes
+   if (area >= 0x020 && area < 0x030)
+      addr = 0x00200000 | (addr & 0xFFFFF);
+   else if (area >= 0x600 && area < 0x800)
+      addr = 0x06000000 | (addr & 0xFFFFF);
+   else
+      return;
+
+   if (*count == SH2_CHECK_LOG_SIZE)
+   {
+      SH2Checker.overflow[self->isslave] = 1;
+      return;
+   }
+
+   access = &SH2Checker.log[self->isslave][(*count)++];
+   access->cycles = self->cycles;
+   access->addr = addr;
+   access->val = val;
+   access->size = (u8)size;
+   access->write = (u8)write;
+}
+
 //////////////////////////////////////////////////////////////////////////////
 
 void SH2SendInterrupt(SH2_struct *context, u8 vector, u8 level)
 {
+   if (UNLIKELY(SH2InParallel) && context != CurrentSH2)
+   {
+      // The other SH2 is mid-slice on its own thread, it takes this at the
+      // start of its next one
+      if (context->NumberOfPendingInterrupts < MAX_INTERRUPTS)
+      {
+         context->pendingInterrupts[context->NumberOfPendingInterrupts].vector = vector;
+         context->pendingInterrupts[context->NumberOfPendingInterrupts].level = level;
+         context->NumberOfPendingInterrupts++;
+      }
+      return;
+   }
+
    SH2Core->SendInterrupt(context, vector, level);
 }
 
@@ -2010,34 +2459,46 @@ void DMATransfer(u32 *CHCR, u32 *SAR, u32 *DAR, u32 *TCR, u32 *VCRDMA)
 // Input Capture Specific
 //////////////////////////////////////////////////////////////////////////////
 
-void FASTCALL MSH2InputCaptureWriteWord(UNUSED u32 addr, UNUSED u16 data)
+static void SH2InputCapture(SH2_struct *context)
 {
    // Set Input Capture Flag
-   MSH2->onchip.FTCSR |= 0x80;
+   context->onchip.FTCSR |= 0x80;
 
    // Copy FRC register to FICR
-   MSH2->onchip.FICR = MSH2->onchip.FRC.all;
+   context->onchip.FICR = context->onchip.FRC.all;
 
    // Time for an Interrupt?
-   if (MSH2->onchip.TIER & 0x80)
-      SH2SendInterrupt(MSH2, (MSH2->onchip.VCRC >> 8) & 0x7F, (MSH2->onchip.IPRB >> 8) & 0xF);
+   if (context->onchip.TIER & 0x80)
+      SH2SendInterrupt(context, (context->onchip.VCRC >> 8) & 0x7F, (context->onchip.IPRB >> 8) & 0xF);
 }
 
 //////////////////////////////////////////////////////////////////////////////
 
-void FASTCALL SSH2InputCaptureWriteWord(UNUSED u32 addr, UNUSED u16 data)
+static void SH2InputCaptureWrite(SH2_struct *context)
 {
-   // Set Input Capture Flag
-   SSH2->onchip.FTCSR |= 0x80;
+   // Same as for interrupts, don't touch the other SH2 while it's running
+   if (UNLIKELY(SH2InParallel) && context != CurrentSH2)
+      context->inputCapturePending = 1;
+   else
+      SH2InputCapture(context);
+}
 
-   // Copy FRC register to FICR
-   SSH2->onchip.FICR = SSH2->onchip.FRC.all;
+//////////////////////////////////////////////////////////////////////////////
 
-   // Time for an Interrupt?
-   if (SSH2->onchip.TIER & 0x80)
-      SH2SendInterrupt(SSH2, (SSH2->onchip.VCRC >> 8) & 0x7F, (SSH2->onchip.IPRB >> 8) & 0xF);
+void FASTCALL MSH2InputCaptureWriteWord(UNUSED u32 addr, UNUSED u16 data)
+{
+   SH2InputCaptureWrite(MSH2);
 }
 
+//////////////////////////////////////////////////////////////////////////////
+
+void FASTCALL SSH2InputCaptureWriteWord(UNUSED u32 addr, UNUSED u16 data)
+{
+   SH2InputCaptureWrite(SSH2);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
 //////////////////////////////////////////////////////////////////////////////
 // SCI Specific
 //////////////////////////////////////////////////////////////////////////////
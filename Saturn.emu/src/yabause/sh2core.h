@@ -364,6 +364,14 @@ typedef struct
 
    interrupt_struct interrupts[MAX_INTERRUPTS];
    u32 NumberOfInterrupts;
+   // Raised by the other SH2 while both run in parallel, delivered after
+   // the slice
+   interrupt_struct pendingInterrupts[MAX_INTERRUPTS];
+   u32 NumberOfPendingInterrupts;
+   u8 inputCapturePending;
+   u8 syncDepth;
+   // cycles as last published to the other SH2's thread, see SH2SyncBegin()
+   u32 syncCycles;
    u32 AddressArray[0x100];
    u8 DataArray[0x1000];
    u32 delay;
@@ -440,12 +448,27 @@ extern SH2_struct *MSH2;
 extern SH2_struct *SSH2;
 extern SH2_struct *CurrentSH2;
 extern SH2Interface_struct *SH2Core;
+extern u8 SH2InParallel;
+extern u8 SH2ThreadCheck;
+
+SH2_struct **SH2ThreadCurrentSlot(void);
+
+// The dynarec linkage code writes CurrentSH2 directly. While the slave runs
+// on its own thread, C code uses a per-thread current context instead.
+#define SH2_CURRENT (*(UNLIKELY(SH2InParallel) ? SH2ThreadCurrentSlot() : &CurrentSH2))
+#define CurrentSH2 SH2_CURRENT
 
 int SH2Init(int coreid);
 void SH2DeInit(void);
 void SH2Reset(SH2_struct *context);
 void SH2PowerOn(SH2_struct *context);
 void FASTCALL SH2Exec(SH2_struct *context, u32 cycles);
+int SH2StartSlaveThread(int check);
+void SH2StopSlaveThread(void);
+void SH2ExecParallel(u32 cycles);
+void SH2SyncBegin(void);
+void SH2SyncEnd(void);
+void SH2ThreadCheckAccess(u32 addr, u32 val, int size, int write);
 void SH2SendInterrupt(SH2_struct *context, u8 vector, u8 level);
 void SH2NMI(SH2_struct *context);
 void SH2Step(SH2_struct *context);
@@ -32,16 +32,23 @@ done, ending with a conditional jump, at the point of which all registers are
 executed loops */
 
 /* bDet : Bitwise register markers. 1: register is deterministic
-   bChg : Bitwise register markers. 1: register has been changed, not in a deterministic way */
+   bChg : Bitwise register markers. 1: register has been changed, not in a deterministic way
+   Markers are kept per check, both SH2s can be checking loops at once when
+   the slave runs on its own thread */
 
-u32 bDet, bChg;
+typedef struct {
+  u32 bDet, bChg;
+} idleMarkers;
+
+#define bDet (markers->bDet)
+#define bChg (markers->bChg)
 
 /* Macro <implies(dest,src)> : makes changes resulting from the
    execution of an instruction in which the content of <dest> register
    only depends on <src> register(s) (and potentially constant values,
    including memory content which is constant in an idle loop) */
 
-#define delayCheck(PC) SH2idleCheckIterate( fetchlist[((PC) >> 20) & 0x0FF](PC), PC )
+#define delayCheck(PC) SH2idleCheckIterate( markers, fetchlist[((PC) >> 20) & 0x0FF](PC), PC )
 
 #define implies(dest,src) if ( src ) bDet |= dest; else bChg |= dest;
 #define implies2(dest,dest2,src) if ( src ) bDet |= dest|dest2; else bChg |= dest|dest2;
@@ -82,7 +89,7 @@ u32 bDet, bChg;
 #define srcPR (bDet & destPR)
 #define isConst(src) if ( (bDet & destCONST) && !src ) return 0; 
 
-static int FASTCALL SH2idleCheckIterate(u16 instruction, u32 PC) {
+static int FASTCALL SH2idleCheckIterate(idleMarkers *markers, u16 instruction, u32 PC) {
   // update bDet after execution of <instruction>
   // return 0 : cannot continue idle check, probably because of a memory write
 
@@ -464,6 +471,7 @@ void FASTCALL SH2idleCheck(SH2_struct *context, u32 cycles) {
   s32 disp;
   u32 cyclesCheckEnd;
   u32 PC1, PC2, PC3;
+  idleMarkers checkMarkers, *markers = &checkMarkers;
 
   IDLE_VERBOSE_SH2_COUNT;
 
@@ -520,7 +528,7 @@ void FASTCALL SH2idleCheck(SH2_struct *context, u32 cycles) {
     context->instruction = fetchlist[((loopEnd+2) >> 20) & 0x0FF](loopEnd+2);
     opcodes[context->instruction](context);
     context->regs.PC -= 2;
-    if ( !SH2idleCheckIterate(context->instruction,0) ) return;
+    if ( !SH2idleCheckIterate(markers,context->instruction,0) ) return;
   }
   
   // First pass
@@ -529,7 +537,7 @@ void FASTCALL SH2idleCheck(SH2_struct *context, u32 cycles) {
 
     PC1 = context->regs.PC;
     context->instruction = fetchlist[(PC1 >> 20) & 0x0FF](PC1);
-    if ( !SH2idleCheckIterate(context->instruction,PC1) ) return;    
+    if ( !SH2idleCheckIterate(markers,context->instruction,PC1) ) return;    
     opcodes[context->instruction](context);
     if ( context->cycles >= cyclesCheckEnd ) return;
   }
@@ -549,13 +557,13 @@ void FASTCALL SH2idleCheck(SH2_struct *context, u32 cycles) {
   // Second pass
 
   if ( isDelayed )
-    if ( !SH2idleCheckIterate(fetchlist[((loopEnd+2) >> 20) & 0x0FF](loopEnd+2),0) ) return;
+    if ( !SH2idleCheckIterate(markers,fetchlist[((loopEnd+2) >> 20) & 0x0FF](loopEnd+2),0) ) return;
 
   while ( context->regs.PC != loopEnd ) {
     
     PC3 = context->regs.PC;
     context->instruction = fetchlist[(PC3 >> 20) & 0x0FF](PC3);
-    if ( !SH2idleCheckIterate(context->instruction,PC3) ) return;    
+    if ( !SH2idleCheckIterate(markers,context->instruction,PC3) ) return;    
     opcodes[context->instruction](context);
   }
   context->instruction = fetchlist[(PC2 >> 20) & 0x0FF](PC2);
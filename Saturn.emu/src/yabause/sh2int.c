@@ -2226,6 +2226,10 @@ static void FASTCALL SH2tas(SH2_struct * sh)
    s32 temp;
    s32 n = INSTRUCTION_B(sh->instruction);
 
+   // keep the read-modify-write whole against the other SH2's thread
+   if (UNLIKELY(SH2InParallel))
+      SH2SyncBegin();
+
    temp=(s32) MappedMemoryReadByte(sh->regs.R[n]);
 
    if (temp==0)
@@ -2235,6 +2239,9 @@ static void FASTCALL SH2tas(SH2_struct * sh)
 
    temp|=0x00000080;
    MappedMemoryWriteByte(sh->regs.R[n],temp);
+
+   if (UNLIKELY(SH2InParallel))
+      SH2SyncEnd();
    sh->regs.PC+=2;
    sh->cycles += 4;
 }
@@ -2876,6 +2883,19 @@ FASTCALL void SH2InterpreterExec(SH2_struct *context, u32 cycles)
    else
       SH2idleCheck(context, cycles);
 
+   if (UNLIKELY(SH2InParallel))
+   {
+      // the other SH2's thread orders its accesses by this count, keep it
+      // close so it doesn't wait longer than it has to
+      while(context->cycles < cycles)
+      {
+         __atomic_store_n(&context->syncCycles, context->cycles, __ATOMIC_RELEASE);
+         context->instruction = fetchlist[(context->regs.PC >> 20) & 0x0FF](context->regs.PC);
+         opcodes[context->instruction](context);
+      }
+      return;
+   }
+
    while(context->cycles < cycles)
    {
       // Fetch Instruction
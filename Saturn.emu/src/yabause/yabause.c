@@ -36,6 +36,7 @@
 #include "scsp.h"
 #include "scu.h"
 #include "sh2core.h"
+#include "sh2int.h"
 #include "smpc.h"
 #include "vdp2.h"
 #include "yui.h"
@@ -131,16 +132,26 @@ void YabauseChangeTiming(int freqtype) {
 
 int YabauseInit(yabauseinit_struct *init)
 {
+   int sh2coretype = init->sh2coretype;
+
    // Need to set this first, so init routines see it
    yabsys.UseThreads = init->usethreads;
 
+   // The dynarec runs both SH2s from one frame loop and translation cache,
+   // so a slave SH2 thread takes the interpreter for both
+   if (init->usesh2thread)
+      sh2coretype = SH2CORE_INTERPRETER;
+
    // Initialize both cpu's
-   if (SH2Init(init->sh2coretype) != 0)
+   if (SH2Init(sh2coretype) != 0)
    {
       YabSetError(YAB_ERR_CANNOTINIT, _("SH2"));
       return -1;
    }
 
+   yabsys.UseSH2Thread = init->usesh2thread &&
+      SH2StartSlaveThread(init->usesh2thread == SH2THREAD_CHECK) == 0;
+
    if ((BiosRom = T2MemoryInit(0x80000)) == NULL)
       return -1;
 
@@ -406,6 +417,27 @@ int YabauseExec(void) {
 	return 0;
 }
 
+//////////////////////////////////////////////////////////////////////////////
+
+static void YabauseExecSH2(u32 cycles)
+{
+   if (yabsys.IsSSH2Running && yabsys.UseSH2Thread)
+   {
+      PROFILE_START("SH2");
+      SH2ExecParallel(cycles);
+      PROFILE_STOP("SH2");
+      return;
+   }
+
+   PROFILE_START("MSH2");
+   SH2Exec(MSH2, cycles);
+   PROFILE_STOP("MSH2");
+   PROFILE_START("SSH2");
+   if (yabsys.IsSSH2Running)
+      SH2Exec(SSH2, cycles);
+   PROFILE_STOP("SSH2");
+}
+
 //////////////////////////////////////////////////////////////////////////////
 #ifndef USE_SCSP2
 int saved_centicycles;
@@ -462,14 +494,7 @@ int YabauseEmulate(void) {
          sh2cycles = (yabsys.SH2CycleFrac >> (YABSYS_TIMING_BITS + 1)) << 1;
          yabsys.SH2CycleFrac &= ((YABSYS_TIMING_MASK << 1) | 1);
 
-         PROFILE_START("MSH2");
-         SH2Exec(MSH2, sh2cycles);
-         PROFILE_STOP("MSH2");
-
-         PROFILE_START("SSH2");
-         if (yabsys.IsSSH2Running)
-            SH2Exec(SSH2, sh2cycles);
-         PROFILE_STOP("SSH2");
+         YabauseExecSH2(sh2cycles);
 
 #ifdef USE_SCSP2
          PROFILE_START("SCSP");
@@ -498,25 +523,13 @@ int YabauseEmulate(void) {
          sh2cycles = (yabsys.SH2CycleFrac >> (YABSYS_TIMING_BITS + 1)) << 1;
          yabsys.SH2CycleFrac &= ((YABSYS_TIMING_MASK << 1) | 1);
 
-         PROFILE_START("MSH2");
-         SH2Exec(MSH2, sh2cycles - decilinecycles);
-         PROFILE_STOP("MSH2");
-         PROFILE_START("SSH2");
-         if (yabsys.IsSSH2Running)
-            SH2Exec(SSH2, sh2cycles - decilinecycles);
-         PROFILE_STOP("SSH2");
+         YabauseExecSH2(sh2cycles - decilinecycles);
 
          PROFILE_START("hblankin");
          Vdp2HBlankIN();
          PROFILE_STOP("hblankin");
 
-         PROFILE_START("MSH2");
-         SH2Exec(MSH2, decilinecycles);
-         PROFILE_STOP("MSH2");
-         PROFILE_START("SSH2");
-         if (yabsys.IsSSH2Running)
-            SH2Exec(SSH2, decilinecycles);
-         PROFILE_STOP("SSH2");
+         YabauseExecSH2(decilinecycles);
 
 #ifdef USE_SCSP2
          PROFILE_START("SCSP");
@@ -46,8 +46,13 @@ typedef struct
    u32 basetime;   // Initial time in clocksync mode (0 = start w/ system time)
    int usethreads;
    int osdcoretype;
+   int usesh2thread;  // run the slave SH2 on its own thread, with the interpreter, SH2THREAD_*
 } yabauseinit_struct;
 
+#define SH2THREAD_OFF           0
+#define SH2THREAD_ON            1
+#define SH2THREAD_CHECK         2  // on, checking work RAM reads against serial order
+
 #define CLKTYPE_26MHZ           0
 #define CLKTYPE_28MHZ           1
 
@@ -91,6 +96,7 @@ typedef struct
    int IsPal;
    u8 UseThreads;
    u8 IsSSH2Running;
+   u8 UseSH2Thread;
    u64 OneFrameTime;
    u64 tickfreq;
    int emulatebios;
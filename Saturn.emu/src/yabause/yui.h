@@ -36,6 +36,10 @@ void YuiErrorMsg(const char *string);
    up being moved to the Video Core. */
 void YuiSwapBuffers(void);
 
+/* Called by threads the core runs besides the main one before each unit of
+   work, so they follow the port's scheduling for the emulation thread. */
+void YuiUpdateThreadScheduling(void);
+
 //////////////////////////////////////////////////////////////////////////////
 // Helper functions(you can use these in your own port)
 //////////////////////////////////////////////////////////////////////////////
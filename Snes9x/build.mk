@@ -19,7 +19,7 @@ cheats2.cpp clip.cpp controls.cpp cpu.cpp cpuexec.cpp \
 cpuops.cpp dma.cpp dsp.cpp dsp1.cpp dsp2.cpp dsp3.cpp \
 dsp4.cpp fxemu.cpp fxinst.cpp gfx.cpp globals.cpp \
 loadzip.cpp memmap.cpp movie.cpp obc1.cpp ppu.cpp \
-stream.cpp sa1.cpp sa1cpu.cpp sdd1.cpp sdd1emu.cpp \
+renderthread.cpp stream.cpp sa1.cpp sa1cpu.cpp sdd1.cpp sdd1emu.cpp \
 seta.cpp seta010.cpp seta011.cpp seta018.cpp \
 snapshot.cpp spc7110.cpp srtc.cpp tile.cpp apu/apu.cpp \
 apu/bapu/dsp/sdsp.cpp apu/bapu/dsp/SPC_DSP.cpp \
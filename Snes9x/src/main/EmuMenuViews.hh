@@ -85,16 +85,47 @@ public:
 			Settings.BlockInvalidVRAMAccessMaster = item.on;
 		}
 	};
+
+	BoolMenuItem renderThread
+	{
+		"Render Video On Separate Thread",
+		[this](BoolMenuItem &item, View &, Input::Event e)
+		{
+			item.toggle(*this);
+			optionRenderThread = item.on;
+			Settings.RenderThread = item.on;
+		}
+	};
+
+	BoolMenuItem superFXThread
+	{
+		"Run SuperFX On Separate Thread",
+		[this](BoolMenuItem &item, View &, Input::Event e)
+		{
+			item.toggle(*this);
+			optionSuperFXThread = item.on;
+			Settings.SuperFXThread = item.on;
+		}
+	};
 	#endif
 
 public:
 	SystemOptionView(Base::Window &win): OptionView(win) {}
 
+	void loadVideoItems(MenuItem *item[], uint &items)
+	{
+		OptionView::loadVideoItems(item, items);
+		#ifndef SNES9X_VERSION_1_4
+		renderThread.init(optionRenderThread); item[items++] = &renderThread;
+		#endif
+	}
+
 	void loadSystemItems(MenuItem *item[], uint &items)
 	{
 		OptionView::loadSystemItems(item, items);
 		#ifndef SNES9X_VERSION_1_4
 		blockInvalidVRAMAccess.init(optionBlockInvalidVRAMAccess); item[items++] = &blockInvalidVRAMAccess;
+		superFXThread.init(optionSuperFXThread); item[items++] = &superFXThread;
 		#endif
 	}
 
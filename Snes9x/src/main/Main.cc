@@ -61,12 +61,15 @@ enum
 };
 
 enum {
-	CFGKEY_MULTITAP = 276, CFGKEY_BLOCK_INVALID_VRAM_ACCESS = 277
+	CFGKEY_MULTITAP = 276, CFGKEY_BLOCK_INVALID_VRAM_ACCESS = 277,
+	CFGKEY_RENDER_THREAD = 278, CFGKEY_SUPERFX_THREAD = 279
 };
 
 static Byte1Option optionMultitap(CFGKEY_MULTITAP, 0);
 #ifndef SNES9X_VERSION_1_4
 static Byte1Option optionBlockInvalidVRAMAccess(CFGKEY_BLOCK_INVALID_VRAM_ACCESS, 1);
+static Byte1Option optionRenderThread(CFGKEY_RENDER_THREAD, 0);
+static Byte1Option optionSuperFXThread(CFGKEY_SUPERFX_THREAD, 0);
 #endif
 
 #include <emuframework/CommonGui.hh>
@@ -133,6 +136,8 @@ void EmuSystem::onOptionsLoaded()
 {
 	#ifndef SNES9X_VERSION_1_4
 	Settings.BlockInvalidVRAMAccessMaster = optionBlockInvalidVRAMAccess;
+	Settings.RenderThread = optionRenderThread;
+	Settings.SuperFXThread = optionSuperFXThread;
 	#endif
 }
 
@@ -144,6 +149,8 @@ bool EmuSystem::readConfig(IO &io, uint key, uint readSize)
 		bcase CFGKEY_MULTITAP: optionMultitap.readFromIO(io, readSize);
 		#ifndef SNES9X_VERSION_1_4
 		bcase CFGKEY_BLOCK_INVALID_VRAM_ACCESS: optionBlockInvalidVRAMAccess.readFromIO(io, readSize);
+		bcase CFGKEY_RENDER_THREAD: optionRenderThread.readFromIO(io, readSize);
+		bcase CFGKEY_SUPERFX_THREAD: optionSuperFXThread.readFromIO(io, readSize);
 		#endif
 	}
 	return 1;
@@ -154,6 +161,8 @@ void EmuSystem::writeConfig(IO &io)
 	optionMultitap.writeWithKeyIfNotDefault(io);
 	#ifndef SNES9X_VERSION_1_4
 	optionBlockInvalidVRAMAccess.writeWithKeyIfNotDefault(io);
+	optionRenderThread.writeWithKeyIfNotDefault(io);
+	optionSuperFXThread.writeWithKeyIfNotDefault(io);
 	#endif
 }
 
@@ -688,14 +697,11 @@ static void mixSamples(int frames, bool renderAudio)
 {
 	if(likely(frames))
 	{
-		uint samples = frames * 2;
-		int16 audioBuff[samples];
-		S9xMixSamples((uint8_t*)audioBuff, samples);
-		if(renderAudio)
-		{
-			//logMsg("%d frames", frames);
-			EmuSystem::writeSound(audioBuff, frames);
-		}
+		EMU_PROFILE_SCOPE(CORE_SOUND);
+		auto audioBuff = EmuSystem::getSoundBuffer(frames, renderAudio);
+		S9xMixSamples((uint8_t*)audioBuff.data, frames * 2);
+		//logMsg("%d frames", frames);
+		EmuSystem::commitSound(audioBuff, frames);
 	}
 }
 
@@ -739,7 +745,11 @@ void EmuSystem::runFrame(bool renderGfx, bool processGfx, bool renderAudio)
 			mixSamples(samples / 2, renderAudio);
 		}, (void*)renderAudio);
 	#endif
-	S9xMainLoop();
+	{
+		// includes the PPU and sound mixed from the samples callback
+		EMU_PROFILE_SCOPE(CORE_CPU);
+		S9xMainLoop();
+	}
 	// video rendered in S9xDeinitUpdate
 	#ifdef SNES9X_VERSION_1_4
 	mixSamples(audioFramesPerVideoFrame, renderAudio);
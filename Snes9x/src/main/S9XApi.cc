@@ -2,6 +2,7 @@
 #include <imagine/logger/logger.h>
 #include <imagine/fs/FS.hh>
 #include <emuframework/EmuSystem.hh>
+#include <emuframework/EmuApp.hh>
 #include <sys/stat.h>
 #include <snes9x.h>
 #ifndef SNES9X_VERSION_1_4
@@ -20,6 +21,11 @@ void S9xMessage(int, int, const char *msg)
 		logMsg("%s", msg);
 }
 
+void S9xUpdateThreadScheduling()
+{
+	updateEmuWorkerThreadScheduling();
+}
+
 void S9xPrintf(const char* msg, ...)
 {
 	if(!logger_isEnabled())
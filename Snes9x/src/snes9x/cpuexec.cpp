@@ -298,6 +298,10 @@ void S9xMainLoop2 (void)
 			S9xSA1MainLoop();
 	}
 
+	// the frontend may save states or SRAM before the next frame
+	if (Settings.SuperFX)
+		S9xSuperFXSync();
+
 	S9xPackStatus();
 
 	if (CPU.Flags & SCAN_KEYS_FLAG)
@@ -183,6 +183,7 @@
 #include "memmap.h"
 #include "cpuops.h"
 #include "dma.h"
+#include "fxemu.h"
 #include "apu/apu.h"
 #include "display.h"
 #include "debug.h"
@@ -366,6 +367,11 @@ static uint8 S9xDebugGetByte (uint32 Address)
 			byte = *(Memory.BWRAM + ((Address & 0x7fff) - 0x6000));
 			return (byte);
 
+		case CMemory::MAP_SUPERFX_RAM:
+			S9xSuperFXSync();
+			byte = *S9xGetSuperFXRAMPointer(Address);
+			return (byte);
+
 		default:
 			return (byte);
 	}
@@ -176,11 +176,45 @@
  ***********************************************************************************/
 
 
+#include <atomic>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
 #include "snes9x.h"
 #include "memmap.h"
+#include "ppu.h"
+#include "display.h"
 #include "fxinst.h"
 #include "fxemu.h"
 
+// Optional GSU thread. With Settings.SuperFXThread set, the line of GSU
+// instructions run at the end of each scanline while the GSU owns the Game
+// Pak bus (RON and RAN set in SCMR) goes to a second thread, and runs while
+// the CPU emulates the next line. The CPU side waits for it in
+// S9xSuperFXSync before any access to the GSU registers or GSU RAM, which is
+// mapped as MAP_SUPERFX_RAM for this, and before the next line's run.
+// Emulation stays deterministic, but the GSU's IRQ is raised when its line is
+// collected rather than right at the end of the line.
+
+#define FX_THREAD_SPIN	(1 << 14)
+
+struct SFxThread
+{
+	pthread_t			Id;
+	pthread_mutex_t		Mutex;
+	pthread_cond_t		WorkCond;
+	std::atomic<uint32>	Queued;
+	std::atomic<uint32>	Done;
+	std::atomic<bool>	Idle;
+	std::atomic<bool>	Quit;
+	uint32				Instructions;
+	bool8				Running;
+};
+
+static struct SFxThread	Thread;
+
+extern uint8	*HDMAMemPointers[8];
+
 static void FxReset (struct FxInfo_s *);
 static void fx_readRegisterSpace (void);
 static void fx_writeRegisterSpace (void);
@@ -190,15 +224,21 @@ static bool8 fx_checkStartAddress (void);
 static uint32 FxEmulate (uint32);
 static void FxCacheWriteAccess (uint16);
 static void FxFlushCache (void);
+static void fx_checkIRQ (void);
+static bool8 fx_cpuHoldsRamPointer (void);
+static void fx_updateThread (void);
 
 
 void S9xInitSuperFX (void)
 {
+	S9xDeinitSuperFX();
 	memset((uint8 *) &GSU, 0, sizeof(struct FxRegs_s));
 }
 
 void S9xResetSuperFX (void)
 {
+	S9xSuperFXSync();
+
 	// FIXME: Snes9x can't execute CPU and SuperFX at a time. Don't ask me what is 0.417 :P
 	SuperFX.speedPerLine = (uint32) (0.417 * 10.5e6 * ((1.0 / (float) Memory.ROMFramesPerSecond) / ((float) (Timings.V_Max))));
 	SuperFX.speedPerLine2x = (uint32) (0.417 * 10.5e6 * ((1.0 / (float) Memory.ROMFramesPerSecond) / ((float) (Timings.V_Max))))*2;
@@ -210,6 +250,8 @@ void S9xResetSuperFX (void)
 
 void S9xSetSuperFX (uint8 byte, uint16 address)
 {
+	S9xSuperFXSync();
+
 	switch (address)
 	{
 		case 0x3030:
@@ -301,6 +343,8 @@ uint8 S9xGetSuperFX (uint16 address)
 {
 	uint8	byte;
 
+	S9xSuperFXSync();
+
 	byte = Memory.FillRAM[address];
 
 	if (address == 0x3031)
@@ -314,16 +358,160 @@ uint8 S9xGetSuperFX (uint16 address)
 
 void S9xSuperFXExec (void)
 {
+	if (Settings.SuperFXThread != Thread.Running)
+		fx_updateThread();
+
+	S9xSuperFXSync();
+
 	if ((Memory.FillRAM[0x3000 + GSU_SFR] & FLG_G) && (Memory.FillRAM[0x3000 + GSU_SCMR] & 0x18) == 0x18)
 	{
-		FxEmulate((Memory.FillRAM[0x3000 + GSU_CLSR] & 1) ? SuperFX.speedPerLine2x : SuperFX.speedPerLine);
+		uint32	nInstructions = (Memory.FillRAM[0x3000 + GSU_CLSR] & 1) ? SuperFX.speedPerLine2x : SuperFX.speedPerLine;
+
+		if (Thread.Running && !fx_cpuHoldsRamPointer())
+		{
+			Thread.Instructions = nInstructions;
+			SuperFX.threadBusy = TRUE;
+			Thread.Queued.store(Thread.Queued.load(std::memory_order_relaxed) + 1);
+
+			if (Thread.Idle)
+			{
+				pthread_mutex_lock(&Thread.Mutex);
+				pthread_cond_signal(&Thread.WorkCond);
+				pthread_mutex_unlock(&Thread.Mutex);
+			}
+
+			return;
+		}
 
-		uint16 GSUStatus = Memory.FillRAM[0x3000 + GSU_SFR] | (Memory.FillRAM[0x3000 + GSU_SFR + 1] << 8);
-		if ((GSUStatus & (FLG_G | FLG_IRQ)) == FLG_IRQ)
-			CPU.IRQExternal = TRUE;
+		FxEmulate(nInstructions);
+		fx_checkIRQ();
 	}
 }
 
+void S9xSuperFXWait (void)
+{
+	// at most a line of GSU time, not worth giving up the core for at first
+	for (int spin = 0; Thread.Done.load(std::memory_order_acquire) != Thread.Queued.load(std::memory_order_relaxed); spin++)
+	{
+		if (spin >= FX_THREAD_SPIN)
+			sched_yield();
+	}
+
+	SuperFX.threadBusy = FALSE;
+	fx_checkIRQ();
+}
+
+void S9xDeinitSuperFX (void)
+{
+	if (!Thread.Running)
+		return;
+
+	S9xSuperFXSync();
+
+	pthread_mutex_lock(&Thread.Mutex);
+	Thread.Quit = true;
+	pthread_cond_signal(&Thread.WorkCond);
+	pthread_mutex_unlock(&Thread.Mutex);
+	pthread_join(Thread.Id, NULL);
+
+	pthread_cond_destroy(&Thread.WorkCond);
+	pthread_mutex_destroy(&Thread.Mutex);
+	Thread.Running = FALSE;
+}
+
+static void fx_checkIRQ (void)
+{
+	uint16 GSUStatus = Memory.FillRAM[0x3000 + GSU_SFR] | (Memory.FillRAM[0x3000 + GSU_SFR + 1] << 8);
+	if ((GSUStatus & (FLG_G | FLG_IRQ)) == FLG_IRQ)
+		CPU.IRQExternal = TRUE;
+}
+
+static bool8 fx_isRamPointer (const uint8 *p)
+{
+	return (p >= SuperFX.pvRam && p < SuperFX.pvRam + SuperFX.nRamBanks * 0x10000);
+}
+
+// Checks whether the CPU holds a direct pointer into GSU RAM: code running
+// from there (PCBase), a DMA in progress, or an active HDMA table there.
+// Such pointers were taken before the threaded run remapped GSU RAM to
+// MAP_SUPERFX_RAM, so accesses through them skip the memory map and its
+// sync with the worker. The line is run inline instead while one is held.
+static bool8 fx_cpuHoldsRamPointer (void)
+{
+	if (CPU.InDMAorHDMA || (CPU.PCBase && fx_isRamPointer(CPU.PCBase + Registers.PCw)))
+		return (TRUE);
+
+	for (int d = 0; d < 8; d++)
+	{
+		if ((PPU.HDMA & (1 << d)) && fx_isRamPointer(HDMAMemPointers[d]))
+			return (TRUE);
+	}
+
+	return (FALSE);
+}
+
+static void *FxThreadFunc (void *)
+{
+	uint32	done = 0;
+
+	for (;;)
+	{
+		// the next line usually comes quickly, sleep only after a while
+		for (int spin = 0; Thread.Queued.load(std::memory_order_acquire) == done && !Thread.Quit; spin++)
+		{
+			if (spin < FX_THREAD_SPIN)
+				continue;
+
+			pthread_mutex_lock(&Thread.Mutex);
+			Thread.Idle = true;
+			while (Thread.Queued.load() == done && !Thread.Quit)
+				pthread_cond_wait(&Thread.WorkCond, &Thread.Mutex);
+			Thread.Idle = false;
+			pthread_mutex_unlock(&Thread.Mutex);
+		}
+
+		if (Thread.Quit)
+			break;
+
+		// the CPU side spins on this one, so it must not run below it
+		S9xUpdateThreadScheduling();
+		FxEmulate(Thread.Instructions);
+		Thread.Done.store(++done, std::memory_order_release);
+	}
+
+	return (NULL);
+}
+
+static void fx_updateThread (void)
+{
+	if (Thread.Running)
+		S9xDeinitSuperFX();
+	else
+	{
+		Thread.Queued = Thread.Done = 0;
+		Thread.Idle = false;
+		Thread.Quit = false;
+		pthread_mutex_init(&Thread.Mutex, NULL);
+		pthread_cond_init(&Thread.WorkCond, NULL);
+
+		// both sides spin while waiting for each other, a single core would
+		// spend most of its time doing that
+		if (sysconf(_SC_NPROCESSORS_ONLN) < 2 || pthread_create(&Thread.Id, NULL, FxThreadFunc, NULL))
+		{
+			pthread_cond_destroy(&Thread.WorkCond);
+			pthread_mutex_destroy(&Thread.Mutex);
+			S9xMessage(S9X_ERROR, S9X_DEBUG_OUTPUT, "Couldn't start SuperFX thread");
+			Settings.SuperFXThread = FALSE;
+			return;
+		}
+
+		Thread.Running = TRUE;
+	}
+
+	Memory.map_SuperFXRAM(Thread.Running);
+	Memory.map_WriteProtectROM();
+}
+
 static void FxReset (struct FxInfo_s *psFxInfo)
 {
 	// Clear all internal variables
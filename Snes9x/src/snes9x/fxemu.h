@@ -194,17 +194,36 @@ struct FxInfo_s
 	uint32	speedPerLine;
 	uint32	speedPerLine2x;
 	bool8	oneLineDone;
+	bool8	threadBusy;		// GSU thread is running a line, see S9xSuperFXSync
 };
 
 extern struct FxInfo_s	SuperFX;
 
 void S9xInitSuperFX (void);
+void S9xDeinitSuperFX (void);
 void S9xResetSuperFX (void);
 void S9xSuperFXExec (void);
+void S9xSuperFXWait (void);
 void S9xSetSuperFX (uint8, uint16);
 uint8 S9xGetSuperFX (uint16);
 void fx_flushCache (void);
 void fx_computeScreenPointers (void);
 uint32 fx_run (uint32);
 
+// Wait for the GSU thread before touching anything the GSU owns
+static inline void S9xSuperFXSync (void)
+{
+	if (SuperFX.threadBusy)
+		S9xSuperFXWait();
+}
+
+// GSU RAM as mapped by CMemory::map_SuperFXRAM, banks 70-71 and 6000-7fff
+static inline uint8 * S9xGetSuperFXRAMPointer (uint32 Address)
+{
+	if (Address & 0x400000)
+		return (SuperFX.pvRam + (Address & 0x1ffff));
+
+	return (SuperFX.pvRam + (Address & 0x1fff));
+}
+
 #endif
@@ -187,6 +187,7 @@
 #include "obc1.h"
 #include "seta.h"
 #include "bsx.h"
+#include "fxemu.h"
 
 static inline void addCyclesInMemoryAccess(int32 speed)
 {
@@ -328,6 +329,12 @@ inline uint8 S9xGetByte (uint32 Address)
 			addCyclesInMemoryAccess(speed);
 			return (byte);
 
+		case CMemory::MAP_SUPERFX_RAM:
+			S9xSuperFXSync();
+			byte = *S9xGetSuperFXRAMPointer(Address);
+			addCyclesInMemoryAccess(speed);
+			return (byte);
+
 		case CMemory::MAP_NONE:
 		default:
 			byte = OpenBus;
@@ -487,6 +494,12 @@ inline uint16 S9xGetWord (uint32 Address, enum s9xwrap_t w = WRAP_NONE)
 			addCyclesInMemoryAccess(speed);
 			return (word);
 
+		case CMemory::MAP_SUPERFX_RAM:
+			S9xSuperFXSync();
+			word = READ_WORD(S9xGetSuperFXRAMPointer(Address));
+			addCyclesInMemoryAccess_x2(speed);
+			return (word);
+
 		case CMemory::MAP_NONE:
 		default:
 			word = OpenBus | (OpenBus << 8);
@@ -594,6 +607,12 @@ inline void S9xSetByte (uint8 Byte, uint32 Address)
 			addCyclesInMemoryAccess(speed);
 			return;
 
+		case CMemory::MAP_SUPERFX_RAM:
+			S9xSuperFXSync();
+			*S9xGetSuperFXRAMPointer(Address) = Byte;
+			addCyclesInMemoryAccess(speed);
+			return;
+
 		case CMemory::MAP_NONE:
 		default:
 			addCyclesInMemoryAccess(speed);
@@ -865,6 +884,12 @@ inline void S9xSetWord (uint16 Word, uint32 Address, enum s9xwrap_t w = WRAP_NON
 				return;
 			}
 
+		case CMemory::MAP_SUPERFX_RAM:
+			S9xSuperFXSync();
+			WRITE_WORD(S9xGetSuperFXRAMPointer(Address), Word);
+			addCyclesInMemoryAccess_x2(speed);
+			return;
+
 		case CMemory::MAP_NONE:
 		default:
 			addCyclesInMemoryAccess_x2(speed);
@@ -936,6 +961,11 @@ inline void S9xSetPCBase (uint32 Address)
 			CPU.PCBase = S9xGetBasePointerBSX(Address);
 			return;
 
+		case CMemory::MAP_SUPERFX_RAM:
+			S9xSuperFXSync();
+			CPU.PCBase = S9xGetSuperFXRAMPointer(Address) - (Address & 0xffff);
+			return;
+
 		case CMemory::MAP_NONE:
 		default:
 			CPU.PCBase = NULL;
@@ -982,6 +1012,10 @@ inline uint8 * S9xGetBasePointer (uint32 Address)
 		case CMemory::MAP_OBC_RAM:
 			return (S9xGetBasePointerOBC1(Address & 0xffff));
 
+		case CMemory::MAP_SUPERFX_RAM:
+			S9xSuperFXSync();
+			return (S9xGetSuperFXRAMPointer(Address) - (Address & 0xffff));
+
 		case CMemory::MAP_NONE:
 		default:
 			return (NULL);
@@ -1027,6 +1061,10 @@ inline uint8 * S9xGetMemPointer (uint32 Address)
 		case CMemory::MAP_OBC_RAM:
 			return (S9xGetMemPointerOBC1(Address & 0xffff));
 
+		case CMemory::MAP_SUPERFX_RAM:
+			S9xSuperFXSync();
+			return (S9xGetSuperFXRAMPointer(Address));
+
 		case CMemory::MAP_NONE:
 		default:
 			return (NULL);
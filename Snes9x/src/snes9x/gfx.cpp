@@ -206,6 +206,8 @@ static void DrawBackgroundOffsetMosaic (int, uint8, uint8, int);
 static inline void DrawBackgroundMode7 (int, void (*DrawMath) (uint32, uint32, int), void (*DrawNomath) (uint32, uint32, int), int);
 static inline void DrawBackdrop (void);
 static inline void RenderScreen (bool8);
+static void UpdateScreen (void);
+static void DrawScreen (uint32, uint32, bool8);
 static uint16 get_crosshair_color (uint8);
 
 #define TILE_PLUS(t, x)	(((t) & 0xfc00) | ((t + x) & 0x3ff))
@@ -306,6 +308,8 @@ bool8 S9xGraphicsInit (void)
 
 void S9xGraphicsDeinit (void)
 {
+	S9xRenderThreadDeinit();
+
 	//if (GFX.X2)         { free(GFX.X2);         GFX.X2         = NULL; }
 	//if (GFX.ZERO)       { free(GFX.ZERO);       GFX.ZERO       = NULL; }
 	//if (GFX.SubScreen)  { free(GFX.SubScreen);  GFX.SubScreen  = NULL; }
@@ -385,8 +389,12 @@ void S9xStartScreenRefresh (void)
 		PPU.RecomputeClipWindows = TRUE;
 		IPPU.PreviousLine = IPPU.CurrentLine = 0;
 
-		memset(GFX.ZBuffer, 0, GFX.ScreenSize);
-		memset(GFX.SubZBuffer, 0, GFX.ScreenSize);
+		// the render thread clears its own depth buffers
+		if (!S9xRenderThreadStartFrame())
+		{
+			memset(GFX.ZBuffer, 0, GFX.ScreenSize);
+			memset(GFX.SubZBuffer, 0, GFX.ScreenSize);
+		}
 	}
 
 	if (++IPPU.FrameCount % Memory.ROMFramesPerSecond == 0)
@@ -407,6 +415,7 @@ void S9xEndScreenRefresh (void)
 	if (IPPU.RenderThisFrame)
 	{
 		FLUSH_REDRAW();
+		S9xRenderThreadSync();
 
 		if (GFX.DoInterlace && GFX.InterlaceFrame == 0)
 		{
@@ -504,6 +513,16 @@ void RenderLine (uint8 C)
 		}
 
 		IPPU.CurrentLine = C + 1;
+
+		if (IPPU.CurrentLine - IPPU.PreviousLine >= RENDER_THREAD_LINES && S9xRenderThreadCanSplit())
+		{
+			// Hand the lines so far to the render thread so it can work while
+			// the rest of the frame is emulated. The range-over flags are only
+			// sampled at real flushes, so keep the EndY they read from.
+			uint32	EndY = GFX.EndY;
+			UpdateScreen();
+			GFX.EndY = EndY;
+		}
 	}
 	else
 	{
@@ -651,6 +670,14 @@ void S9xUpdateScreen (void)
 	// XXX: Check ForceBlank? Or anything else?
 	PPU.RangeTimeOver |= GFX.OBJLines[GFX.EndY].RTOFlags;
 
+	UpdateScreen();
+}
+
+static void UpdateScreen (void)
+{
+	uint32	widenSrcPPL = 0, widenDstPPL = 0;
+	bool8	doubleHeight = FALSE;
+
 	GFX.StartY = IPPU.PreviousLine;
 	if ((GFX.EndY = IPPU.CurrentLine - 1) >= PPU.ScreenHeight)
 		GFX.EndY = PPU.ScreenHeight - 1;
@@ -670,6 +697,9 @@ void S9xUpdateScreen (void)
 		{
 			if (!IPPU.DoubleWidthPixels && (PPU.BGMode == 5 || PPU.BGMode == 6 || IPPU.PseudoHires))
 			{
+				// Have to back out of the regular speed hack
+				widenSrcPPL = widenDstPPL = GFX.PPL;
+
 			#ifdef USE_OPENGL
 				if (Settings.OpenGLEnable && GFX.RealPPL == 256)
 				{
@@ -677,31 +707,10 @@ void S9xUpdateScreen (void)
 					// SNES image was rendered into a 256x239 sized buffer,
 					// ignoring the true, larger size of the buffer.
 					GFX.RealPPL = GFX.Pitch >> 1;
-
-					for (register int32 y = (int32) GFX.StartY - 1; y >= 0; y--)
-					{
-						register uint16	*p = GFX.Screen + y * GFX.PPL     + 255;
-						register uint16	*q = GFX.Screen + y * GFX.RealPPL + 510;
-
-						for (register int x = 255; x >= 0; x--, p--, q -= 2)
-							*q = *(q + 1) = *p;
-					}
-
+					widenDstPPL = GFX.RealPPL;
 					GFX.PPL = GFX.RealPPL; // = GFX.Pitch >> 1 above
 				}
-				else
 			#endif
-				{
-					// Have to back out of the regular speed hack
-					for (register uint32 y = 0; y < GFX.StartY; y++)
-					{
-						register uint16	*p = GFX.Screen + y * GFX.PPL + 255;
-						register uint16	*q = GFX.Screen + y * GFX.PPL + 510;
-
-						for (register int x = 255; x >= 0; x--, p--, q -= 2)
-							*q = *(q + 1) = *p;
-					}
-				}
 
 				IPPU.DoubleWidthPixels = TRUE;
 				IPPU.RenderedScreenWidth = 512;
@@ -713,14 +722,45 @@ void S9xUpdateScreen (void)
 				IPPU.RenderedScreenHeight = PPU.ScreenHeight << 1;
 				GFX.PPL = GFX.RealPPL << 1;
 				GFX.DoInterlace = 2;
-
-				for (register int32 y = (int32) GFX.StartY - 1; y >= 0; y--)
-					memmove(GFX.Screen + y * GFX.PPL, GFX.Screen + y * GFX.RealPPL, IPPU.RenderedScreenWidth * sizeof(uint16));
+				doubleHeight = TRUE;
 			}
 		}
 
 		if ((Memory.FillRAM[0x2130] & 0x30) != 0x30 && (Memory.FillRAM[0x2131] & 0x3f))
 			GFX.FixedColour = BUILD_PIXEL(IPPU.XB[PPU.FixedColourRed], IPPU.XB[PPU.FixedColourGreen], IPPU.XB[PPU.FixedColourBlue]);
+	}
+
+	if (S9xRenderThreadActive())
+		S9xRenderThreadQueue(widenSrcPPL, widenDstPPL, doubleHeight);
+	else
+		DrawScreen(widenSrcPPL, widenDstPPL, doubleHeight);
+
+	IPPU.PreviousLine = IPPU.CurrentLine;
+}
+
+// Pixel work for the range set up by UpdateScreen, including moving the
+// lines already drawn this frame when the screen switched to hires
+static void DrawScreen (uint32 widenSrcPPL, uint32 widenDstPPL, bool8 doubleHeight)
+{
+	if (!PPU.ForcedBlanking)
+	{
+		if (widenSrcPPL)
+		{
+			for (register int32 y = (int32) GFX.StartY - 1; y >= 0; y--)
+			{
+				register uint16	*p = GFX.Screen + y * widenSrcPPL + 255;
+				register uint16	*q = GFX.Screen + y * widenDstPPL + 510;
+
+				for (register int x = 255; x >= 0; x--, p--, q -= 2)
+					*q = *(q + 1) = *p;
+			}
+		}
+
+		if (doubleHeight)
+		{
+			for (register int32 y = (int32) GFX.StartY - 1; y >= 0; y--)
+				memmove(GFX.Screen + y * GFX.PPL, GFX.Screen + y * GFX.RealPPL, IPPU.RenderedScreenWidth * sizeof(uint16));
+		}
 
 		if (PPU.BGMode == 5 || PPU.BGMode == 6 || IPPU.PseudoHires ||
 			((Memory.FillRAM[0x2130] & 0x30) != 0x30 && (Memory.FillRAM[0x2130] & 2) && (Memory.FillRAM[0x2131] & 0x3f) && (Memory.FillRAM[0x212d] & 0x1f)))
@@ -742,8 +782,6 @@ void S9xUpdateScreen (void)
 			for (int x = 0; x < IPPU.RenderedScreenWidth; x++)
 				GFX.S[x] = black;
 	}
-
-	IPPU.PreviousLine = IPPU.CurrentLine;
 }
 
 static void SetupOBJ (void)
@@ -354,6 +354,16 @@ void S9xDisplayMessages (uint16 *, int, int, int, int);
 bool8 S9xSetRenderPixelFormat (int);
 #endif
 
+// optional render thread, see renderthread.cpp
+// lines emulated before a range is handed to the thread without a flush
+#define RENDER_THREAD_LINES	16
+bool8 S9xRenderThreadActive (void);
+bool8 S9xRenderThreadCanSplit (void);
+bool8 S9xRenderThreadStartFrame (void);
+void S9xRenderThreadQueue (uint32, uint32, bool8);
+void S9xRenderThreadSync (void);
+void S9xRenderThreadDeinit (void);
+
 // external port interface which must be implemented or initialised for each port
 bool8 S9xGraphicsInit (void);
 void S9xGraphicsDeinit (void);
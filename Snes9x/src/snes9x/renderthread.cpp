@@ -0,0 +1,662 @@
+/***********************************************************************************
+  Snes9x - Portable Super Nintendo Entertainment System (TM) emulator.
+
+  (c) Copyright 1996 - 2002  Gary Henderson (gary.henderson@ntlworld.com),
+                             Jerremy Koot (jkoot@snes9x.com)
+
+  (c) Copyright 2002 - 2004  Matthew Kendora
+
+  (c) Copyright 2002 - 2005  Peter Bortas (peter@bortas.org)
+
+  (c) Copyright 2004 - 2005  Joel Yliluoma (http://iki.fi/bisqwit/)
+
+  (c) Copyright 2001 - 2006  John Weidman (jweidman@slip.net)
+
+  (c) Copyright 2002 - 2006  funkyass (funkyass@spam.shaw.ca),
+                             Kris Bleakley (codeviolation@hotmail.com)
+
+  (c) Copyright 2002 - 2010  Brad Jorsch (anomie@users.sourceforge.net),
+                             Nach (n-a-c-h@users.sourceforge.net),
+
+  (c) Copyright 2002 - 2011  zones (kasumitokoduck@yahoo.com)
+
+  (c) Copyright 2006 - 2007  nitsuja
+
+  (c) Copyright 2009 - 2011  BearOso,
+                             OV2
+
+
+  BS-X C emulator code
+  (c) Copyright 2005 - 2006  Dreamer Nom,
+                             zones
+
+  C4 x86 assembler and some C emulation code
+  (c) Copyright 2000 - 2003  _Demo_ (_demo_@zsnes.com),
+                             Nach,
+                             zsKnight (zsknight@zsnes.com)
+
+  C4 C++ code
+  (c) Copyright 2003 - 2006  Brad Jorsch,
+                             Nach
+
+  DSP-1 emulator code
+  (c) Copyright 1998 - 2006  _Demo_,
+                             Andreas Naive (andreasnaive@gmail.com),
+                             Gary Henderson,
+                             Ivar (ivar@snes9x.com),
+                             John Weidman,
+                             Kris Bleakley,
+                             Matthew Kendora,
+                             Nach,
+                             neviksti (neviksti@hotmail.com)
+
+  DSP-2 emulator code
+  (c) Copyright 2003         John Weidman,
+                             Kris Bleakley,
+                             Lord Nightmare (lord_nightmare@users.sourceforge.net),
+                             Matthew Kendora,
+                             neviksti
+
+  DSP-3 emulator code
+  (c) Copyright 2003 - 2006  John Weidman,
+                             Kris Bleakley,
+                             Lancer,
+                             z80 gaiden
+
+  DSP-4 emulator code
+  (c) Copyright 2004 - 2006  Dreamer Nom,
+                             John Weidman,
+                             Kris Bleakley,
+                             Nach,
+                             z80 gaiden
+
+  OBC1 emulator code
+  (c) Copyright 2001 - 2004  zsKnight,
+                             pagefault (pagefault@zsnes.com),
+                             Kris Bleakley
+                             Ported from x86 assembler to C by sanmaiwashi
+
+  SPC7110 and RTC C++ emulator code used in 1.39-1.51
+  (c) Copyright 2002         Matthew Kendora with research by
+                             zsKnight,
+                             John Weidman,
+                             Dark Force
+
+  SPC7110 and RTC C++ emulator code used in 1.52+
+  (c) Copyright 2009         byuu,
+                             neviksti
+
+  S-DD1 C emulator code
+  (c) Copyright 2003         Brad Jorsch with research by
+                             Andreas Naive,
+                             John Weidman
+
+  S-RTC C emulator code
+  (c) Copyright 2001 - 2006  byuu,
+                             John Weidman
+
+  ST010 C++ emulator code
+  (c) Copyright 2003         Feather,
+                             John Weidman,
+                             Kris Bleakley,
+                             Matthew Kendora
+
+  Super FX x86 assembler emulator code
+  (c) Copyright 1998 - 2003  _Demo_,
+                             pagefault,
+                             zsKnight
+
+  Super FX C emulator code
+  (c) Copyright 1997 - 1999  Ivar,
+                             Gary Henderson,
+                             John Weidman
+
+  Sound emulator code used in 1.5-1.51
+  (c) Copyright 1998 - 2003  Brad Martin
+  (c) Copyright 1998 - 2006  Charles Bilyue'
+
+  Sound emulator code used in 1.52+
+  (c) Copyright 2004 - 2007  Shay Green (gblargg@gmail.com)
+
+  SH assembler code partly based on x86 assembler code
+  (c) Copyright 2002 - 2004  Marcus Comstedt (marcus@mc.pp.se)
+
+  2xSaI filter
+  (c) Copyright 1999 - 2001  Derek Liauw Kie Fa
+
+  HQ2x, HQ3x, HQ4x filters
+  (c) Copyright 2003         Maxim Stepin (maxim@hiend3d.com)
+
+  NTSC filter
+  (c) Copyright 2006 - 2007  Shay Green
+
+  GTK+ GUI code
+  (c) Copyright 2004 - 2011  BearOso
+
+  Win32 GUI code
+  (c) Copyright 2003 - 2006  blip,
+                             funkyass,
+                             Matthew Kendora,
+                             Nach,
+                             nitsuja
+  (c) Copyright 2009 - 2011  OV2
+
+  Mac OS GUI code
+  (c) Copyright 1998 - 2001  John Stiles
+  (c) Copyright 2001 - 2011  zones
+
+
+  Specific ports contains the works of other authors. See headers in
+  individual files.
+
+
+  Snes9x homepage: http://www.snes9x.com/
+
+  Permission to use, copy, modify and/or distribute Snes9x in both binary
+  and source form, for non-commercial purposes, is hereby granted without
+  fee, providing that this license information and copyright notice appear
+  with all copies and any derived work.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event shall the authors be held liable for any damages
+  arising from the use of this software or it's derivatives.
+
+  Snes9x is freeware for PERSONAL USE only. Commercial users should
+  seek permission of the copyright holders first. Commercial use includes,
+  but is not limited to, charging money for Snes9x or software derived from
+  Snes9x, including Snes9x or derivatives in commercial game bundles, and/or
+  using Snes9x as a promotion for your commercial product.
+
+  The copyright holders request that bug fixes and improvements to the code
+  should be forwarded to them so everyone can benefit from the modifications
+  in future versions.
+
+  Super NES and Super Nintendo Entertainment System are trademarks of
+  Nintendo Co., Limited and its subsidiary companies.
+ ***********************************************************************************/
+
+
+// Optional render thread. With Settings.RenderThread set, every range that
+// S9xUpdateScreen would draw is instead queued along with a snapshot of the
+// PPU state it depends on, and drawn by a second copy of the renderer that
+// is bound to the thread's own PPU, IPPU, GFX and VRAM. The CPU, SPC700 and
+// DSP keep emulating in the meantime and S9xEndScreenRefresh waits for the
+// queue to drain before the frame is used, so the output is the same as
+// drawing on the emulation thread.
+
+#include <pthread.h>
+#include "snes9x.h"
+#include "memmap.h"
+#include "ppu.h"
+#include "tile.h"
+#include "controls.h"
+#include "crosshairs.h"
+#include "cheats.h"
+#include "movie.h"
+#include "screenshot.h"
+#include "display.h"
+
+#define RENDER_JOBS			16
+#define VRAM_BLOCKS			(0x10000 / 64)
+#define VRAM_RING_BLOCKS	(VRAM_BLOCKS * 2)
+
+struct SRenderBlock
+{
+	uint16	Block;		// 64 byte block of VRAM
+	uint32	Invalid;	// tile cache flags to clear, see CacheFlags
+	uint8	Data[64];
+};
+
+struct SRenderJob
+{
+	struct SPPU			PPUState;
+	struct InternalPPU	IPPUState;
+	uint8	Regs[0x40];	// $2100-$213f
+	uint16	*Screen;
+	uint32	PPL;
+	uint32	RealPPL;
+	uint32	StartY;
+	uint32	EndY;
+	uint32	Lines;		// lines of line data from StartY
+	uint32	FixedColour;
+	uint8	DoInterlace;
+	uint8	InterlaceFrame;
+	bool8	ClearZBuffers;
+	bool8	DoubleHeight;
+	uint32	WidenSrcPPL;
+	uint32	WidenDstPPL;
+	uint32	VRAMStart;	// position of the changed VRAM blocks in the ring
+	uint32	VRAMCount;
+	uint8	OBJWidths[128];
+	uint8	OBJVisibleTiles[128];
+	struct SLineData		LineData[240];
+	struct SLineMatrixData	LineMatrixData[240];
+	decltype(SGFX::OBJLines)	OBJLines;
+};
+
+struct SRenderThread
+{
+	pthread_t		Id;
+	pthread_mutex_t	Mutex;
+	pthread_cond_t	WorkCond;
+	pthread_cond_t	DoneCond;
+	bool8			Running;
+	bool8			Quit;
+	bool8			ClearZBuffers;
+	uint32			Queued;
+	uint32			Done;
+	uint32			VRAMQueued;
+	uint32			VRAMDone;
+	struct SRenderJob	*Jobs;
+	struct SRenderBlock	*VRAMBlocks;
+};
+
+static const uint32	TileCacheSize[7] =
+{
+	MAX_2BIT_TILES, MAX_4BIT_TILES, MAX_8BIT_TILES,
+	MAX_2BIT_TILES, MAX_2BIT_TILES, MAX_4BIT_TILES, MAX_4BIT_TILES
+};
+
+// The tile cache flags a VRAM write in a 64 byte block can clear besides its
+// 8bpp one (see REGISTER_2118), as index shift and range around the block.
+// They are passed on exactly rather than per block, the cached hi-res tiles
+// also depend on the tile number they were first drawn with.
+static const struct
+{
+	uint8	Cache;
+	uint8	Shift;
+	uint8	Before;
+	uint8	Count;
+}	CacheFlags[6] =
+{
+	{ TILE_2BIT,      2, 0, 4 },
+	{ TILE_4BIT,      1, 0, 2 },
+	{ TILE_2BIT_EVEN, 2, 1, 5 },
+	{ TILE_2BIT_ODD,  2, 1, 5 },
+	{ TILE_4BIT_EVEN, 1, 1, 3 },
+	{ TILE_4BIT_ODD,  1, 1, 3 }
+};
+
+static struct SRenderThread	Thread;
+
+// state of the thread's copy of the renderer
+static struct SPPU			ThreadPPU;
+static struct InternalPPU	ThreadIPPU;
+static struct SGFX			ThreadGFX;
+static uint16				ThreadDirectColourMaps[8][256];
+static uint8				ThreadFillRAM[0x2140];
+
+static struct
+{
+	uint8	*VRAM;
+	uint8	*FillRAM;
+	int32	ROMFramesPerSecond;
+}	ThreadMemory;
+
+static void ThreadInitTileRenderer (void);
+static void *RenderThreadFunc (void *);
+
+static void FreeThread (void)
+{
+	free(Thread.Jobs);
+	free(Thread.VRAMBlocks);
+	free(ThreadMemory.VRAM);
+	Thread.Jobs = NULL;
+	Thread.VRAMBlocks = NULL;
+	ThreadMemory.VRAM = NULL;
+
+	for (int t = 0; t < 7; t++)
+	{
+		free(ThreadIPPU.TileCache[t]);
+		free(ThreadIPPU.TileCached[t]);
+		ThreadIPPU.TileCache[t] = NULL;
+		ThreadIPPU.TileCached[t] = NULL;
+	}
+}
+
+static bool8 StartThread (void)
+{
+	Thread.Jobs = (struct SRenderJob *) calloc(RENDER_JOBS, sizeof(struct SRenderJob));
+	Thread.VRAMBlocks = (struct SRenderBlock *) malloc(VRAM_RING_BLOCKS * sizeof(struct SRenderBlock));
+	ThreadMemory.VRAM = (uint8 *) calloc(1, 0x10000);
+	ThreadMemory.FillRAM = ThreadFillRAM;
+
+	bool8	ok = Thread.Jobs && Thread.VRAMBlocks && ThreadMemory.VRAM;
+
+	for (int t = 0; t < 7; t++)
+	{
+		ThreadIPPU.TileCache[t]  = (uint8 *) malloc(TileCacheSize[t] * 64);
+		ThreadIPPU.TileCached[t] = (uint8 *) calloc(TileCacheSize[t], 1);
+		ok = ok && ThreadIPPU.TileCache[t] && ThreadIPPU.TileCached[t];
+	}
+
+	if (!ok)
+	{
+		FreeThread();
+		return (FALSE);
+	}
+
+	memcpy(ThreadGFX.X2, GFX.X2, sizeof(GFX.X2));
+	memcpy(ThreadGFX.ZERO, GFX.ZERO, sizeof(GFX.ZERO));
+	ThreadInitTileRenderer();
+	ThreadIPPU.DirectColourMapsNeedRebuild = TRUE;
+
+	Thread.Queued = Thread.Done = 0;
+	Thread.VRAMQueued = Thread.VRAMDone = 0;
+	Thread.Quit = FALSE;
+	pthread_mutex_init(&Thread.Mutex, NULL);
+	pthread_cond_init(&Thread.WorkCond, NULL);
+	pthread_cond_init(&Thread.DoneCond, NULL);
+
+	if (pthread_create(&Thread.Id, NULL, RenderThreadFunc, NULL))
+	{
+		pthread_cond_destroy(&Thread.DoneCond);
+		pthread_cond_destroy(&Thread.WorkCond);
+		pthread_mutex_destroy(&Thread.Mutex);
+		FreeThread();
+		return (FALSE);
+	}
+
+	// the thread starts out with blank VRAM, send all of it
+	for (int t = 0; t < 7; t++)
+		memset(IPPU.TileCached[t], 0, TileCacheSize[t]);
+	Thread.Running = TRUE;
+
+	return (TRUE);
+}
+
+static void StopThread (void)
+{
+	pthread_mutex_lock(&Thread.Mutex);
+	Thread.Quit = TRUE;
+	pthread_cond_signal(&Thread.WorkCond);
+	pthread_mutex_unlock(&Thread.Mutex);
+	pthread_join(Thread.Id, NULL);
+
+	pthread_cond_destroy(&Thread.DoneCond);
+	pthread_cond_destroy(&Thread.WorkCond);
+	pthread_mutex_destroy(&Thread.Mutex);
+	FreeThread();
+	Thread.Running = FALSE;
+
+	// the main thread's tile cache flags were used as dirty maps and its
+	// direct colour maps weren't kept up, so both have to start over
+	for (int t = 0; t < 7; t++)
+		memset(IPPU.TileCached[t], 0, TileCacheSize[t]);
+	IPPU.DirectColourMapsNeedRebuild = TRUE;
+}
+
+bool8 S9xRenderThreadActive (void)
+{
+	return (Thread.Running);
+}
+
+bool8 S9xRenderThreadCanSplit (void)
+{
+	// A real flush applies a pending sprite setup and VRAM written without a
+	// flush to every line since the previous one, an early split wouldn't.
+	// Hi-res lines also blend their last pixel with the sub screen of the
+	// next line, which has to be drawn in the same range to match.
+	return (Thread.Running && !IPPU.OBJChanged &&
+		PPU.BGMode != 5 && PPU.BGMode != 6 && !IPPU.PseudoHires &&
+		!memchr(IPPU.TileCached[TILE_8BIT], 0, VRAM_BLOCKS));
+}
+
+bool8 S9xRenderThreadStartFrame (void)
+{
+	if (Settings.RenderThread != Thread.Running)
+	{
+		if (Thread.Running)
+			StopThread();
+		else
+		if (!StartThread())
+		{
+			S9xMessage(S9X_ERROR, S9X_DEBUG_OUTPUT, "Couldn't start render thread");
+			Settings.RenderThread = FALSE;
+		}
+	}
+
+	Thread.ClearZBuffers = Thread.Running;
+
+	return (Thread.Running);
+}
+
+void S9xRenderThreadQueue (uint32 widenSrcPPL, uint32 widenDstPPL, bool8 doubleHeight)
+{
+	// The main thread never draws while the render thread runs, so its tile
+	// cache flags, cleared by every VRAM write, double as dirty maps. The 8bpp
+	// one gives the changed 64 byte blocks of VRAM.
+	uint8	*dirtyMap = IPPU.TileCached[TILE_8BIT];
+	uint16	dirty[VRAM_BLOCKS];
+	uint32	dirtyCount = 0;
+
+	for (uint32 b = 0; b < VRAM_BLOCKS; b++)
+	{
+		if (!dirtyMap[b])
+			dirty[dirtyCount++] = b;
+	}
+
+	pthread_mutex_lock(&Thread.Mutex);
+	while (Thread.Queued - Thread.Done == RENDER_JOBS ||
+		Thread.VRAMQueued + dirtyCount - Thread.VRAMDone > VRAM_RING_BLOCKS)
+		pthread_cond_wait(&Thread.DoneCond, &Thread.Mutex);
+	pthread_mutex_unlock(&Thread.Mutex);
+
+	struct SRenderJob	*job = &Thread.Jobs[Thread.Queued % RENDER_JOBS];
+
+	job->PPUState = PPU;
+	job->IPPUState = IPPU;
+	memcpy(job->Regs, Memory.FillRAM + 0x2100, sizeof(job->Regs));
+	job->Screen = GFX.Screen;
+	job->PPL = GFX.PPL;
+	job->RealPPL = GFX.RealPPL;
+	job->StartY = GFX.StartY;
+	job->EndY = GFX.EndY;
+	job->FixedColour = GFX.FixedColour;
+	job->DoInterlace = GFX.DoInterlace;
+	job->InterlaceFrame = GFX.InterlaceFrame;
+	job->ClearZBuffers = Thread.ClearZBuffers;
+	job->DoubleHeight = doubleHeight;
+	job->WidenSrcPPL = widenSrcPPL;
+	job->WidenDstPPL = widenDstPPL;
+	Thread.ClearZBuffers = FALSE;
+
+	// mosaic reads back the line data of earlier ranges, so pass on every
+	// line latched so far even if it's past the visible height
+	uint32	lineEnd = IPPU.CurrentLine < 240 ? IPPU.CurrentLine : 240;
+	job->Lines = GFX.StartY < lineEnd ? lineEnd - GFX.StartY : 0;
+	memcpy(&job->LineData[GFX.StartY], &GFX.LineData[GFX.StartY], job->Lines * sizeof(GFX.LineData[0]));
+	memcpy(&job->LineMatrixData[GFX.StartY], &GFX.LineMatrixData[GFX.StartY], job->Lines * sizeof(GFX.LineMatrixData[0]));
+	memcpy(job->OBJWidths, GFX.OBJWidths, sizeof(GFX.OBJWidths));
+	memcpy(job->OBJVisibleTiles, GFX.OBJVisibleTiles, sizeof(GFX.OBJVisibleTiles));
+	if (GFX.EndY >= GFX.StartY)
+		memcpy(&job->OBJLines[GFX.StartY], &GFX.OBJLines[GFX.StartY], (GFX.EndY - GFX.StartY + 1) * sizeof(GFX.OBJLines[0]));
+
+	job->VRAMStart = Thread.VRAMQueued;
+	job->VRAMCount = dirtyCount;
+	for (uint32 i = 0; i < dirtyCount; i++)
+	{
+		struct SRenderBlock	*block = &Thread.VRAMBlocks[(Thread.VRAMQueued + i) % VRAM_RING_BLOCKS];
+
+		block->Block = dirty[i];
+		block->Invalid = 0;
+		memcpy(block->Data, Memory.VRAM + dirty[i] * 64, 64);
+		dirtyMap[dirty[i]] = TRUE;
+
+		for (uint32 f = 0, bit = 1; f < 6; f++)
+		{
+			uint8	*cached = IPPU.TileCached[CacheFlags[f].Cache];
+			uint32	mask = TileCacheSize[CacheFlags[f].Cache] - 1;
+			uint32	first = (dirty[i] << CacheFlags[f].Shift) - CacheFlags[f].Before;
+
+			for (uint32 n = 0; n < CacheFlags[f].Count; n++, bit <<= 1)
+			{
+				if (!cached[(first + n) & mask])
+				{
+					cached[(first + n) & mask] = TRUE;
+					block->Invalid |= bit;
+				}
+			}
+		}
+	}
+
+	Thread.VRAMQueued += dirtyCount;
+
+	// the thread rebuilds its own copy when told to
+	IPPU.DirectColourMapsNeedRebuild = FALSE;
+
+	pthread_mutex_lock(&Thread.Mutex);
+	Thread.Queued++;
+	pthread_cond_signal(&Thread.WorkCond);
+	pthread_mutex_unlock(&Thread.Mutex);
+}
+
+void S9xRenderThreadSync (void)
+{
+	if (!Thread.Running)
+		return;
+
+	pthread_mutex_lock(&Thread.Mutex);
+	while (Thread.Done != Thread.Queued)
+		pthread_cond_wait(&Thread.DoneCond, &Thread.Mutex);
+	pthread_mutex_unlock(&Thread.Mutex);
+}
+
+void S9xRenderThreadDeinit (void)
+{
+	if (Thread.Running)
+		StopThread();
+}
+
+// The renderer, compiled a second time against the thread's state. The
+// headers above are already included, so only the code below is affected.
+
+#define PPU							ThreadPPU
+#define IPPU						ThreadIPPU
+#define GFX							ThreadGFX
+#define Memory						ThreadMemory
+#define DirectColourMaps			ThreadDirectColourMaps
+#define S9xGraphicsInit				ThreadGraphicsInit
+#define S9xGraphicsDeinit			ThreadGraphicsDeinit
+#define S9xBuildDirectColourMaps	ThreadBuildDirectColourMaps
+#define S9xStartScreenRefresh		ThreadStartScreenRefresh
+#define S9xEndScreenRefresh			ThreadEndScreenRefresh
+#define RenderLine					ThreadRenderLine
+#define S9xUpdateScreen				ThreadUpdateScreen
+#define S9xReRefresh				ThreadReRefresh
+#define S9xDisplayChar				ThreadDisplayChar
+#define S9xDisplayMessages			ThreadDisplayMessages
+#define S9xSetRenderPixelFormat		ThreadSetRenderPixelFormat
+#define S9xInitTileRenderer			ThreadInitTileRenderer
+#define S9xSelectTileRenderers		ThreadSelectTileRenderers
+#define S9xSelectTileConverter		ThreadSelectTileConverter
+
+// keep the second copy out of the symbol table, most of it is never called
+static bool8 S9xGraphicsInit (void);
+static void S9xGraphicsDeinit (void);
+static void S9xBuildDirectColourMaps (void);
+static void S9xStartScreenRefresh (void);
+static void S9xEndScreenRefresh (void);
+static void RenderLine (uint8);
+static void S9xUpdateScreen (void);
+static void S9xReRefresh (void);
+static void S9xDisplayChar (uint16 *, uint8);
+static void S9xDisplayMessages (uint16 *, int, int, int, int);
+#ifdef GFX_MULTI_FORMAT
+static bool8 S9xSetRenderPixelFormat (int);
+#endif
+static void S9xInitTileRenderer (void);
+static void S9xSelectTileRenderers (int, bool8, bool8);
+static void S9xSelectTileConverter (int, bool8, bool8, bool8);
+
+#include "gfx.cpp"
+#include "tile.cpp"
+
+static void RunJob (struct SRenderJob *job)
+{
+	uint8	*tileCache[7], *tileCached[7];
+	bool8	rebuild = IPPU.DirectColourMapsNeedRebuild;
+
+	memcpy(tileCache, IPPU.TileCache, sizeof(tileCache));
+	memcpy(tileCached, IPPU.TileCached, sizeof(tileCached));
+	PPU = job->PPUState;
+	IPPU = job->IPPUState;
+	memcpy(IPPU.TileCache, tileCache, sizeof(tileCache));
+	memcpy(IPPU.TileCached, tileCached, sizeof(tileCached));
+	IPPU.DirectColourMapsNeedRebuild |= rebuild;
+	memcpy(Memory.FillRAM + 0x2100, job->Regs, sizeof(job->Regs));
+
+	for (uint32 i = 0; i < job->VRAMCount; i++)
+	{
+		struct SRenderBlock	*block = &Thread.VRAMBlocks[(job->VRAMStart + i) % VRAM_RING_BLOCKS];
+
+		memcpy(Memory.VRAM + block->Block * 64, block->Data, 64);
+		IPPU.TileCached[TILE_8BIT][block->Block] = FALSE;
+
+		for (uint32 f = 0, bit = 1; f < 6; f++)
+		{
+			uint8	*cached = IPPU.TileCached[CacheFlags[f].Cache];
+			uint32	mask = TileCacheSize[CacheFlags[f].Cache] - 1;
+			uint32	first = (block->Block << CacheFlags[f].Shift) - CacheFlags[f].Before;
+
+			for (uint32 n = 0; n < CacheFlags[f].Count; n++, bit <<= 1)
+			{
+				if (block->Invalid & bit)
+					cached[(first + n) & mask] = FALSE;
+			}
+		}
+	}
+
+	GFX.Screen = job->Screen;
+	GFX.PPL = job->PPL;
+	GFX.RealPPL = job->RealPPL;
+	GFX.StartY = job->StartY;
+	GFX.EndY = job->EndY;
+	GFX.FixedColour = job->FixedColour;
+	GFX.DoInterlace = job->DoInterlace;
+	GFX.InterlaceFrame = job->InterlaceFrame;
+
+	memcpy(&GFX.LineData[GFX.StartY], &job->LineData[GFX.StartY], job->Lines * sizeof(GFX.LineData[0]));
+	memcpy(&GFX.LineMatrixData[GFX.StartY], &job->LineMatrixData[GFX.StartY], job->Lines * sizeof(GFX.LineMatrixData[0]));
+	memcpy(GFX.OBJWidths, job->OBJWidths, sizeof(GFX.OBJWidths));
+	memcpy(GFX.OBJVisibleTiles, job->OBJVisibleTiles, sizeof(GFX.OBJVisibleTiles));
+	if (GFX.EndY >= GFX.StartY)
+		memcpy(&GFX.OBJLines[GFX.StartY], &job->OBJLines[GFX.StartY], (GFX.EndY - GFX.StartY + 1) * sizeof(GFX.OBJLines[0]));
+
+	if (job->ClearZBuffers)
+	{
+		memset(GFX.ZBuffer, 0, GFX.ScreenSize);
+		memset(GFX.SubZBuffer, 0, GFX.ScreenSize);
+	}
+
+	DrawScreen(job->WidenSrcPPL, job->WidenDstPPL, job->DoubleHeight);
+}
+
+static void *RenderThreadFunc (void *)
+{
+	pthread_mutex_lock(&Thread.Mutex);
+
+	for (;;)
+	{
+		while (Thread.Done == Thread.Queued && !Thread.Quit)
+			pthread_cond_wait(&Thread.WorkCond, &Thread.Mutex);
+
+		if (Thread.Done == Thread.Queued)
+			break;
+
+		struct SRenderJob	*job = &Thread.Jobs[Thread.Done % RENDER_JOBS];
+		pthread_mutex_unlock(&Thread.Mutex);
+
+		S9xUpdateThreadScheduling();
+		RunJob(job);
+
+		pthread_mutex_lock(&Thread.Mutex);
+		Thread.Done++;
+		Thread.VRAMDone = job->VRAMStart + job->VRAMCount;
+		pthread_cond_signal(&Thread.DoneCond);
+	}
+
+	pthread_mutex_unlock(&Thread.Mutex);
+
+	return (NULL);
+}
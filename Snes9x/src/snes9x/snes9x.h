@@ -357,6 +357,7 @@ struct SSettings
 #endif
 
 	bool8	SuperFX = 0;
+	bool8	SuperFXThread = 0;
 	uint8	DSP = 0;
 	bool8	SA1 = 0;
 	bool8	C4 = 0;
@@ -401,6 +402,7 @@ struct SSettings
 	static const bool8	SupportHiRes = 1;
 	static const bool8	Transparency = 1;
 	uint8	BG_Forced = 0;
+	bool8	RenderThread = 0;
 	static const bool8	DisableGraphicWindows = 0;
 
 	static const bool8	DisplayFrameRate = 0;
@@ -477,6 +479,7 @@ void S9xSetPause(uint32);
 void S9xClearPause(uint32);
 void S9xExit(void);
 void S9xMessage(int, int, const char *);
+void S9xUpdateThreadScheduling(void);
 void S9xPrintf(const char* msg, ...) __attribute__ ((format (printf, 1, 2)));
 void S9xPrintfError(const char* msg, ...) __attribute__ ((format (printf, 1, 2)));
 
@@ -189,6 +189,14 @@
 #include "ppu.h"
 #include "tile.h"
 
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define TILE_SIMD
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define TILE_SIMD
+#endif
+
 static uint32	pixbit[8][16];
 static uint8	hrbit_odd[256];
 static uint8	hrbit_even[256];
@@ -253,6 +261,233 @@ void S9xInitTileRenderer (void)
 	}
 }
 
+#ifdef TILE_SIMD
+
+// Vector tile decoding. A 16 byte block of tile data holds two bitplanes,
+// interleaved per row. Repeating each plane byte across eight lanes and
+// testing a different bit in every lane gives one bit of eight pixels, so
+// a row of both planes is one vector and two rows make 16 output bytes.
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+
+typedef uint8x16_t	tile_vec;
+
+static inline tile_vec TileLoad (const uint8 *p)
+{
+	return (vld1q_u8(p));
+}
+
+static inline void TileStore (uint8 *p, tile_vec v)
+{
+	vst1q_u8(p, v);
+}
+
+static inline tile_vec TileZero (void)
+{
+	return (vdupq_n_u8(0));
+}
+
+static inline void TileZip8 (tile_vec v, tile_vec &lo, tile_vec &hi)
+{
+	uint8x16x2_t	z = vzipq_u8(v, v);
+	lo = z.val[0];
+	hi = z.val[1];
+}
+
+static inline void TileZip16 (tile_vec v, tile_vec &lo, tile_vec &hi)
+{
+	uint16x8x2_t	z = vzipq_u16(vreinterpretq_u16_u8(v), vreinterpretq_u16_u8(v));
+	lo = vreinterpretq_u8_u16(z.val[0]);
+	hi = vreinterpretq_u8_u16(z.val[1]);
+}
+
+static inline void TileZip32 (tile_vec v, tile_vec &lo, tile_vec &hi)
+{
+	uint32x4x2_t	z = vzipq_u32(vreinterpretq_u32_u8(v), vreinterpretq_u32_u8(v));
+	lo = vreinterpretq_u8_u32(z.val[0]);
+	hi = vreinterpretq_u8_u32(z.val[1]);
+}
+
+static inline tile_vec TileBits (tile_vec v, tile_vec bits, tile_vec weights)
+{
+	return (vandq_u8(vtstq_u8(v, bits), weights));
+}
+
+// low halves of a and b make the first row, high halves the second
+static inline tile_vec TileRowPair (tile_vec a, tile_vec b)
+{
+	return (vorrq_u8(vcombine_u8(vget_low_u8(a), vget_low_u8(b)), vcombine_u8(vget_high_u8(a), vget_high_u8(b))));
+}
+
+static inline tile_vec TileSelect (tile_vec mask, tile_vec a, tile_vec b)
+{
+	return (vbslq_u8(mask, a, b));
+}
+
+static inline tile_vec TileOr (tile_vec a, tile_vec b)
+{
+	return (vorrq_u8(a, b));
+}
+
+static inline bool TileIsZero (tile_vec v)
+{
+	uint32x2_t	t = vreinterpret_u32_u8(vorr_u8(vget_low_u8(v), vget_high_u8(v)));
+	return (!(vget_lane_u32(t, 0) | vget_lane_u32(t, 1)));
+}
+
+#else
+
+typedef __m128i		tile_vec;
+
+static inline tile_vec TileLoad (const uint8 *p)
+{
+	return (_mm_loadu_si128((const __m128i *) p));
+}
+
+static inline void TileStore (uint8 *p, tile_vec v)
+{
+	_mm_storeu_si128((__m128i *) p, v);
+}
+
+static inline tile_vec TileZero (void)
+{
+	return (_mm_setzero_si128());
+}
+
+static inline void TileZip8 (tile_vec v, tile_vec &lo, tile_vec &hi)
+{
+	lo = _mm_unpacklo_epi8(v, v);
+	hi = _mm_unpackhi_epi8(v, v);
+}
+
+static inline void TileZip16 (tile_vec v, tile_vec &lo, tile_vec &hi)
+{
+	lo = _mm_unpacklo_epi16(v, v);
+	hi = _mm_unpackhi_epi16(v, v);
+}
+
+static inline void TileZip32 (tile_vec v, tile_vec &lo, tile_vec &hi)
+{
+	lo = _mm_unpacklo_epi32(v, v);
+	hi = _mm_unpackhi_epi32(v, v);
+}
+
+static inline tile_vec TileBits (tile_vec v, tile_vec bits, tile_vec weights)
+{
+	return (_mm_and_si128(_mm_cmpeq_epi8(_mm_and_si128(v, bits), bits), weights));
+}
+
+static inline tile_vec TileRowPair (tile_vec a, tile_vec b)
+{
+	return (_mm_or_si128(_mm_unpacklo_epi64(a, b), _mm_unpackhi_epi64(a, b)));
+}
+
+static inline tile_vec TileSelect (tile_vec mask, tile_vec a, tile_vec b)
+{
+	return (_mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b)));
+}
+
+static inline tile_vec TileOr (tile_vec a, tile_vec b)
+{
+	return (_mm_or_si128(a, b));
+}
+
+static inline bool TileIsZero (tile_vec v)
+{
+	return (_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_setzero_si128())) == 0xffff);
+}
+
+#endif
+
+// bit tested in each lane, lanes 0-7 are the first plane and 8-15 the second
+static const uint8	TileBitsNormal[16] =
+{
+	0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01,
+	0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01
+};
+
+// hi-res tiles take every other pixel, the left half from this tile and the
+// right half from the next one, see hrbit_odd and hrbit_even
+static const uint8	TileBitsOdd[16] =
+{
+	0x40, 0x10, 0x04, 0x01, 0x40, 0x10, 0x04, 0x01,
+	0x40, 0x10, 0x04, 0x01, 0x40, 0x10, 0x04, 0x01
+};
+
+static const uint8	TileBitsEven[16] =
+{
+	0x80, 0x20, 0x08, 0x02, 0x80, 0x20, 0x08, 0x02,
+	0x80, 0x20, 0x08, 0x02, 0x80, 0x20, 0x08, 0x02
+};
+
+static const uint8	TileLeftHalf[16] =
+{
+	0xff, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00,
+	0xff, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00
+};
+
+// pixel bits given by each pair of planes
+static const uint8	TileWeights[4][16] =
+{
+	{ 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02 },
+	{ 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08 },
+	{ 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20 },
+	{ 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }
+};
+
+// each row of the two planes at tp, repeated across the lanes
+static inline void TileRows (const uint8 *tp, tile_vec row[8])
+{
+	tile_vec	lo, hi, q[4];
+
+	TileZip8(TileLoad(tp), lo, hi);
+	TileZip16(lo, q[0], q[1]);
+	TileZip16(hi, q[2], q[3]);
+
+	for (int i = 0; i < 4; i++)
+		TileZip32(q[i], row[i * 2], row[i * 2 + 1]);
+}
+
+template <int pairs, bool hires>
+static inline uint8 TileConvert (uint8 *pCache, const uint8 *tp1, const uint8 *tp2, const uint8 *bitTable)
+{
+	tile_vec	bits = TileLoad(bitTable);
+	tile_vec	acc[8], row[8], row2[8];
+
+	for (int i = 0; i < pairs; i++)
+	{
+		tile_vec	weights = TileLoad(TileWeights[i]);
+
+		TileRows(tp1 + i * 16, row);
+
+		if (hires)
+		{
+			tile_vec	left = TileLoad(TileLeftHalf);
+
+			TileRows(tp2 + i * 16, row2);
+			for (int r = 0; r < 8; r++)
+				row[r] = TileSelect(left, row[r], row2[r]);
+		}
+
+		for (int r = 0; r < 8; r++)
+			acc[r] = i ? TileOr(acc[r], TileBits(row[r], bits, weights)) : TileBits(row[r], bits, weights);
+	}
+
+	tile_vec	non_zero = TileZero();
+
+	for (int r = 0; r < 4; r++)
+	{
+		tile_vec	out = TileRowPair(acc[r * 2], acc[r * 2 + 1]);
+
+		TileStore(pCache + r * 16, out);
+		non_zero = TileOr(non_zero, out);
+	}
+
+	return (TileIsZero(non_zero) ? BLANK_TILE : TRUE);
+}
+
+#endif
+
 // Here are the tile converters, selected by S9xSelectTileConverter().
 // Really, except for the definition of DOBIT and the number of times it is called, they're all the same.
 
@@ -265,6 +500,9 @@ void S9xInitTileRenderer (void)
 
 static uint8 ConvertTile2 (uint8 *pCache, uint32 TileAddr, uint32)
 {
+	#ifdef TILE_SIMD
+	return (TileConvert<1, false>(pCache, &Memory.VRAM[TileAddr], NULL, TileBitsNormal));
+	#else
 	register uint8	*tp      = &Memory.VRAM[TileAddr];
 	uint32			*p       = (uint32 *) pCache;
 	uint32			non_zero = 0;
@@ -284,10 +522,14 @@ static uint8 ConvertTile2 (uint8 *pCache, uint32 TileAddr, uint32)
 	}
 
 	return (non_zero ? TRUE : BLANK_TILE);
+	#endif
 }
 
 static uint8 ConvertTile4 (uint8 *pCache, uint32 TileAddr, uint32)
 {
+	#ifdef TILE_SIMD
+	return (TileConvert<2, false>(pCache, &Memory.VRAM[TileAddr], NULL, TileBitsNormal));
+	#else
 	register uint8	*tp      = &Memory.VRAM[TileAddr];
 	uint32			*p       = (uint32 *) pCache;
 	uint32			non_zero = 0;
@@ -309,10 +551,14 @@ static uint8 ConvertTile4 (uint8 *pCache, uint32 TileAddr, uint32)
 	}
 
 	return (non_zero ? TRUE : BLANK_TILE);
+	#endif
 }
 
 static uint8 ConvertTile8 (uint8 *pCache, uint32 TileAddr, uint32)
 {
+	#ifdef TILE_SIMD
+	return (TileConvert<4, false>(pCache, &Memory.VRAM[TileAddr], NULL, TileBitsNormal));
+	#else
 	register uint8	*tp      = &Memory.VRAM[TileAddr];
 	uint32			*p       = (uint32 *) pCache;
 	uint32			non_zero = 0;
@@ -338,6 +584,7 @@ static uint8 ConvertTile8 (uint8 *pCache, uint32 TileAddr, uint32)
 	}
 
 	return (non_zero ? TRUE : BLANK_TILE);
+	#endif
 }
 
 #undef DOBIT
@@ -351,14 +598,19 @@ static uint8 ConvertTile8 (uint8 *pCache, uint32 TileAddr, uint32)
 static uint8 ConvertTile2h_odd (uint8 *pCache, uint32 TileAddr, uint32 Tile)
 {
 	register uint8	*tp1     = &Memory.VRAM[TileAddr], *tp2;
-	uint32			*p       = (uint32 *) pCache;
-	uint32			non_zero = 0;
-	uint8			line;
 
+	// the next tile wraps around VRAM like the tile address itself
 	if (Tile == 0x3ff)
-		tp2 = tp1 - (0x3ff << 4);
+		tp2 = &Memory.VRAM[(TileAddr - (0x3ff << 4)) & 0xffff];
 	else
-		tp2 = tp1 + (1 << 4);
+		tp2 = &Memory.VRAM[(TileAddr + (1 << 4)) & 0xffff];
+
+	#ifdef TILE_SIMD
+	return (TileConvert<1, true>(pCache, tp1, tp2, TileBitsOdd));
+	#else
+	uint32			*p       = (uint32 *) pCache;
+	uint32			non_zero = 0;
+	uint8			line;
 
 	for (line = 8; line != 0; line--, tp1 += 2, tp2 += 2)
 	{
@@ -374,19 +626,24 @@ static uint8 ConvertTile2h_odd (uint8 *pCache, uint32 TileAddr, uint32 Tile)
 	}
 
 	return (non_zero ? TRUE : BLANK_TILE);
+	#endif
 }
 
 static uint8 ConvertTile4h_odd (uint8 *pCache, uint32 TileAddr, uint32 Tile)
 {
 	register uint8	*tp1     = &Memory.VRAM[TileAddr], *tp2;
-	uint32			*p       = (uint32 *) pCache;
-	uint32			non_zero = 0;
-	uint8			line;
 
 	if (Tile == 0x3ff)
-		tp2 = tp1 - (0x3ff << 5);
+		tp2 = &Memory.VRAM[(TileAddr - (0x3ff << 5)) & 0xffff];
 	else
-		tp2 = tp1 + (1 << 5);
+		tp2 = &Memory.VRAM[(TileAddr + (1 << 5)) & 0xffff];
+
+	#ifdef TILE_SIMD
+	return (TileConvert<2, true>(pCache, tp1, tp2, TileBitsOdd));
+	#else
+	uint32			*p       = (uint32 *) pCache;
+	uint32			non_zero = 0;
+	uint8			line;
 
 	for (line = 8; line != 0; line--, tp1 += 2, tp2 += 2)
 	{
@@ -404,6 +661,7 @@ static uint8 ConvertTile4h_odd (uint8 *pCache, uint32 TileAddr, uint32 Tile)
 	}
 
 	return (non_zero ? TRUE : BLANK_TILE);
+	#endif
 }
 
 #undef DOBIT
@@ -417,14 +675,18 @@ static uint8 ConvertTile4h_odd (uint8 *pCache, uint32 TileAddr, uint32 Tile)
 static uint8 ConvertTile2h_even (uint8 *pCache, uint32 TileAddr, uint32 Tile)
 {
 	register uint8	*tp1     = &Memory.VRAM[TileAddr], *tp2;
-	uint32			*p       = (uint32 *) pCache;
-	uint32			non_zero = 0;
-	uint8			line;
 
 	if (Tile == 0x3ff)
-		tp2 = tp1 - (0x3ff << 4);
+		tp2 = &Memory.VRAM[(TileAddr - (0x3ff << 4)) & 0xffff];
 	else
-		tp2 = tp1 + (1 << 4);
+		tp2 = &Memory.VRAM[(TileAddr + (1 << 4)) & 0xffff];
+
+	#ifdef TILE_SIMD
+	return (TileConvert<1, true>(pCache, tp1, tp2, TileBitsEven));
+	#else
+	uint32			*p       = (uint32 *) pCache;
+	uint32			non_zero = 0;
+	uint8			line;
 
 	for (line = 8; line != 0; line--, tp1 += 2, tp2 += 2)
 	{
@@ -440,19 +702,24 @@ static uint8 ConvertTile2h_even (uint8 *pCache, uint32 TileAddr, uint32 Tile)
 	}
 
 	return (non_zero ? TRUE : BLANK_TILE);
+	#endif
 }
 
 static uint8 ConvertTile4h_even (uint8 *pCache, uint32 TileAddr, uint32 Tile)
 {
 	register uint8	*tp1     = &Memory.VRAM[TileAddr], *tp2;
-	uint32			*p       = (uint32 *) pCache;
-	uint32			non_zero = 0;
-	uint8			line;
 
 	if (Tile == 0x3ff)
-		tp2 = tp1 - (0x3ff << 5);
+		tp2 = &Memory.VRAM[(TileAddr - (0x3ff << 5)) & 0xffff];
 	else
-		tp2 = tp1 + (1 << 5);
+		tp2 = &Memory.VRAM[(TileAddr + (1 << 5)) & 0xffff];
+
+	#ifdef TILE_SIMD
+	return (TileConvert<2, true>(pCache, tp1, tp2, TileBitsEven));
+	#else
+	uint32			*p       = (uint32 *) pCache;
+	uint32			non_zero = 0;
+	uint8			line;
 
 	for (line = 8; line != 0; line--, tp1 += 2, tp2 += 2)
 	{
@@ -470,6 +737,7 @@ static uint8 ConvertTile4h_even (uint8 *pCache, uint32 TileAddr, uint32 Tile)
 	}
 
 	return (non_zero ? TRUE : BLANK_TILE);
+	#endif
 }
 
 #undef DOBIT
@@ -18,6 +18,7 @@
 #include <imagine/engine-globals.h>
 #include <imagine/audio/AudioManager.hh>
 #include <imagine/util/audio/PcmFormat.hh>
+#include <imagine/thread/Scheduling.hh>
 
 #if defined CONFIG_AUDIO_ALSA
 #include <imagine/audio/alsa/config.hh>
@@ -46,6 +47,12 @@ struct BufferContext
 	}
 };
 
+struct RingStats
+{
+	uint underruns = 0; // times the output ran dry waiting on samples
+	uint overruns = 0; // writes that didn't fit in the queue
+};
+
 extern PcmFormat pcmFormat; // the currently playing format
 
 CallResult openPcm(const PcmFormat &format);
@@ -64,5 +71,8 @@ void setHintOutputLatency(uint us);
 uint hintOutputLatency();
 void setHintStrictUnderrunCheck(bool on);
 bool hintStrictUnderrunCheck();
+RingStats ringStats();
+// applied to the backend's output thread, if it has one
+void setOutputThreadSchedulingHint(IG::SchedulingHint hint);
 int maxRate();
 }
@@ -0,0 +1,48 @@
+#pragma once
+
+/*  This file is part of Imagine.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Imagine.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <imagine/engine-globals.h>
+#include <imagine/fs/FS.hh>
+#include <imagine/util/DelegateFunc.hh>
+#include <sys/types.h>
+
+// Helpers for on-disk caches kept in the app's documents directory
+
+namespace FileCache
+{
+
+static constexpr uint64_t FNV1A_BASIS = 14695981039346656037ull;
+
+// 64-bit FNV-1a hash, pass a previous result as hash to continue it
+uint64_t fnv1a(const void *data, size_t size, uint64_t hash = FNV1A_BASIS);
+uint64_t fnv1a(const char *str, uint64_t hash = FNV1A_BASIS);
+
+// Path of the cache directory named name in the app's documents directory
+FS::PathString dirPath(const char *name);
+
+using EntrySizeDelegate = DelegateFunc<off_t (const char *path)>;
+using RemoveEntryDelegate = DelegateFunc<void (const char *path)>;
+
+// Removes the least recently modified entries until their total size plus sizeNeeded
+// fits in maxSize. Entries are the files in dir with extension ext. entrySize returns
+// an entry's size, or -1 if it's invalid and should be removed, and removeEntry deletes
+// it along with any companion files, both default to acting on the file itself.
+// Files with a "tmp" extension are left over from interrupted writes and always removed.
+void evict(const char *dir, const char *ext, off_t maxSize, off_t sizeNeeded,
+	EntrySizeDelegate entrySize = {}, RemoveEntryDelegate removeEntry = {});
+
+}
@@ -226,6 +226,9 @@ public:
 	LockedTextureBuffer lock(uint level);
 	LockedTextureBuffer lock(uint level, IG::WindowRect rect);
 	void unlock(LockedTextureBuffer lockBuff);
+	// copies the texture's pixels starting at the origin into pixmap,
+	// converting to its format, returns false if they can't be read back
+	bool read(uint level, IG::Pixmap pixmap);
 	IG::WP size(uint level) const;
 	IG::PixmapDesc pixmapDesc() const;
 	bool compileDefaultProgram(uint mode);
@@ -100,7 +100,11 @@ protected:
 	IG::PixmapDesc pixDesc;
 	GLuint sampler = 0; // used when separate sampler objects not supported
 	uint levels_ = 0;
-	GLuint ownPBO = 0;
+	// textures written every frame cycle through their own PBOs so mapping
+	// one never waits on the upload still reading the previous one
+	static constexpr uint OWN_PBOS = 3;
+	GLuint ownPBO[OWN_PBOS]{};
+	uint ownPBOIdx = 0;
 	#ifdef __ANDROID__
 	static AndroidStorageImpl androidStorageImpl_;
 	#endif
@@ -110,6 +114,7 @@ protected:
 public:
 	constexpr GLTexture() {}
 	GLuint texName() const;
+	bool hasDirectStorage() const { return directTex; }
 	#ifdef __ANDROID__
 	static bool setAndroidStorageImpl(AndroidStorageImpl impl);
 	static AndroidStorageImpl androidStorageImpl();
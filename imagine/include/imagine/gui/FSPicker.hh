@@ -16,6 +16,8 @@
 	along with Imagine.  If not, see <http://www.gnu.org/licenses/> */
 
 #include <vector>
+#include <deque>
+#include <memory>
 #include <imagine/engine-globals.h>
 #include <imagine/gfx/GfxText.hh>
 #include <imagine/gfx/GeomRect.hh>
@@ -39,6 +41,18 @@ public:
 	using OnPathReadError = DelegateFunc<void (FSPicker &picker, CallResult res)>;
 	static constexpr bool needsUpDirControl = !Config::envIsPS3;
 
+	struct FileEntry
+	{
+		FS::FileString name{};
+		bool isDir = false;
+	};
+
+	struct FileItem
+	{
+		FileEntry entry{};
+		TextMenuItem text{};
+	};
+
 	FSPicker(Base::Window &win): View{win}, tbl{win} {}
 	void init(Gfx::PixmapTexture *backRes, Gfx::PixmapTexture *closeRes,
 			FilterFunc filter = {}, bool singleDir = false, ResourceFace *face = View::defaultFace);
@@ -52,6 +66,8 @@ public:
 	void onLeftNavBtn(Input::Event e);
 	void onRightNavBtn(Input::Event e);
 	void setOnPathReadError(OnPathReadError del);
+	// Enables the persistent listing cache, name must uniquely identify the filter in use
+	void setListingCacheName(const char *name);
 	CallResult setPath(const char *path, Input::Event e);
 	CallResult setPath(const char *path);
 	CallResult setPath(FS::PathString path, Input::Event e)
@@ -100,13 +116,23 @@ protected:
 		}
 	};
 	OnPathReadError onPathReadError{};
-	MenuItem **textPtr{};
-	TextMenuItem *text{};
-	std::vector<FS::FileString> dir{};
+	std::deque<FileItem> fileItem{}; // in the order received, keeps item addresses stable
+	std::vector<FileItem*> dir{}; // sorted by name
+	std::vector<MenuItem*> textPtr{}; // table items in the order of dir
 	IG::WindowRect viewFrame{};
 	ResourceFace *faceRes{};
 	FSNavView navV{*this};
+	struct ListingTask;
+	std::shared_ptr<ListingTask> listing{};
+	const char *listingCacheName{};
 	bool singleDir = false;
+	bool highlightFirstEntry = false;
 
 	void changeDirByInput(const char *path, Input::Event e);
+	void startListing(FS::PathString path, FS::PathString cachePath, FS::file_time_type mTime);
+	void cancelListing();
+	void addEntries(std::vector<FileEntry> &entries);
+	void clearItems();
+	void appendItems(std::vector<FileEntry> &entries);
+	static void runListing(std::shared_ptr<ListingTask> task);
 };
@@ -33,6 +33,9 @@ public:
 	TableView(const char *name, Base::Window &win) : ScrollView(name, win) {}
 	IG::WindowRect &viewRect() override { return viewFrame; }
 	void init(MenuItem **item, uint items, _2DOrigin align = LC2DO);
+	// replaces the items without resetting the selection or scroll position,
+	// the items must already be compiled
+	void setItems(MenuItem **item, uint items);
 	void deinit() override;
 	void draw() override;
 	void place() override;
@@ -45,6 +48,7 @@ public:
 	int cells() const { return cells_; }
 	IG::WP cellSize() const { return {viewFrame.x, yCellSize}; }
 	void highlightCell(int idx);
+	int highlightedCell() const { return selected; }
 
 protected:
 	bool selectedIsActivated = false;
@@ -28,6 +28,8 @@ class ResourceFace
 public:
 	FontSettings settings{};
 	static constexpr bool supportsUnicode = Config::UNICODE_CHARS;
+	static constexpr uint GLYPH_TABLE_PAGE_BITS = 11;
+	static constexpr uint GLYPH_TABLE_PAGES = 32;
 
 	constexpr ResourceFace() {}
 	static ResourceFace *create(ResourceFont *font, FontSettings *set = nullptr);
@@ -58,14 +60,17 @@ public:
 
 private:
 	ResourceFont *font{};
-	GlyphEntry *glyphTable{};
+	GlyphEntry *glyphTable[GLYPH_TABLE_PAGES]{};
 	FontSizeRef faceSize{};
 	uint nominalHeight_ = 0;
 	uint32 usedGlyphTableBits = 0;
 
 	void calcNominalHeight();
 	bool initGlyphTable();
-	CallResult cacheChar(int c, int tableIdx);
+	void freeGlyphTable();
+	void deinitGlyphs();
+	GlyphEntry *glyphTableEntry(uint tableIdx, bool alloc);
+	CallResult cacheChar(int c, GlyphEntry &entry);
 };
 
 class GfxGlyphImage : public GfxImageSource
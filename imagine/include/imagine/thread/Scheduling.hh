@@ -0,0 +1,81 @@
+#pragma once
+
+/*  This file is part of Imagine.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Imagine.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <imagine/engine-globals.h>
+#include <cstdint>
+
+#if defined __linux__ && !defined __ANDROID__
+#define CONFIG_THREAD_SCHEDULING_HINTS
+#endif
+
+namespace IG
+{
+
+// bit N selects CPU N
+using CPUMask = uint64_t;
+
+enum class ThreadPolicy : uint8
+{
+	NORMAL, FIFO, ROUND_ROBIN
+};
+
+struct SchedulingHint
+{
+	CPUMask cpus = 0; // 0 lets the thread run on any CPU
+	ThreadPolicy policy = ThreadPolicy::NORMAL;
+	int priority = 0; // real-time priority, clamped to what RLIMIT_RTPRIO allows
+
+	constexpr SchedulingHint() {}
+	constexpr SchedulingHint(CPUMask cpus, ThreadPolicy policy, int priority):
+		cpus{cpus}, policy{policy}, priority{priority} {}
+};
+
+struct CPUTopology
+{
+	CPUMask online = 0;
+	// CPUs with the highest max frequency, all of them on uniform systems
+	CPUMask performance = 0;
+	// CPUs with the lowest max frequency, empty on uniform systems
+	CPUMask efficiency = 0;
+	uint cpus = 0;
+};
+
+// read once from sysfs cpufreq data, call from the main thread first
+const CPUTopology &cpuTopology();
+
+// applies to the calling thread, if real-time scheduling is refused the
+// thread's nice value is raised instead, ThreadPolicy::NORMAL restores
+// SCHED_OTHER and the default nice value, returns false if anything failed
+bool applySchedulingHint(const SchedulingHint &hint);
+
+// tracks how far a periodic event's intervals stray from the expected one
+class JitterStats
+{
+public:
+	constexpr JitterStats() {}
+	void add(int64_t intervalNs, int64_t expectedNs);
+	void log(const char *name) const;
+	void reset() { *this = {}; }
+
+private:
+	uint samples = 0;
+	uint late = 0; // intervals over 1.5x the expected one
+	uint64_t totalJitterNs = 0;
+	int64_t maxJitterNs = 0;
+};
+
+}
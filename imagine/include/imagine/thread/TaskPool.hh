@@ -0,0 +1,129 @@
+#pragma once
+
+/*  This file is part of Imagine.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Imagine.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <imagine/engine-globals.h>
+#include <imagine/thread/Thread.hh>
+#include <imagine/util/DelegateFunc.hh>
+#include <atomic>
+#include <algorithm>
+
+namespace IG
+{
+
+// Persistent pool of worker threads, each with its own task queue that
+// idle workers steal from. Tasks are spawned into a TaskGroup and joined
+// with TaskGroup::wait(), which runs queued tasks and only sleeps once
+// none are left to help with.
+class TaskPool
+{
+public:
+	using TaskFunc = DelegateFunc<void ()>;
+	static constexpr uint MAX_THREADS = 16;
+
+	class TaskGroup
+	{
+	public:
+		constexpr TaskGroup(TaskPool &pool): pool{pool} {}
+		~TaskGroup() { wait(); }
+		void run(TaskFunc func);
+		void wait();
+
+	private:
+		friend class TaskPool;
+		TaskPool &pool;
+		std::atomic<uint> pending{};
+	};
+
+	TaskPool() {}
+	~TaskPool() { deinit(); }
+	// starts up to MAX_THREADS workers, with 0 tasks run on the spawning thread
+	bool init(uint threads);
+	void deinit();
+	uint threads() const { return threads_; }
+	// pins worker thread to cpu where supported, -1 removes the hint
+	void setAffinityHint(uint thread, int cpu);
+
+	// calls func(start, end) over [begin, end) in chunks of at most grain
+	// items, spread over the workers and the calling thread
+	template <class F>
+	void parallelFor(uint begin, uint end, uint grain, F func)
+	{
+		if(begin >= end)
+			return;
+		grain = std::max(grain, 1u);
+		uint chunks = (end - begin + grain - 1) / grain;
+		if(!threads_ || chunks == 1)
+		{
+			func(begin, end);
+			return;
+		}
+		struct Range
+		{
+			F &func;
+			std::atomic<uint> next;
+			uint end, grain;
+
+			void run()
+			{
+				for(uint start; (start = next.fetch_add(grain, std::memory_order_relaxed)) < end;)
+				{
+					func(start, std::min(start + grain, end));
+				}
+			}
+		} range{func, {begin}, end, grain};
+		TaskGroup group{*this};
+		iterateTimes(std::min(threads_, chunks - 1), i)
+		{
+			group.run([&range](){ range.run(); });
+		}
+		range.run();
+		group.wait();
+	}
+
+	// lazily started pool sized to the online CPUs, shared by all users
+	static TaskPool &shared();
+
+private:
+	struct Task
+	{
+		TaskFunc func{};
+		TaskGroup *group{};
+	};
+
+	struct Queue;
+	struct Worker;
+
+	Queue *queue{}; // one per worker, plus one for outside threads
+	Worker *worker{};
+	uint threads_ = 0;
+	std::atomic<uint> queuedTasks{};
+	std::atomic<uint> sleepers{};
+	std::atomic<uint> waiters{};
+	std::atomic<uint> runningWorkers{};
+	std::atomic<bool> quit{};
+	Mutex sleepMutex{};
+	ConditionVar sleepCond{};
+	ConditionVar waitCond{}; // TaskGroup::wait() sleepers, also uses sleepMutex
+
+	void push(Task task);
+	bool runQueuedTask(int thisWorker);
+	void runWorker(uint idx);
+	void execute(Task &task);
+	void notifyWaiters();
+};
+
+}
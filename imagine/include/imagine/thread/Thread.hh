@@ -46,6 +46,7 @@ public:
 	~ConditionVar();
 	void wait(Mutex &mutex);
 	void notify_one();
+	void notify_all();
 };
 
 }
@@ -22,10 +22,16 @@
 #include <getopt.h>
 #include <alsa/asoundlib.h>
 #include <sys/time.h>
+#include <unistd.h>
 #include <math.h>
+#include <algorithm>
 #include <imagine/audio/Audio.hh>
 #include <imagine/logger/logger.h>
 #include <imagine/base/Base.hh>
+#include <imagine/thread/Thread.hh>
+#include <imagine/util/ringbuffer/LinuxRingBuffer.hh>
+#include <imagine/util/ScopeGuard.hh>
+#include <atomic>
 #include "alsautils.h"
 
 namespace Audio
@@ -36,6 +42,20 @@ static snd_pcm_t *pcmHnd{};
 static snd_pcm_uframes_t bufferSize, periodSize;
 static bool useMmap;
 static uint wantedLatency = 100000;
+// written by the app without locking, drained into the PCM by the output thread
+static StaticLinuxRingBuffer<> rBuff{};
+static std::atomic_bool runOutputThread{}, outputThreadRunning{};
+static IG::Mutex pcmMutex{}; // serializes PCM state changes with the output thread
+static std::atomic_uint underruns{}, overruns{};
+// PCM buffer fill as of the output thread's last transfer, lets the app
+// side cap what it queues without calling into ALSA
+static std::atomic_uint hwFramesQueued{};
+// PCM delay as of the output thread's last transfer, read by frameDelay()
+static std::atomic_uint hwDelayFrames{};
+// PCM state as of the last state change or transfer, read by isPlaying()
+static std::atomic_bool pcmRunning{};
+static IG::SchedulingHint outputThreadHint{};
+static bool outputThreadHintChanged = true; // guarded by pcmMutex
 
 int maxRate()
 {
@@ -81,15 +101,11 @@ int frameDelay()
 {
 	if(unlikely(!isOpen()))
 		return 0;
-	snd_pcm_sframes_t delay;
-	snd_pcm_delay(pcmHnd, &delay);
-	return delay;
+	return pcmFormat.bytesToFrames(rBuff.writtenSize()) + hwDelayFrames.load(std::memory_order_relaxed);
 }
 
-int framesFree()
+static int hwFramesFree()
 {
-	if(unlikely(!isOpen()))
-		return 0;
 	auto frames = snd_pcm_avail_update(pcmHnd);
 	if(frames < 0)
 	{
@@ -99,18 +115,54 @@ int framesFree()
 	return frames;
 }
 
+// the PCM buffer is sized to the requested latency, so cap the ring plus
+// the PCM fill at that size instead of letting the ring add a second buffer
+static uint queueFramesFree()
+{
+	int queued = pcmFormat.bytesToFrames(rBuff.writtenSize()) + hwFramesQueued.load(std::memory_order_relaxed);
+	return std::max(0, std::min((int)pcmFormat.bytesToFrames(rBuff.freeSpace()), (int)bufferSize - queued));
+}
+
+int framesFree()
+{
+	if(unlikely(!isOpen()))
+		return 0;
+	return queueFramesFree();
+}
+
+RingStats ringStats()
+{
+	RingStats stats;
+	stats.underruns = underruns.load(std::memory_order_relaxed);
+	stats.overruns = overruns.load(std::memory_order_relaxed);
+	return stats;
+}
+
+void setOutputThreadSchedulingHint(IG::SchedulingHint hint)
+{
+	pcmMutex.lock();
+	outputThreadHint = hint;
+	outputThreadHintChanged = true;
+	pcmMutex.unlock();
+}
+
 void pausePcm()
 {
 	if(unlikely(!isOpen()))
 		return;
 	logMsg("pausing playback");
+	pcmMutex.lock();
 	snd_pcm_pause(pcmHnd, 1);
+	pcmRunning.store(false, std::memory_order_relaxed);
+	pcmMutex.unlock();
 }
 
 void resumePcm()
 {
 	if(unlikely(!isOpen()))
 		return;
+	pcmMutex.lock();
+	auto unlockPcm = IG::scopeGuard([](){ pcmMutex.unlock(); });
 	int state = snd_pcm_state(pcmHnd);
 	//logMsg("pcm state: %s", alsaPcmStateToString(state));
 	switch(state)
@@ -125,6 +177,7 @@ void resumePcm()
 			logMsg("resuming PCM");
 			snd_pcm_resume(pcmHnd);
 	}
+	pcmRunning.store(snd_pcm_state(pcmHnd) == SND_PCM_STATE_RUNNING, std::memory_order_relaxed);
 }
 
 void clearPcm()
@@ -132,137 +185,112 @@ void clearPcm()
 	if(unlikely(!isOpen()))
 		return;
 	logMsg("clearing queued samples");
+	pcmMutex.lock();
 	snd_pcm_drop(pcmHnd);
 	snd_pcm_prepare(pcmHnd);
+	rBuff.reset();
+	hwFramesQueued.store(0, std::memory_order_relaxed);
+	hwDelayFrames.store(0, std::memory_order_relaxed);
+	pcmRunning.store(false, std::memory_order_relaxed);
+	pcmMutex.unlock();
 }
 
-class AlsaMmapContext : public BufferContext
-{
-public:
-	const snd_pcm_channel_area_t *areas = nullptr;
-	snd_pcm_uframes_t offset = 0;
-	snd_pcm_t *pcmHnd = nullptr;
-
-	constexpr AlsaMmapContext() {}
-
-	CallResult begin(snd_pcm_t *pcmHnd, snd_pcm_uframes_t *frames)
-	{
-		var_selfs(pcmHnd);
-		snd_pcm_uframes_t wantedFrames = *frames;
-		if(snd_pcm_mmap_begin(pcmHnd, &areas, &offset, frames) != 0)
-		{
-			logErr("error in snd_pcm_mmap_begin");
-			return INVALID_PARAMETER;
-		}
-		if(*frames == 0)
-		{
-			//logWarn("unexpected 0 samples returned for MMAP");
-			snd_pcm_mmap_commit(pcmHnd, offset, 0);
-			return INVALID_PARAMETER;
-		}
-
-		if(wantedFrames != *frames)
-		{
-			//logMsg("got %d frames out of %d from mmap", (int)*frames, (int)wantedFrames);
-		}
-		data = (char*)areas->addr + offset * (areas->step / 8);
-		this->frames = *frames;
-
-		return OK;
-	}
-
-	CallResult commitBytes(uint bytesWritten)
-	{
-		return commit(pcmFormat.bytesToFrames(bytesWritten));
-	}
-
-	CallResult commit(snd_pcm_uframes_t framesWritten)
-	{
-		auto ret = snd_pcm_mmap_commit(pcmHnd, offset, framesWritten);
-		if(ret < 0 || ret != (snd_pcm_sframes_t)framesWritten)
-		{
-			logMsg("error in snd_pcm_mmap_commit");
-			return INVALID_PARAMETER;
-		}
-		return OK;
-	}
-};
-
-void writePcm(const void *samples, uint framesToWrite)
+// returns the frames free after getting the PCM back into a writable state,
+// or -1 when paused until resumePcm()
+static int prepareWrite()
 {
-	if(unlikely(!isOpen()))
-		return;
-
-	auto framesFreeOnHW = framesFree();
-
-	// verify PCM state
 	switch((int)snd_pcm_state(pcmHnd))
 	{
 		bcase SND_PCM_STATE_XRUN:
+			underruns++;
 			snd_pcm_recover(pcmHnd, -EPIPE, 0);
-			framesFreeOnHW = framesFree();
-			logMsg("recovered from xrun, %d frames free", framesFreeOnHW);
+			logMsg("recovered from xrun, %d frames free", hwFramesFree());
 		bcase SND_PCM_STATE_PAUSED:
-			logMsg("unpausing PCM");
-			snd_pcm_pause(pcmHnd, 0);
+			return -1;
 		bcase SND_PCM_STATE_SUSPENDED:
 			logMsg("resuming PCM");
 			snd_pcm_resume(pcmHnd);
 	}
+	return hwFramesFree();
+}
 
-	//logMsg("writing %d frames, %d free", framesToWrite, framesFreeOnHW);
-
-	/*{
-		static uint framesToWriteAvg = 0, writeCount = 0;
-		framesToWriteAvg += framesToWrite;
-		writeCount++;
-		if(writeCount == 120)
+// moves as much of the ring as fits into the PCM, returns the frames written
+static uint transferFrames()
+{
+	int hwFree = prepareWrite();
+	if(hwFree < 0)
+		return 0; // paused, the PCM fill is unchanged
+	uint framesToWrite = std::min(hwFree, (int)pcmFormat.bytesToFrames(rBuff.writtenSize()));
+	snd_pcm_sframes_t written = 0;
+	if(framesToWrite)
+	{
+		auto samples = rBuff.readAddr();
+		written = useMmap ? snd_pcm_mmap_writei(pcmHnd, samples, framesToWrite)
+			: snd_pcm_writei(pcmHnd, samples, framesToWrite);
+		if(written < 0)
 		{
-			logMsg("avg frames: %f, %d free", framesToWriteAvg / (double)120., framesFree());
-			framesToWriteAvg = 0;
-			writeCount = 0;
+			logWarn("error writing %d frames: %s", framesToWrite, alsaPcmWriteErrorToString(written));
+			written = 0;
 		}
-	}*/
-
-	if(framesFreeOnHW < (int)framesToWrite)
-	{
-		logWarn("sending %d frames but only %d free", framesToWrite, framesFreeOnHW);
-		framesToWrite = framesFreeOnHW;
+		else
+			rBuff.commitRead(pcmFormat.framesToBytes(written));
 	}
-	snd_pcm_sframes_t written;
-	if(useMmap)
+	hwFramesQueued.store(bufferSize - std::min((snd_pcm_uframes_t)hwFree, bufferSize) + written,
+		std::memory_order_relaxed);
+	snd_pcm_sframes_t delay = 0;
+	if(snd_pcm_delay(pcmHnd, &delay) < 0)
+		delay = 0;
+	hwDelayFrames.store(std::max(delay, (snd_pcm_sframes_t)0), std::memory_order_relaxed);
+	pcmRunning.store(snd_pcm_state(pcmHnd) == SND_PCM_STATE_RUNNING, std::memory_order_relaxed);
+	return written;
+}
+
+static void runOutput()
+{
+	// wake about twice a period, the PCM is non-blocking so waits are explicit
+	int waitMSecs = std::max(1, (int)pcmFormat.framesToMSecs(periodSize) / 2);
+	while(runOutputThread.load(std::memory_order_relaxed))
 	{
-		written = snd_pcm_mmap_writei(pcmHnd, samples, framesToWrite);
-		/*AlsaMmapContext ctx;
-		//logMsg("starting mmap loop");
-		auto samplePtr = (char*)samples;
-		for(snd_pcm_uframes_t frames; framesToWrite; framesToWrite -= frames)
+		snd_pcm_wait(pcmHnd, waitMSecs);
+		pcmMutex.lock();
+		if(unlikely(outputThreadHintChanged))
 		{
-			frames = framesToWrite;
-			if(ctx.begin(pcmHnd, &frames) != OK)
-				return;
-			assert(frames <= framesToWrite);
+			IG::applySchedulingHint(outputThreadHint);
+			outputThreadHintChanged = false;
+		}
+		auto written = transferFrames();
+		pcmMutex.unlock();
+		if(!written)
+			usleep(waitMSecs * 1000);
+	}
+	outputThreadRunning.store(false, std::memory_order_release);
+}
 
-			memcpy(ctx.data, samples, pcmFormat.framesToBytes(frames));
-			samplePtr += pcmFormat.framesToBytes(frames);
+BufferContext getPlayBuffer(uint wantedFrames)
+{
+	if(unlikely(!isOpen()))
+		return {};
+	return {rBuff.writeAddr(), std::min({wantedFrames, pcmFormat.bytesToFrames(rBuff.freeContiguousSpace()),
+		queueFramesFree()})};
+}
 
-			if(ctx.commit(frames) != OK)
-				return;
-		}*/
-	}
-	else
-	{
-		written = snd_pcm_writei(pcmHnd, samples, framesToWrite);
-	}
-	if(written != (snd_pcm_sframes_t)framesToWrite)
+void commitPlayBuffer(BufferContext buffer, uint frames)
+{
+	assert(frames <= buffer.frames);
+	rBuff.commitWrite(pcmFormat.framesToBytes(frames));
+}
+
+void writePcm(const void *samples, uint framesToWrite)
+{
+	if(unlikely(!isOpen()))
+		return;
+	auto frames = std::min(framesToWrite, queueFramesFree());
+	if(frames != framesToWrite)
 	{
-		if(written < 0)
-		{
-			logWarn("error writing %d frames: %s", framesToWrite, alsaPcmWriteErrorToString(written));
-		}
-		else
-			logWarn("only %ld of %d frames written", written, framesToWrite);
+		overruns++;
+		logWarn("overrun, wrote %d out of %d frames", frames, framesToWrite);
 	}
+	rBuff.write(samples, pcmFormat.framesToBytes(frames));
 }
 
 static int setupPcm(const PcmFormat &format, snd_pcm_access_t access)
@@ -339,6 +367,21 @@ static CallResult openAlsaPcm(const PcmFormat &format)
 	//snd_pcm_dump(alsaHnd, output);
 	//logMsg("pcm state: %s", alsaPcmStateToString(snd_pcm_state(pcmHnd)));
 
+	hwFramesQueued.store(0, std::memory_order_relaxed);
+	hwDelayFrames.store(0, std::memory_order_relaxed);
+	pcmRunning.store(false, std::memory_order_relaxed);
+	if(!rBuff.init(format.framesToBytes(bufferSize)))
+	{
+		ret = OUT_OF_MEMORY; goto CLEANUP;
+	}
+	runOutputThread = true;
+	outputThreadRunning = true;
+	outputThreadHintChanged = true; // new thread, apply the hint again
+	IG::runOnThread(
+		[]()
+		{
+			runOutput();
+		});
 	return OK;
 
 	CLEANUP:
@@ -357,8 +400,12 @@ static void closeAlsaPcm()
 	if(isOpen())
 	{
 		logDMsg("closing pcm");
+		runOutputThread = false;
+		while(outputThreadRunning.load(std::memory_order_acquire))
+			sched_yield();
 		snd_pcm_close(pcmHnd);
 		pcmHnd = nullptr;
+		rBuff.deinit();
 	}
 }
 
@@ -390,7 +437,7 @@ bool isOpen()
 
 bool isPlaying()
 {
-	return isOpen() && snd_pcm_state(pcmHnd) == SND_PCM_STATE_RUNNING;
+	return isOpen() && pcmRunning.load(std::memory_order_relaxed);
 }
 
 }
@@ -30,6 +30,8 @@ static AudioComponentInstance outputUnit{};
 static AudioStreamBasicDescription streamFormat;
 static bool isPlaying_ = false, isOpen_ = false, hadUnderrun = false;
 static StaticMachRingBuffer<> rBuff;
+static std::atomic_uint underruns{}; // incremented on the render thread
+static uint overruns = 0;
 
 int maxRate()
 {
@@ -69,6 +71,7 @@ static OSStatus outputCallback(void *inRefCon, AudioUnitRenderActionFlags *ioAct
 	{
 		//logMsg("underrun, read %d out of %d bytes", read, bytes);
 		hadUnderrun = true;
+		underruns++;
 		uint padBytes = bytes - read;
 		//logMsg("padding %d bytes", padBytes);
 		mem_zero(&buf[read], padBytes);
@@ -229,9 +232,20 @@ void writePcm(const void *samples, uint framesToWrite)
 	if(written != bytes)
 	{
 		//logMsg("overrun, wrote %d out of %d bytes", written, bytes);
+		overruns++;
 	}
 }
 
+RingStats ringStats()
+{
+	RingStats stats;
+	stats.underruns = underruns.load(std::memory_order_relaxed);
+	stats.overruns = overruns;
+	return stats;
+}
+
+void setOutputThreadSchedulingHint(IG::SchedulingHint hint) {}
+
 BufferContext getPlayBuffer(uint wantedFrames)
 {
 	if(unlikely(!isOpen()) || !framesFree())
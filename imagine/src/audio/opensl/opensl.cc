@@ -33,6 +33,7 @@ static SLAndroidSimpleBufferQueueItf slBuffQI{};
 static uint wantedLatency = 100000;
 static uint outputBufferBytes = 0; // size in bytes per buffer to enqueue
 static bool isPlaying_ = false, strictUnderrunCheck = true;
+static uint underruns = 0, overruns = 0;
 static bool reachedEndOfPlayback = false;
 static RingBufferType rBuff{};
 static uint unqueuedBytes = 0; // number of bytes in ring buffer that haven't been enqueued to SL yet
@@ -259,6 +260,7 @@ static bool checkXRun()
 	{
 		if(!::Config::MACHINE_IS_OUYA) // prevent log spam
 			logMsg("xrun");
+		underruns++;
 		pausePcm();
 		return true;
 	}
@@ -319,11 +321,22 @@ void writePcm(const void *samples, uint framesToWrite)
 	auto written = rBuff.write(samples, bytes);
 	if(written != bytes)
 	{
+		overruns++;
 		logMsg("overrun, wrote %d out of %d bytes", written, bytes);
 	}
 	updateQueue(written);
 }
 
+RingStats ringStats()
+{
+	RingStats stats;
+	stats.underruns = underruns;
+	stats.overruns = overruns;
+	return stats;
+}
+
+void setOutputThreadSchedulingHint(IG::SchedulingHint hint) {}
+
 int frameDelay()
 {
 	return 0; // TODO
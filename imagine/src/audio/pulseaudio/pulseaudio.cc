@@ -18,7 +18,10 @@
 #include <imagine/logger/logger.h>
 #include <imagine/base/Base.hh>
 #include <imagine/util/ScopeGuard.hh>
+#include <imagine/util/ringbuffer/LinuxRingBuffer.hh>
 #include <pulse/pulseaudio.h>
+#include <algorithm>
+#include <atomic>
 #ifdef CONFIG_AUDIO_PULSEAUDIO_GLIB
 #include <pulse/glib-mainloop.h>
 #else
@@ -33,6 +36,16 @@ static uint wantedLatency = 100000;
 static pa_context* context{};
 static pa_stream* stream{};
 static bool isCorked = true;
+// written by the app without locking, drained into the stream by the main loop
+static StaticLinuxRingBuffer<> rBuff{};
+static pa_time_event *pumpEvent{};
+static std::atomic_uint serverDelayFrames{};
+// server buffer fill as of the last pump, with its target fill set by the requested latency
+static std::atomic_uint serverBytesQueued{};
+static uint serverTargetBytes = 0;
+static std::atomic_uint underruns{}, overruns{};
+static IG::SchedulingHint outputThreadHint{};
+static std::atomic_bool outputThreadHintChanged{};
 
 #ifdef CONFIG_AUDIO_PULSEAUDIO_GLIB
 static pa_glib_mainloop* mainloop{};
@@ -155,33 +168,96 @@ uint hintOutputLatency()
 	return wantedLatency;
 }
 
+static pa_mainloop_api *mainLoopAPI()
+{
+	#ifdef CONFIG_AUDIO_PULSEAUDIO_GLIB
+	return pa_glib_mainloop_get_api(mainloop);
+	#else
+	return pa_threaded_mainloop_get_api(mainloop);
+	#endif
+}
+
+// runs in the main loop, moves queued samples into the server's buffer
+static void pumpStream(pa_stream *stream)
+{
+	auto bytesFree = pa_stream_writable_size(stream);
+	if(bytesFree == (size_t)-1)
+		return;
+	size_t bytes = std::min(bytesFree, (size_t)rBuff.writtenSize());
+	if(bytes)
+	{
+		if(pa_stream_write(stream, rBuff.readAddr(), bytes, nullptr, 0, PA_SEEK_RELATIVE) < 0)
+			logWarn("error writing %d bytes", (int)bytes);
+		rBuff.commitRead(bytes);
+	}
+	serverBytesQueued.store(serverTargetBytes - std::min(bytesFree - bytes, (size_t)serverTargetBytes),
+		std::memory_order_relaxed);
+	pa_usec_t delay;
+	if(pa_stream_get_latency(stream, &delay, nullptr) == 0)
+		serverDelayFrames.store(pcmFormat.uSecsToFrames(delay), std::memory_order_relaxed);
+}
+
+static void startPumpTimer()
+{
+	// the server only requests data as its buffer drains, so poll as well
+	// to restart the stream after an underflow
+	pa_usec_t interval = wantedLatency / 4;
+	pumpEvent = pa_context_rttime_new(context, pa_rtclock_now() + interval,
+		[](pa_mainloop_api *api, pa_time_event *e, const struct timeval *, void *userdata)
+		{
+			auto interval = (pa_usec_t)(uintptr_t)userdata;
+			#ifndef CONFIG_AUDIO_PULSEAUDIO_GLIB
+			// the threaded main loop is the output thread, with GLib it's the app's own
+			if(unlikely(outputThreadHintChanged.load(std::memory_order_relaxed)))
+			{
+				outputThreadHintChanged = false;
+				IG::applySchedulingHint(outputThreadHint);
+			}
+			#endif
+			if(stream)
+				pumpStream(stream);
+			pa_context_rttime_restart(context, e, pa_rtclock_now() + interval);
+		}, (void*)(uintptr_t)interval);
+}
+
 int frameDelay()
 {
 	if(unlikely(!isOpen()))
 		return 0;
-	pa_usec_t delay;
-	iterateMainLoop();
-	lockMainLoop();
-	int err = pa_stream_get_latency(stream, &delay, nullptr);
-	unlockMainLoop();
-	if(err)
-	{
-		// TODO: check exact error like PA_ERR_NODATA
-		logErr("error getting stream latency");
-		return 0;
-	}
-	return pcmFormat.uSecsToFrames(delay);
+	return pcmFormat.bytesToFrames(rBuff.writtenSize()) + serverDelayFrames.load(std::memory_order_relaxed);
+}
+
+// the server's target fill is the requested latency, so cap the ring plus
+// the server fill at that size instead of letting the ring add a second buffer
+static uint queueFramesFree()
+{
+	int queued = rBuff.writtenSize() + serverBytesQueued.load(std::memory_order_relaxed);
+	return pcmFormat.bytesToFrames(std::max(0, std::min((int)rBuff.freeSpace(), (int)serverTargetBytes - queued)));
 }
 
 int framesFree()
 {
 	if(unlikely(!isOpen()))
 		return 0;
-	iterateMainLoop();
-	lockMainLoop();
-	auto bytes = pa_stream_writable_size(stream);
-	unlockMainLoop();
-	return pcmFormat.bytesToFrames(bytes);
+	return queueFramesFree();
+}
+
+RingStats ringStats()
+{
+	RingStats stats;
+	stats.underruns = underruns.load(std::memory_order_relaxed);
+	stats.overruns = overruns.load(std::memory_order_relaxed);
+	return stats;
+}
+
+void setOutputThreadSchedulingHint(IG::SchedulingHint hint)
+{
+	if(mainloop)
+		lockMainLoop();
+	outputThreadHint = hint;
+	outputThreadHintChanged = true;
+	if(mainloop)
+		unlockMainLoop();
 }
 
 void pausePcm()
@@ -214,6 +290,8 @@ void clearPcm()
 	logMsg("clearing queued samples");
 	lockMainLoop();
 	pa_stream_flush(stream, nullptr, nullptr);
+	rBuff.reset();
+	serverBytesQueued = 0;
 	unlockMainLoop();
 	iterateMainLoop();
 }
@@ -222,35 +300,28 @@ void writePcm(const void *samples, uint framesToWrite)
 {
 	if(unlikely(!isOpen()))
 		return;
-
-	iterateMainLoop();
-	lockMainLoop(); // TODO: locking here is sub-optimal, writes should be async using a ring-buffer
-	auto bytesFreeOnHW = pa_stream_writable_size(stream);
-	auto framesFreeOnHW = pcmFormat.bytesToFrames(bytesFreeOnHW);
-	auto bytesToWrite = pcmFormat.framesToBytes(framesToWrite);
-	//logMsg("writing %d frames, %d free", framesToWrite, framesFreeOnHW);
-	/*{
-		static uint framesToWriteAvg = 0, writeCount = 0;
-		framesToWriteAvg += framesToWrite;
-		writeCount++;
-		if(writeCount == 120)
-		{
-			logMsg("avg frames: %f, %d free", framesToWriteAvg / (double)120., framesFree());
-			framesToWriteAvg = 0;
-			writeCount = 0;
-		}
-	}*/
-	if(framesFreeOnHW < framesToWrite)
+	auto frames = std::min(framesToWrite, queueFramesFree());
+	if(frames != framesToWrite)
 	{
-		logWarn("sending %d frames but only %d free", framesToWrite, framesFreeOnHW);
-		bytesToWrite = bytesFreeOnHW;
-	}
-	int err = pa_stream_write(stream, samples, bytesToWrite, nullptr, 0, PA_SEEK_RELATIVE);
-	unlockMainLoop();
-	if(err < 0)
-	{
-		logWarn("error writing %d bytes", bytesToWrite);
+		overruns++;
+		logWarn("overrun, wrote %d out of %d frames", frames, framesToWrite);
 	}
+	rBuff.write(samples, pcmFormat.framesToBytes(frames));
+	iterateMainLoop();
+}
+
+BufferContext getPlayBuffer(uint wantedFrames)
+{
+	if(unlikely(!isOpen()))
+		return {};
+	return {rBuff.writeAddr(), std::min({wantedFrames, pcmFormat.bytesToFrames(rBuff.freeContiguousSpace()),
+		queueFramesFree()})};
+}
+
+void commitPlayBuffer(BufferContext buffer, uint frames)
+{
+	assert(frames <= buffer.frames);
+	rBuff.commitWrite(pcmFormat.framesToBytes(frames));
 	iterateMainLoop();
 }
 
@@ -380,10 +451,30 @@ CallResult openPcm(const PcmFormat &format)
 		return INVALID_PARAMETER;
 	}
 	auto serverAttr = pa_stream_get_buffer_attr(stream);
-	unlockMainLoop();
 	assert(serverAttr);
-	isCorked = false;
 	logMsg("opened stream with target fill bytes: %d", serverAttr->tlength);
+	if(!rBuff.init(serverAttr->tlength))
+	{
+		unlockMainLoop();
+		closePcm();
+		return OUT_OF_MEMORY;
+	}
+	serverDelayFrames = 0;
+	serverBytesQueued = 0;
+	serverTargetBytes = serverAttr->tlength;
+	pa_stream_set_write_callback(stream,
+		[](pa_stream *stream, size_t, void *)
+		{
+			pumpStream(stream);
+		}, nullptr);
+	pa_stream_set_underflow_callback(stream,
+		[](pa_stream *, void *)
+		{
+			underruns++;
+		}, nullptr);
+	startPumpTimer();
+	unlockMainLoop();
+	isCorked = false;
 	return OK;
 }
 
@@ -395,12 +486,20 @@ void closePcm()
 		return;
 	}
 	lockMainLoop();
+	if(pumpEvent)
+	{
+		mainLoopAPI()->time_free(pumpEvent);
+		pumpEvent = {};
+	}
+	pa_stream_set_write_callback(stream, nullptr, nullptr);
+	pa_stream_set_underflow_callback(stream, nullptr, nullptr);
 	pa_stream_disconnect(stream);
 	pa_stream_unref(stream);
+	stream = nullptr;
 	unlockMainLoop();
 	iterateMainLoop();
 	isCorked = true;
-	stream = nullptr;
+	rBuff.deinit();
 }
 
 bool isOpen()
@@ -1,6 +1,6 @@
 ifndef inc_fs
 inc_fs := 1
 
-SRC += fs/FS.cc
+SRC += fs/FS.cc fs/FileCache.cc
 
 endif
@@ -0,0 +1,105 @@
+/*  This file is part of Imagine.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Imagine.  If not, see <http://www.gnu.org/licenses/> */
+
+#define LOGTAG "FileCache"
+#include <imagine/fs/FileCache.hh>
+#include <imagine/base/Base.hh>
+#include <imagine/logger/logger.h>
+#include <imagine/util/strings.h>
+#include <algorithm>
+#include <vector>
+
+namespace FileCache
+{
+
+uint64_t fnv1a(const void *data, size_t size, uint64_t hash)
+{
+	auto bytes = (const uint8*)data;
+	iterateTimes(size, i)
+	{
+		hash = (hash ^ bytes[i]) * 1099511628211ull;
+	}
+	return hash;
+}
+
+uint64_t fnv1a(const char *str, uint64_t hash)
+{
+	return fnv1a(str, strlen(str), hash);
+}
+
+FS::PathString dirPath(const char *name)
+{
+	return FS::makePathStringPrintf("%s/%s", Base::documentsPath().data(), name);
+}
+
+void evict(const char *dir, const char *ext, off_t maxSize, off_t sizeNeeded,
+	EntrySizeDelegate entrySize, RemoveEntryDelegate removeEntry)
+{
+	struct CacheEntry
+	{
+		FS::PathString path;
+		FS::file_time_type lastUse;
+		off_t size;
+	};
+	auto remove =
+		[&removeEntry](const char *path)
+		{
+			if(removeEntry)
+				removeEntry(path);
+			else
+				FS::remove(path);
+		};
+	std::vector<CacheEntry> entries;
+	off_t totalSize = 0;
+	CallResult res = OK;
+	for(auto &e : FS::directory_iterator{dir, res})
+	{
+		auto name = e.name();
+		if(string_hasDotExtension(name, "tmp"))
+		{
+			FS::remove(e.path());
+			continue;
+		}
+		if(!string_hasDotExtension(name, ext))
+			continue;
+		auto path = e.path();
+		auto status = FS::status(path);
+		off_t size = entrySize ? entrySize(path.data()) : (off_t)status.size();
+		if(size < 0)
+		{
+			remove(path.data());
+			continue;
+		}
+		entries.push_back({path, status.last_write_time(), size});
+		totalSize += size;
+	}
+	if(totalSize + sizeNeeded <= maxSize)
+		return;
+	std::sort(entries.begin(), entries.end(),
+		[](const CacheEntry &e1, const CacheEntry &e2)
+		{
+			return e1.lastUse < e2.lastUse;
+		});
+	for(auto &e : entries)
+	{
+		if(totalSize + sizeNeeded <= maxSize)
+			break;
+		logMsg("evicting:%s", e.path.data());
+		remove(e.path.data());
+		totalSize -= e.size;
+	}
+}
+
+}
@@ -16,6 +16,7 @@
 #include <algorithm>
 #include <imagine/gfx/Gfx.hh>
 #include <imagine/gfx/Texture.hh>
+#include <imagine/gfx/RenderTarget.hh>
 #include <imagine/util/ScopeGuard.hh>
 #include <imagine/util/assume.h>
 #include "private.hh"
@@ -582,8 +583,8 @@ CallResult Texture::init(TextureConfig config)
 		#endif
 		if(!directTex && usePBO)
 		{
-			glGenBuffers(1, &ownPBO);
-			logMsg("made dedicated PBO:0x%X for texture", ownPBO);
+			glGenBuffers(OWN_PBOS, ownPBO);
+			logMsg("made %u dedicated PBOs starting at:0x%X for texture", OWN_PBOS, ownPBO[0]);
 		}
 	}
 	if(config.willGenerateMipmaps() && !useImmutableTexStorage)
@@ -609,10 +610,10 @@ void Texture::deinit()
 		delete directTex;
 		deleteTex(texName_);
 	}
-	if(ownPBO)
+	if(ownPBO[0])
 	{
-		logMsg("deleting PBO:0x%X", ownPBO);
-		glcDeleteBuffers(1, &ownPBO);
+		logMsg("deleting PBOs starting at:0x%X", ownPBO[0]);
+		glcDeleteBuffers(OWN_PBOS, ownPBO);
 	}
 	*this = {};
 }
@@ -717,12 +718,15 @@ CallResult Texture::setFormat(IG::PixmapDesc desc, uint levels)
 				h = std::max(1u, (h / 2));
 			}
 		}
-		if(ownPBO)
+		if(ownPBO[0])
 		{
 			uint buffSize = desc.pixelBytes();
-			glcBindBuffer(GL_PIXEL_UNPACK_BUFFER, ownPBO);
-			glBufferData(GL_PIXEL_UNPACK_BUFFER, buffSize, nullptr, GL_STREAM_DRAW);
-			logMsg("allocated PBO buffer bytes:%u", buffSize);
+			for(auto pbo : ownPBO)
+			{
+				glcBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo);
+				glBufferData(GL_PIXEL_UNPACK_BUFFER, buffSize, nullptr, GL_STREAM_DRAW);
+			}
+			logMsg("allocated %u PBO buffers of bytes:%u", OWN_PBOS, buffSize);
 		}
 	}
 	assert(levels);
@@ -894,9 +898,10 @@ LockedTextureBuffer Texture::lock(uint level, IG::WindowRect rect)
 	{
 		uint rangeBytes = pixDesc.format().pixelBytes(rect.xSize() * rect.ySize());
 		void *data;
-		if(ownPBO)
+		if(ownPBO[0])
 		{
-			glcBindBuffer(GL_PIXEL_UNPACK_BUFFER, ownPBO);
+			ownPBOIdx = (ownPBOIdx + 1) % OWN_PBOS;
+			glcBindBuffer(GL_PIXEL_UNPACK_BUFFER, ownPBO[ownPBOIdx]);
 			data = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, rangeBytes, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
 			//logDMsg("mapped own PBO at addr:%p", data);
 		}
@@ -929,6 +934,11 @@ void Texture::unlock(LockedTextureBuffer lockBuff)
 		auto pix = lockBuff.pixmap();
 		IG::WP destPos = {lockBuff.sourceDirtyRect().x, lockBuff.sourceDirtyRect().y};
 		//logDMsg("unmapped PBO");
+		if(ownPBO[0])
+		{
+			// the buffer may have been held mapped while other textures were written
+			glcBindBuffer(GL_PIXEL_UNPACK_BUFFER, ownPBO[ownPBOIdx]);
+		}
 		glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
 		glcPixelStorei(GL_UNPACK_ALIGNMENT, unpackAlignForAddrAndPitch(nullptr, pix.pitchBytes()));
 		glcPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
@@ -944,6 +954,53 @@ void Texture::unlock(LockedTextureBuffer lockBuff)
 	}
 }
 
+bool Texture::read(uint level, IG::Pixmap pixmap)
+{
+	assert(pixmap.w() <= (uint)size(level).x && pixmap.h() <= (uint)size(level).y);
+	// external textures can't be attached to a framebuffer
+	if(target != GL_TEXTURE_2D || pixmap.format().isGrayscale())
+		return false;
+	GLuint fbo;
+	glGenFramebuffers(1, &fbo);
+	glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texName_, level);
+	auto cleanup = IG::scopeGuard(
+		[&fbo]()
+		{
+			RenderTarget::setDefaultCurrent();
+			glDeleteFramebuffers(1, &fbo);
+		});
+	if(glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+	{
+		logErr("texture:0x%X can't be read back, framebuffer incomplete", texName_);
+		return false;
+	}
+	// RGBA bytes are the only read format every GL version supports
+	IG::MemPixmap rgba{{pixmap.size(), PIXEL_FMT_RGBA8888}};
+	handleGLErrors();
+	glReadPixels(0, 0, pixmap.w(), pixmap.h(), GL_RGBA, GL_UNSIGNED_BYTE, rgba.pixel({}));
+	if(handleGLErrors([](GLenum, const char *err) { logErr("%s in glReadPixels", err); }))
+		return false;
+	auto desc = pixmap.format().desc();
+	iterateTimes(pixmap.h(), y)
+	{
+		auto src = (const uint8*)rgba.pixel({0, (int)y});
+		auto dest = (char*)pixmap.pixel({0, (int)y});
+		iterateTimes(pixmap.w(), x)
+		{
+			uint pixel = desc.build(uint(src[0] >> (8 - desc.rBits)), uint(src[1] >> (8 - desc.gBits)),
+				uint(src[2] >> (8 - desc.bBits)), uint(src[3] >> (8 - desc.aBits)));
+			src += 4;
+			if(desc.bytesPerPixel() == 2)
+				*(uint16*)dest = pixel;
+			else
+				*(uint32*)dest = pixel;
+			dest += desc.bytesPerPixel();
+		}
+	}
+	return true;
+}
+
 IG::WP Texture::size(uint level) const
 {
 	uint w = pixDesc.w(), h = pixDesc.h();
@@ -17,6 +17,147 @@
 
 #include <imagine/gui/FSPicker.hh>
 #include <imagine/logger/logger.h>
+#include <imagine/base/Pipe.hh>
+#include <imagine/thread/Thread.hh>
+#include <imagine/io/FileIO.hh>
+#include <imagine/fs/FileCache.hh>
+
+// Directory listing shared between the picker and its enumeration thread
+
+struct FSPicker::ListingTask
+{
+	IG::Mutex mutex{};
+	Base::Pipe pipe{};
+	FilterFunc filter{};
+	FS::PathString path{};
+	FS::PathString cachePath{};
+	FS::file_time_type mTime{};
+	std::vector<FileEntry> pending{}; // sorted entries not yet received by the picker
+	bool canceled = false;
+	bool done = false;
+};
+
+static bool fileEntryCompare(const FSPicker::FileEntry &e1, const FSPicker::FileEntry &e2)
+{
+	return FS::fileStringNoCaseLexCompare()(e1.name, e2.name);
+}
+
+static bool fileItemCompare(const FSPicker::FileItem *i1, const FSPicker::FileItem *i2)
+{
+	return fileEntryCompare(i1->entry, i2->entry);
+}
+
+// Listing cache file format:
+// header: magic, mtime (int64), path length (uint16) + path, entry count (uint32)
+// entries: is directory (uint8), name length (uint16) + name
+// Files are evicted oldest first once the directory grows past listingCacheMaxSize.
+
+static const char listingCacheMagic[4] {'F', 'S', 'L', '1'};
+static constexpr off_t listingCacheMaxSize = 4 * 1024 * 1024;
+
+static FS::PathString listingCacheDir()
+{
+	return FileCache::dirPath(".fscache");
+}
+
+static FS::PathString listingCachePath(const char *name, const char *path)
+{
+	return FS::makePathStringPrintf("%s/%s-%016llx.lst", listingCacheDir().data(), name,
+		(unsigned long long)FileCache::fnv1a(path));
+}
+
+template <class T>
+static bool readCacheVal(const char *&data, const char *end, T &val)
+{
+	if(end - data < (ptrdiff_t)sizeof(T))
+		return false;
+	memcpy(&val, data, sizeof(T));
+	data += sizeof(T);
+	return true;
+}
+
+static bool readListingCache(const char *cachePath, const char *path, FS::file_time_type mTime,
+	std::vector<FSPicker::FileEntry> &entries)
+{
+	FileIO file;
+	if(file.open(cachePath) != OK)
+		return false;
+	auto size = file.size();
+	if(size < (ssize_t)sizeof(listingCacheMagic))
+		return false;
+	std::vector<char> buff(size);
+	if(file.readAll(buff.data(), size) != OK)
+		return false;
+	const char *data = buff.data(), *end = buff.data() + size;
+	if(memcmp(data, listingCacheMagic, sizeof(listingCacheMagic)) != 0)
+		return false;
+	data += sizeof(listingCacheMagic);
+	int64_t cacheMTime;
+	uint16 pathLen;
+	if(!readCacheVal(data, end, cacheMTime) || cacheMTime != (int64_t)mTime
+		|| !readCacheVal(data, end, pathLen) || pathLen != strlen(path)
+		|| end - data < pathLen || memcmp(data, path, pathLen) != 0)
+	{
+		return false;
+	}
+	data += pathLen;
+	uint32 count;
+	if(!readCacheVal(data, end, count))
+		return false;
+	entries.clear();
+	entries.reserve(count);
+	iterateTimes(count, i)
+	{
+		uint8 isDir;
+		uint16 nameLen;
+		if(!readCacheVal(data, end, isDir) || !readCacheVal(data, end, nameLen)
+			|| nameLen >= FS::FILE_STRING_SIZE || end - data < nameLen)
+		{
+			logWarn("truncated listing cache:%s", cachePath);
+			entries.clear();
+			return false;
+		}
+		FSPicker::FileEntry entry{};
+		memcpy(entry.name.data(), data, nameLen);
+		entry.isDir = isDir;
+		entries.emplace_back(entry);
+		data += nameLen;
+	}
+	return true;
+}
+
+template <class T>
+static void writeCacheVal(std::vector<char> &buff, T val)
+{
+	auto pos = buff.size();
+	buff.resize(pos + sizeof(T));
+	memcpy(&buff[pos], &val, sizeof(T));
+}
+
+static void writeListingCache(const char *cachePath, const char *path, FS::file_time_type mTime,
+	const std::vector<FSPicker::FileEntry> &entries)
+{
+	std::vector<char> buff{listingCacheMagic, listingCacheMagic + sizeof(listingCacheMagic)};
+	writeCacheVal(buff, (int64_t)mTime);
+	uint16 pathLen = strlen(path);
+	writeCacheVal(buff, pathLen);
+	buff.insert(buff.end(), path, path + pathLen);
+	writeCacheVal(buff, (uint32)entries.size());
+	for(auto &e : entries)
+	{
+		uint16 nameLen = strlen(e.name.data());
+		writeCacheVal(buff, (uint8)e.isDir);
+		writeCacheVal(buff, nameLen);
+		buff.insert(buff.end(), e.name.data(), e.name.data() + nameLen);
+	}
+	auto cacheDir = listingCacheDir();
+	FS::create_directory(cacheDir);
+	FileCache::evict(cacheDir.data(), "lst", listingCacheMaxSize, buff.size());
+	if(writeToNewFile(cachePath, buff.data(), buff.size()) != OK)
+	{
+		logErr("error writing listing cache:%s", cachePath);
+	}
+}
 
 // FSNavView
 
@@ -99,19 +240,11 @@ void FSPicker::init(Gfx::PixmapTexture *backRes, Gfx::PixmapTexture *closeRes, F
 
 void FSPicker::deinit()
 {
-	dir.clear();
+	cancelListing();
+	listingCacheName = nullptr;
+	clearItems();
 	navV.deinit();
 	tbl.deinit();
-	if(text)
-	{
-		mem_free(text);
-		text = nullptr;
-	}
-	if(textPtr)
-	{
-		mem_free(textPtr);
-		textPtr = nullptr;
-	}
 }
 
 void FSPicker::place()
@@ -158,6 +291,11 @@ void FSPicker::setOnPathReadError(OnPathReadError del)
 	onPathReadError = del;
 }
 
+void FSPicker::setListingCacheName(const char *name)
+{
+	listingCacheName = name;
+}
+
 void FSPicker::inputEvent(Input::Event e)
 {
 	if(e.isDefaultCancelButton() && e.state == Input::PUSHED)
@@ -199,74 +337,232 @@ CallResult FSPicker::setPath(const char *path, Input::Event e)
 	assert(path);
 	{
 		CallResult dirResult = OK;
-		auto dirIt = FS::directory_iterator{path, dirResult};
+		FS::directory_iterator{path, dirResult};
 		if(dirResult != OK)
 		{
 			logErr("can't open %s", path);
 			onPathReadError.callSafe(*this, dirResult);
 			return dirResult;
 		}
-		FS::current_path(path);
-		dir.clear();
-		for(auto &entry : dirIt)
+	}
+	FS::current_path(path);
+	cancelListing();
+	clearItems();
+	highlightFirstEntry = !e.isPointer();
+	auto dirPath = FS::current_path();
+	auto mTime = FS::status(dirPath).last_write_time();
+	FS::PathString cachePath{};
+	bool isCached = false;
+	if(listingCacheName)
+	{
+		cachePath = listingCachePath(listingCacheName, dirPath.data());
+		std::vector<FileEntry> entries;
+		// an empty cached listing is still valid, no need to scan the directory again
+		if(readListingCache(cachePath.data(), dirPath.data(), mTime, entries))
 		{
-			if(filter && !filter(entry))
-			{
-				continue;
-			}
-			dir.emplace_back(FS::makeFileString(entry.name()));
+			logMsg("using cached listing of %s with %d entries", dirPath.data(), (int)entries.size());
+			appendItems(entries);
+			isCached = true;
 		}
 	}
-	std::sort(dir.begin(), dir.end(), FS::fileStringNoCaseLexCompare());
-	if(dir.size())
+	tbl.init(textPtr.data(), textPtr.size());
+	if(highlightFirstEntry)
+		tbl.highlightCell(0);
+	if(!isCached)
+		startListing(dirPath, cachePath, mTime);
+	navV.setTitle(dirPath.data());
+	return OK;
+}
+
+void FSPicker::clearItems()
+{
+	for(auto &item : fileItem)
 	{
-		// TODO free old pointer on failure
-		text = mem_newRealloc(text, dir.size());
-		if(!text)
+		item.text.deinit();
+	}
+	tbl.init(nullptr, 0);
+	fileItem.clear();
+	dir.clear();
+	textPtr.clear();
+}
+
+void FSPicker::appendItems(std::vector<FileEntry> &entries)
+{
+	auto oldSize = dir.size();
+	for(auto &e : entries)
+	{
+		fileItem.emplace_back();
+		auto &item = fileItem.back();
+		item.entry = e;
+		item.text.init(item.entry.name.data(), 1, faceRes);
+		auto itemPtr = &item;
+		if(item.entry.isDir)
 		{
-			logMsg("out of memory loading directory");
-			Base::abort(); // TODO: handle without exiting
+			item.text.onSelect() = [this, itemPtr](TextMenuItem &, View &, Input::Event e)
+				{
+					assert(!singleDir);
+					// the item is destroyed by the directory change
+					auto name = itemPtr->entry.name;
+					logMsg("going to dir %s", name.data());
+					changeDirByInput(name.data(), e);
+				};
 		}
-		textPtr = mem_newRealloc(textPtr, dir.size());
-		if(!textPtr)
+		else
 		{
-			logMsg("out of memory loading directory");
-			Base::abort(); // TODO: handle without exiting
+			item.text.onSelect() = [this, itemPtr](TextMenuItem &, View &, Input::Event e)
+				{
+					onSelectFileD(*this, itemPtr->entry.name.data(), e);
+				};
 		}
-		iterateTimes(dir.size(), i)
+		dir.emplace_back(itemPtr);
+	}
+	std::inplace_merge(dir.begin(), dir.begin() + oldSize, dir.end(), fileItemCompare);
+	textPtr.resize(dir.size());
+	iterateTimes(dir.size(), i)
+	{
+		textPtr[i] = &dir[i]->text;
+	}
+}
+
+void FSPicker::startListing(FS::PathString path, FS::PathString cachePath, FS::file_time_type mTime)
+{
+	listing = std::make_shared<ListingTask>();
+	listing->filter = filter;
+	listing->path = path;
+	listing->cachePath = cachePath;
+	listing->mTime = mTime;
+	listing->pipe.init(
+		[this](Base::Pipe &pipe)
 		{
-			text[i].init(dir[i].data(), 1, faceRes);
-			textPtr[i] = &text[i];
-			if(FS::status(dir[i].data()).type() == FS::file_type::directory)
+			char buff[64];
+			while(pipe.hasData())
 			{
-				text[i].onSelect() = [this, i](TextMenuItem &, View &, Input::Event e)
-					{
-						assert(!singleDir);
-						logMsg("going to dir %s", dir[i].data());
-						changeDirByInput(dir[i].data(), e);
-					};
+				pipe.read(buff, sizeof(buff));
 			}
-			else
+			std::vector<FileEntry> entries;
+			listing->mutex.lock();
+			entries.swap(listing->pending);
+			bool done = listing->done;
+			listing->mutex.unlock();
+			if(entries.size())
+				addEntries(entries);
+			if(done)
+				logMsg("finished listing %s with %d entries", listing->path.data(), (int)dir.size());
+			return 1;
+		});
+	// pass the thread its own reference, runOnThread needs a trivially destructible function object
+	auto task = new std::shared_ptr<ListingTask>{listing};
+	IG::runOnThread(
+		[task]()
+		{
+			runListing(*task);
+			delete task;
+		});
+}
+
+void FSPicker::cancelListing()
+{
+	if(!listing)
+		return;
+	// the thread only touches the pipe while holding the lock and not canceled
+	listing->mutex.lock();
+	listing->canceled = true;
+	listing->pipe.deinit();
+	listing->mutex.unlock();
+	listing.reset();
+}
+
+void FSPicker::addEntries(std::vector<FileEntry> &entries)
+{
+	// merge the sorted batch, only the new items are compiled and the
+	// highlighted entry stays selected
+	FileItem *highlighted{};
+	int highlightIdx = tbl.highlightedCell();
+	if(!dir.size())
+		highlightIdx = highlightFirstEntry ? 0 : -1;
+	else if(highlightIdx >= 0)
+		highlighted = dir[highlightIdx];
+	auto oldItems = fileItem.size();
+	appendItems(entries);
+	for(auto it = fileItem.begin() + oldItems; it != fileItem.end(); ++it)
+	{
+		it->text.compile(projP);
+	}
+	tbl.setItems(textPtr.data(), textPtr.size());
+	if(highlighted)
+	{
+		highlightIdx = std::lower_bound(dir.begin(), dir.end(), highlighted, fileItemCompare) - dir.begin();
+	}
+	if(highlightIdx >= 0)
+		tbl.highlightCell(highlightIdx);
+	postDraw();
+}
+
+void FSPicker::runListing(std::shared_ptr<ListingTask> task)
+{
+	CallResult dirResult = OK;
+	auto dirIt = FS::directory_iterator{task->path.data(), dirResult};
+	if(dirResult != OK)
+	{
+		logErr("can't open %s", task->path.data());
+	}
+	std::vector<FileEntry> entries, batch;
+	uint batchSize = 64;
+	bool hasCachePath = strlen(task->cachePath.data());
+	auto postBatch =
+		[&](bool done)
+		{
+			std::sort(batch.begin(), batch.end(), fileEntryCompare);
+			if(hasCachePath)
+				entries.insert(entries.end(), batch.begin(), batch.end());
+			task->mutex.lock();
+			if(task->canceled)
+			{
+				task->mutex.unlock();
+				return false;
+			}
+			bool wake = !task->pending.size();
+			auto oldSize = task->pending.size();
+			task->pending.insert(task->pending.end(), batch.begin(), batch.end());
+			std::inplace_merge(task->pending.begin(), task->pending.begin() + oldSize, task->pending.end(), fileEntryCompare);
+			task->done = done;
+			if(wake || done)
 			{
-				text[i].onSelect() = [this, i](TextMenuItem &, View &, Input::Event e)
-					{
-						onSelectFileD(*this, dir[i].data(), e);
-					};
+				char msg = 0;
+				task->pipe.write(&msg, 1);
+			}
+			task->mutex.unlock();
+			batch.clear();
+			return true;
+		};
+	if(dirResult == OK)
+	{
+		for(auto &entry : dirIt)
+		{
+			if(task->filter && !task->filter(entry))
+			{
+				continue;
+			}
+			batch.emplace_back();
+			batch.back().name = FS::makeFileString(entry.name());
+			batch.back().isDir = entry.type() == FS::file_type::directory;
+			if(batch.size() == batchSize)
+			{
+				if(!postBatch(false))
+					return;
+				// the first entries arrive quickly, later ones in larger batches to limit re-layout
+				batchSize = std::min(batchSize * 2, 4096u);
 			}
 		}
 	}
-	else
+	if(!postBatch(true))
+		return;
+	// skip caching if the directory may still be changing within the timestamp's resolution
+	if(hasCachePath && dirResult == OK && std::time(nullptr) - task->mTime > 1)
 	{
-		mem_free(text);
-		text = nullptr;
-		mem_free(textPtr);
-		textPtr = nullptr;
+		std::sort(entries.begin(), entries.end(), fileEntryCompare);
+		writeListingCache(task->cachePath.data(), task->path.data(), task->mTime, entries);
 	}
-	tbl.init(textPtr, dir.size());
-	if(!e.isPointer())
-		tbl.highlightCell(0);
-	navV.setTitle(FS::current_path().data());
-	return OK;
 }
 
 CallResult FSPicker::setPath(const char *path)
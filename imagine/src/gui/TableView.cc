@@ -36,6 +36,21 @@ void TableView::init(MenuItem **item, uint items, _2DOrigin align)
 	selectedIsActivated = false;
 }
 
+void TableView::setItems(MenuItem **item, uint items)
+{
+	var_selfs(item);
+	cells_ = items;
+	if(selected >= cells_)
+		selected = -1;
+	if(cells_)
+	{
+		setYCellSize(IG::makeEvenRoundedUp(item[0]->ySize()*2));
+		visibleCells = IG::divRoundUp(viewRect().ySize(), yCellSize) + 1;
+	}
+	else
+		visibleCells = 0;
+}
+
 void TableView::deinit()
 {
 	iterateTimes(cells_, i)
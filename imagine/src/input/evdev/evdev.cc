@@ -376,6 +376,16 @@ static bool processDevNode(const char *path, int id, bool notify)
 		string_copy(evDev->name, "Unknown");
 	}
 	bool isJoystick = evDev->setupJoystickBits();
+	#ifdef EVIOCSCLOCKID
+	{
+		// timestamp events with the same clock as IG::Time::now() so latency can be measured
+		int clockId = CLOCK_MONOTONIC;
+		if(ioctl(fd, EVIOCSCLOCKID, &clockId) < 0)
+		{
+			logWarn("unable to set monotonic event clock");
+		}
+	}
+	#endif
 
 	fd_setNonblock(fd, 1);
 	evDev->addPollEvent();
@@ -17,7 +17,15 @@
 #include <imagine/base/Base.hh>
 #include <imagine/fs/FS.hh>
 #include <imagine/logger/logger.h>
+#include <imagine/thread/Thread.hh>
+#include <atomic>
+#include <chrono>
+#include <thread>
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstddef>
+#include <cstdint>
 
 #ifdef __ANDROID__
 #include <android/log.h>
@@ -28,6 +36,13 @@
 #include <unistd.h>
 #endif
 
+// Messages are captured as a copy of the format string plus the raw argument
+// values into a lock-free ring owned by the logging thread, and formatted
+// and written out by a background thread. The caller only walks the format
+// string to know what to copy. The format and any string arguments are
+// copied since callers may pass runtime-built strings that don't outlive
+// the call.
+
 static const bool bufferLogLineOutput = Config::envIsAndroid || Config::envIsIOS;
 static char logLineBuffer[512]{};
 uint loggerVerbosity = loggerMaxVerbosity;
@@ -35,6 +50,557 @@ static const bool useExternalLogFile = false;
 static FILE *logExternalFile{};
 static bool logEnabled = Config::DEBUG_BUILD; // default logging off in release builds
 
+namespace
+{
+
+enum ArgType : uint8_t
+{
+	ARG_INT, ARG_LONG, ARG_LLONG, ARG_SIZE, ARG_INTMAX, ARG_PTRDIFF,
+	ARG_PTR, ARG_DOUBLE, ARG_LDOUBLE, ARG_STR, ARG_UNSUPPORTED
+};
+
+struct FormatSpec
+{
+	const char *start; // the '%'
+	const char *end; // one past the conversion character
+	uint stars; // '*' width/precision arguments before the value
+	ArgType type;
+};
+
+struct RecordHeader
+{
+	uint32_t size; // whole record
+	uint32_t severity;
+	uint64_t seq;
+	uint32_t msgSize; // aligned size of the format string after the header, 0 in padding records
+};
+
+static constexpr uint RING_SIZE = 32 * 1024;
+static constexpr uint MAX_RECORD_SIZE = 2048;
+static constexpr uint SLOT_ALIGN = 8;
+
+struct LogRing
+{
+	char buff[RING_SIZE];
+	std::atomic<uint32_t> head{}; // written by the consumer
+	std::atomic<uint32_t> tail{}; // written by the owning thread
+	std::atomic<bool> claimed{};
+	LogRing *next{};
+};
+
+}
+
+static std::atomic<LogRing*> rings{};
+static std::atomic<uint64_t> nextSeq{1};
+static std::atomic<uint32_t> droppedMsgs{};
+static std::atomic<bool> threadRunning{};
+
+static constexpr uint32_t alignSlot(uint32_t size)
+{
+	return (size + SLOT_ALIGN - 1) & ~(SLOT_ALIGN - 1);
+}
+
+static bool parseFormatSpec(const char *p, FormatSpec &spec)
+{
+	spec.start = p++;
+	spec.stars = 0;
+	while(strchr("-+ #0'", *p) && *p)
+		p++;
+	if(*p == '*')
+	{
+		spec.stars++;
+		p++;
+	}
+	else
+	{
+		while(*p >= '0' && *p <= '9')
+			p++;
+		if(*p == '$')
+			return false; // positional arguments unsupported
+	}
+	if(*p == '.')
+	{
+		p++;
+		if(*p == '*')
+		{
+			spec.stars++;
+			p++;
+		}
+		else
+		{
+			while(*p >= '0' && *p <= '9')
+				p++;
+		}
+	}
+	ArgType intType = ARG_INT;
+	bool longDouble = false, wide = false;
+	switch(*p)
+	{
+		case 'h':
+			p++;
+			if(*p == 'h')
+				p++;
+			break;
+		case 'l':
+			p++;
+			intType = ARG_LONG;
+			wide = true;
+			if(*p == 'l')
+			{
+				p++;
+				intType = ARG_LLONG;
+			}
+			break;
+		case 'q': p++; intType = ARG_LLONG; break;
+		case 'L': p++; longDouble = true; break;
+		case 'z': p++; intType = ARG_SIZE; break;
+		case 'j': p++; intType = ARG_INTMAX; break;
+		case 't': p++; intType = ARG_PTRDIFF; break;
+	}
+	switch(*p)
+	{
+		case 'd': case 'i': case 'u': case 'x': case 'X': case 'o':
+			spec.type = intType;
+			break;
+		case 'c':
+			spec.type = wide ? ARG_UNSUPPORTED : ARG_INT;
+			break;
+		case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+			spec.type = longDouble ? ARG_LDOUBLE : ARG_DOUBLE;
+			break;
+		case 'p':
+			spec.type = ARG_PTR;
+			break;
+		case 's':
+			spec.type = wide ? ARG_UNSUPPORTED : ARG_STR;
+			break;
+		default:
+			return false;
+	}
+	spec.end = p + 1;
+	return spec.type != ARG_UNSUPPORTED;
+}
+
+// calls func(spec) for each conversion, returns false on one it can't handle
+template <class Func>
+static bool forEachFormatSpec(const char *msg, Func func)
+{
+	for(auto p = strchr(msg, '%'); p; p = strchr(p, '%'))
+	{
+		if(p[1] == '%')
+		{
+			p += 2;
+			continue;
+		}
+		FormatSpec spec;
+		if(!parseFormatSpec(p, spec))
+			return false;
+		func(spec);
+		p = spec.end;
+	}
+	return true;
+}
+
+static uint32_t argSize(ArgType type)
+{
+	switch(type)
+	{
+		case ARG_INT: return sizeof(int);
+		case ARG_LONG: return sizeof(long);
+		case ARG_LLONG: return sizeof(long long);
+		case ARG_SIZE: return sizeof(size_t);
+		case ARG_INTMAX: return sizeof(intmax_t);
+		case ARG_PTRDIFF: return sizeof(ptrdiff_t);
+		case ARG_PTR: return sizeof(void*);
+		case ARG_DOUBLE: return sizeof(double);
+		case ARG_LDOUBLE: return sizeof(long double);
+		default: return 0;
+	}
+}
+
+// Walks msg's arguments, adding up the payload size when dest is null or
+// copying them to dest, returns -1 if msg can't be captured
+static int captureArgs(char *dest, const char *msg, va_list args)
+{
+	int size = 0;
+	auto putSlot =
+		[&](const void *data, uint32_t bytes)
+		{
+			if(dest)
+				memcpy(dest + size, data, bytes);
+			size += alignSlot(bytes);
+		};
+	bool ok = forEachFormatSpec(msg,
+		[&](const FormatSpec &spec)
+		{
+			iterateTimes(spec.stars, i)
+			{
+				int val = va_arg(args, int);
+				putSlot(&val, sizeof(val));
+			}
+			switch(spec.type)
+			{
+				#define CAPTURE_ARG(argType, cType) \
+				case argType: { cType val = va_arg(args, cType); putSlot(&val, sizeof(val)); break; }
+				CAPTURE_ARG(ARG_INT, int)
+				CAPTURE_ARG(ARG_LONG, long)
+				CAPTURE_ARG(ARG_LLONG, long long)
+				CAPTURE_ARG(ARG_SIZE, size_t)
+				CAPTURE_ARG(ARG_INTMAX, intmax_t)
+				CAPTURE_ARG(ARG_PTRDIFF, ptrdiff_t)
+				CAPTURE_ARG(ARG_PTR, void*)
+				CAPTURE_ARG(ARG_DOUBLE, double)
+				CAPTURE_ARG(ARG_LDOUBLE, long double)
+				#undef CAPTURE_ARG
+				case ARG_STR:
+				{
+					auto str = va_arg(args, const char*);
+					if(!str)
+						str = "(null)";
+					uint32_t len = strlen(str);
+					putSlot(&len, sizeof(len));
+					putSlot(str, len + 1);
+					break;
+				}
+				default:
+					break;
+			}
+		});
+	return ok ? size : -1;
+}
+
+template <class T>
+static int printArg(char *out, size_t outSize, const char *spec, uint stars, const int *starVal, T val)
+{
+	#pragma GCC diagnostic push
+	#pragma GCC diagnostic ignored "-Wformat-nonliteral"
+	switch(stars)
+	{
+		case 0: return snprintf(out, outSize, spec, val);
+		case 1: return snprintf(out, outSize, spec, starVal[0], val);
+		default: return snprintf(out, outSize, spec, starVal[0], starVal[1], val);
+	}
+	#pragma GCC diagnostic pop
+}
+
+// Formats a captured record, mirrors captureArgs()
+static void formatRecord(char *out, size_t outSize, const char *msg, const char *payload)
+{
+	size_t len = 0;
+	auto append =
+		[&](int written)
+		{
+			if(written > 0)
+				len = std::min(len + written, outSize - 1);
+		};
+	auto getSlot =
+		[&](void *data, uint32_t bytes)
+		{
+			memcpy(data, payload, bytes);
+			payload += alignSlot(bytes);
+		};
+	const char *literal = msg;
+	forEachFormatSpec(msg,
+		[&](const FormatSpec &spec)
+		{
+			append(snprintf(out + len, outSize - len, "%.*s", (int)(spec.start - literal), literal));
+			literal = spec.end;
+			char specStr[32];
+			uint specLen = std::min<size_t>(spec.end - spec.start, sizeof(specStr) - 1);
+			memcpy(specStr, spec.start, specLen);
+			specStr[specLen] = 0;
+			int starVal[2]{};
+			iterateTimes(spec.stars, i)
+			{
+				getSlot(&starVal[i], sizeof(int));
+			}
+			switch(spec.type)
+			{
+				#define PRINT_ARG(argType, cType) \
+				case argType: { cType val; getSlot(&val, sizeof(val)); \
+					append(printArg(out + len, outSize - len, specStr, spec.stars, starVal, val)); break; }
+				PRINT_ARG(ARG_INT, int)
+				PRINT_ARG(ARG_LONG, long)
+				PRINT_ARG(ARG_LLONG, long long)
+				PRINT_ARG(ARG_SIZE, size_t)
+				PRINT_ARG(ARG_INTMAX, intmax_t)
+				PRINT_ARG(ARG_PTRDIFF, ptrdiff_t)
+				PRINT_ARG(ARG_PTR, void*)
+				PRINT_ARG(ARG_DOUBLE, double)
+				PRINT_ARG(ARG_LDOUBLE, long double)
+				#undef PRINT_ARG
+				case ARG_STR:
+				{
+					uint32_t strLen;
+					getSlot(&strLen, sizeof(strLen));
+					append(printArg(out + len, outSize - len, specStr, spec.stars, starVal, payload));
+					payload += alignSlot(strLen + 1);
+					break;
+				}
+				default:
+					break;
+			}
+		});
+	// remaining literal text, with "%%" handled by printf
+	#pragma GCC diagnostic push
+	#pragma GCC diagnostic ignored "-Wformat-nonliteral"
+	#pragma GCC diagnostic ignored "-Wformat-security"
+	if(strchr(literal, '%'))
+		append(snprintf(out + len, outSize - len, literal));
+	else
+		append(snprintf(out + len, outSize - len, "%s", literal));
+	#pragma GCC diagnostic pop
+}
+
+static LogRing *claimRing()
+{
+	for(auto ring = rings.load(std::memory_order_acquire); ring; ring = ring->next)
+	{
+		// reuse a ring left by an exited thread once it's drained
+		bool claimed = false;
+		if(!ring->claimed.load(std::memory_order_relaxed)
+			&& ring->head.load(std::memory_order_acquire) == ring->tail.load(std::memory_order_relaxed)
+			&& ring->claimed.compare_exchange_strong(claimed, true, std::memory_order_acquire))
+		{
+			return ring;
+		}
+	}
+	auto ring = new LogRing;
+	ring->claimed.store(true, std::memory_order_relaxed);
+	ring->next = rings.load(std::memory_order_relaxed);
+	while(!rings.compare_exchange_weak(ring->next, ring, std::memory_order_release)) {}
+	return ring;
+}
+
+namespace
+{
+
+struct ThreadRing
+{
+	LogRing *ring{};
+
+	LogRing &get()
+	{
+		if(unlikely(!ring))
+			ring = claimRing();
+		return *ring;
+	}
+
+	~ThreadRing()
+	{
+		if(ring)
+			ring->claimed.store(false, std::memory_order_release);
+	}
+};
+
+}
+
+static thread_local ThreadRing threadRing;
+
+static constexpr uint32_t recordHeaderSize = alignSlot(sizeof(RecordHeader));
+
+static char *reserveRecord(LogRing &ring, uint32_t size, uint32_t &newTail)
+{
+	auto tail = ring.tail.load(std::memory_order_relaxed);
+	auto head = ring.head.load(std::memory_order_acquire);
+	uint32_t pos = tail % RING_SIZE;
+	uint32_t pad = RING_SIZE - pos < size ? RING_SIZE - pos : 0;
+	if(tail + pad + size - head > RING_SIZE)
+		return nullptr;
+	if(pad >= recordHeaderSize)
+	{
+		// mark the unused end of the buffer, shorter gaps are skipped implicitly
+		RecordHeader padding{pad, 0, 0, 0};
+		memcpy(&ring.buff[pos], &padding, sizeof(padding));
+	}
+	newTail = tail + pad + size;
+	return &ring.buff[(tail + pad) % RING_SIZE];
+}
+
+static bool pushRecord(LogRing &ring, LoggerSeverity severity, const char *msg, va_list args)
+{
+	va_list sizeArgs;
+	va_copy(sizeArgs, args);
+	int payloadSize = captureArgs(nullptr, msg, sizeArgs);
+	va_end(sizeArgs);
+	uint32_t msgLen = strlen(msg);
+	char text[512];
+	bool preformatted = false;
+	if(payloadSize < 0 || alignSlot(msgLen + 1) + payloadSize > MAX_RECORD_SIZE)
+	{
+		// a conversion that can't be captured or too much data, format it here
+		vsnprintf(text, sizeof(text), msg, args);
+		msg = "%s";
+		msgLen = 2;
+		payloadSize = alignSlot(sizeof(uint32_t)) + alignSlot(strlen(text) + 1);
+		preformatted = true;
+	}
+	uint32_t msgSize = alignSlot(msgLen + 1);
+	uint32_t size = recordHeaderSize + msgSize + payloadSize;
+	uint32_t newTail;
+	auto rec = reserveRecord(ring, size, newTail);
+	if(!rec)
+	{
+		droppedMsgs.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+	RecordHeader header{size, severity, nextSeq.fetch_add(1, std::memory_order_relaxed), msgSize};
+	memcpy(rec, &header, sizeof(header));
+	memcpy(rec + recordHeaderSize, msg, msgLen + 1);
+	auto payload = rec + recordHeaderSize + msgSize;
+	if(preformatted)
+	{
+		uint32_t len = strlen(text);
+		memcpy(payload, &len, sizeof(len));
+		memcpy(payload + alignSlot(sizeof(len)), text, len + 1);
+	}
+	else
+	{
+		va_list copyArgs;
+		va_copy(copyArgs, args);
+		captureArgs(payload, msg, copyArgs);
+		va_end(copyArgs);
+	}
+	ring.tail.store(newTail, std::memory_order_release);
+	return true;
+}
+
+static void printToLogLineBuffer(const char *str)
+{
+	auto len = strlen(logLineBuffer);
+	string_copy(logLineBuffer + len, str, sizeof(logLineBuffer) - len);
+}
+
+static void writeOutput(const char *str)
+{
+	if(logExternalFile)
+	{
+		fputs(str, logExternalFile);
+		fflush(logExternalFile);
+	}
+
+	if(bufferLogLineOutput && !strchr(str, '\n'))
+	{
+		printToLogLineBuffer(str);
+		return;
+	}
+
+	#ifdef __ANDROID__
+	if(strlen(logLineBuffer))
+	{
+		printToLogLineBuffer(str);
+		__android_log_write(ANDROID_LOG_INFO, "imagine", logLineBuffer);
+		logLineBuffer[0] = 0;
+	}
+	else
+		__android_log_write(ANDROID_LOG_INFO, "imagine", str);
+	#elif defined __APPLE__
+	if(strlen(logLineBuffer))
+	{
+		printToLogLineBuffer(str);
+		asl_log(nullptr, nullptr, ASL_LEVEL_NOTICE, "%s", logLineBuffer);
+		logLineBuffer[0] = 0;
+	}
+	else
+		asl_log(nullptr, nullptr, ASL_LEVEL_NOTICE, "%s", str);
+	#else
+	fputs(str, stderr);
+	#endif
+}
+
+// Returns the next record in ring or null if it's empty, skipping padding
+static const RecordHeader *peekRecord(LogRing &ring, uint32_t &head)
+{
+	head = ring.head.load(std::memory_order_relaxed);
+	auto tail = ring.tail.load(std::memory_order_acquire);
+	while(head != tail)
+	{
+		uint32_t pos = head % RING_SIZE;
+		if(RING_SIZE - pos < recordHeaderSize)
+		{
+			head += RING_SIZE - pos;
+			continue;
+		}
+		auto rec = (const RecordHeader*)&ring.buff[pos];
+		if(!rec->msgSize)
+		{
+			head += rec->size;
+			continue;
+		}
+		return rec;
+	}
+	return nullptr;
+}
+
+// Writes out all captured records in the order they were logged,
+// returns false if there were none
+static bool drainRecords()
+{
+	bool wroteAny = false;
+	for(;;)
+	{
+		if(auto dropped = droppedMsgs.exchange(0, std::memory_order_relaxed))
+		{
+			char str[64];
+			snprintf(str, sizeof(str), "LoggerStdio: dropped %u messages\n", dropped);
+			writeOutput(str);
+		}
+		LogRing *nextRing{};
+		const RecordHeader *nextRec{};
+		uint32_t nextHead = 0;
+		for(auto ring = rings.load(std::memory_order_acquire); ring; ring = ring->next)
+		{
+			uint32_t head;
+			auto rec = peekRecord(*ring, head);
+			if(rec && (!nextRec || rec->seq < nextRec->seq))
+			{
+				nextRing = ring;
+				nextRec = rec;
+				nextHead = head;
+			}
+		}
+		if(!nextRec)
+			return wroteAny;
+		if(nextRec->severity <= loggerVerbosity)
+		{
+			char str[1024];
+			auto msg = (const char*)nextRec + recordHeaderSize;
+			formatRecord(str, sizeof(str), msg, msg + nextRec->msgSize);
+			writeOutput(str);
+		}
+		nextRing->head.store(nextHead + nextRec->size, std::memory_order_release);
+		wroteAny = true;
+	}
+}
+
+static void runLogThread()
+{
+	for(;;)
+	{
+		if(!drainRecords())
+			std::this_thread::sleep_for(std::chrono::milliseconds(4));
+	}
+}
+
+static void waitForRingDrain(LogRing &ring)
+{
+	// give up eventually in case the log thread is stuck on slow output
+	iterateTimes(500, i)
+	{
+		if(ring.head.load(std::memory_order_acquire) == ring.tail.load(std::memory_order_relaxed))
+			return;
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+}
+
+static void waitForAllRingsDrain()
+{
+	for(auto ring = rings.load(std::memory_order_acquire); ring; ring = ring->next)
+	{
+		waitForRingDrain(*ring);
+	}
+}
+
 static FS::PathString externalLogPath()
 {
 	FS::PathString path{};
@@ -66,6 +632,11 @@ CallResult logger_init()
 			return IO_ERROR;
 		}
 	}
+	if(!threadRunning.exchange(true))
+	{
+		IG::runOnThread([](){ runLogThread(); });
+		atexit(waitForAllRingsDrain);
+	}
 	//logMsg("init logger");
 	return OK;
 }
@@ -84,53 +655,28 @@ bool logger_isEnabled()
 	return logEnabled;
 }
 
-static void printToLogLineBuffer(const char* msg, va_list args)
-{
-	vsnprintf(logLineBuffer + strlen(logLineBuffer), sizeof(logLineBuffer) - strlen(logLineBuffer), msg, args);
-}
-
 void logger_vprintf(LoggerSeverity severity, const char* msg, va_list args)
 {
 	if(!logEnabled)
 		return;
 	if(severity > loggerVerbosity) return;
 
-	if(logExternalFile)
-	{
-		va_list args2;
-		va_copy(args2, args);
-		vfprintf(logExternalFile, msg, args2);
-		va_end(args2);
-		fflush(logExternalFile);
-	}
-
-	if(bufferLogLineOutput && !strchr(msg, '\n'))
+	if(unlikely(!threadRunning.load(std::memory_order_relaxed)))
 	{
-		printToLogLineBuffer(msg, args);
+		// before logger_init(), only the main thread is running
+		char str[1024];
+		vsnprintf(str, sizeof(str), msg, args);
+		writeOutput(str);
 		return;
 	}
 
-	#ifdef __ANDROID__
-	if(strlen(logLineBuffer))
+	auto &ring = threadRing.get();
+	pushRecord(ring, severity, msg, args);
+	if(severity == LOG_E)
 	{
-		printToLogLineBuffer(msg, args);
-		__android_log_write(ANDROID_LOG_INFO, "imagine", logLineBuffer);
-		logLineBuffer[0] = 0;
-	}
-	else
-		__android_log_vprint(ANDROID_LOG_INFO, "imagine", msg, args);
-	#elif defined __APPLE__
-	if(strlen(logLineBuffer))
-	{
-		printToLogLineBuffer(msg, args);
-		asl_log(nullptr, nullptr, ASL_LEVEL_NOTICE, "%s", logLineBuffer);
-		logLineBuffer[0] = 0;
+		// errors often come right before an abort, make sure they're out
+		waitForRingDrain(ring);
 	}
-	else
-		asl_vlog(nullptr, nullptr, ASL_LEVEL_NOTICE, msg, args);
-	#else
-	vfprintf(stderr, msg, args);
-	#endif
 }
 
 void logger_printf(LoggerSeverity severity, const char* msg, ...)
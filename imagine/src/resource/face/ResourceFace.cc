@@ -19,6 +19,7 @@
 #include <imagine/util/bits.h>
 #include <imagine/resource/face/ResourceFace.hh>
 #include <imagine/logger/logger.h>
+#include <algorithm>
 
 #ifdef CONFIG_RESOURCE_FONT_FREETYPE
 #include <imagine/resource/font/ResourceFontFreetype.hh>
@@ -42,22 +43,70 @@ static const uint unicodeBmpUsedChars = unicodeBmpChars - unicodeBmpPrivateChars
 
 static const uint glyphTableEntries = ResourceFace::supportsUnicode ? unicodeBmpUsedChars : numDrawableAsciiChars;
 
+static const uint glyphTablePageEntries = 1 << ResourceFace::GLYPH_TABLE_PAGE_BITS;
+static_assert((glyphTableEntries + glyphTablePageEntries - 1) / glyphTablePageEntries <= ResourceFace::GLYPH_TABLE_PAGES,
+	"glyph table has too many pages");
+
+static uint glyphTablePageSize(uint page)
+{
+	return std::min(glyphTablePageEntries, glyphTableEntries - page * glyphTablePageEntries);
+}
+
 static CallResult mapCharToTable(uint c, uint &tableIdx);
 
 bool ResourceFace::initGlyphTable()
 {
-	logMsg("allocating glyph table, %d entries", glyphTableEntries);
-	mem_free(glyphTable);
-	glyphTable = (GlyphEntry*)mem_calloc(1, sizeof(GlyphEntry) * glyphTableEntries);
-	if(!glyphTable)
-	{
-		logErr("out of memory");
-		return false;
-	}
+	// pages are allocated when a character in their range is first used
+	freeGlyphTable();
 	usedGlyphTableBits = 0;
 	return true;
 }
 
+void ResourceFace::freeGlyphTable()
+{
+	for(auto &page : glyphTable)
+	{
+		if(page)
+		{
+			mem_free(page);
+			page = nullptr;
+		}
+	}
+}
+
+void ResourceFace::deinitGlyphs()
+{
+	iterateTimes(GLYPH_TABLE_PAGES, p)
+	{
+		if(!glyphTable[p])
+			continue;
+		iterateTimes(glyphTablePageSize(p), i)
+		{
+			glyphTable[p][i].glyph.deinit();
+		}
+	}
+}
+
+GlyphEntry *ResourceFace::glyphTableEntry(uint tableIdx, bool alloc)
+{
+	assert(tableIdx < glyphTableEntries);
+	uint pageIdx = tableIdx >> GLYPH_TABLE_PAGE_BITS;
+	auto &page = glyphTable[pageIdx];
+	if(!page)
+	{
+		if(!alloc)
+			return nullptr;
+		logMsg("allocating glyph table page %d, %d entries", pageIdx, glyphTablePageSize(pageIdx));
+		page = (GlyphEntry*)mem_calloc(1, sizeof(GlyphEntry) * glyphTablePageSize(pageIdx));
+		if(!page)
+		{
+			logErr("out of memory");
+			return nullptr;
+		}
+	}
+	return &page[tableIdx & (glyphTablePageEntries - 1)];
+}
+
 void ResourceFace::freeCaches(uint32 purgeBits)
 {
 	auto tableBits = usedGlyphTableBits;
@@ -75,7 +124,8 @@ void ResourceFace::freeCaches(uint32 purgeBits)
 					//logMsg( "%c not a known drawable character, skipping", c);
 					continue;
 				}
-				glyphTable[tableIdx].glyph.deinit();
+				if(auto entry = glyphTableEntry(tableIdx, false))
+					entry->glyph.deinit();
 			}
 			unsetBits(usedGlyphTableBits, IG::bit(i));
 		}
@@ -173,11 +223,8 @@ ResourceFace *ResourceFace::create(ResourceFont *font, FontSettings *set)
 void ResourceFace::free()
 {
 	font->freeSize(faceSize);
-	iterateTimes(glyphTableEntries, i)
-	{
-		glyphTable[i].glyph.deinit();
-	}
-	mem_free(glyphTable);
+	deinitGlyphs();
+	freeGlyphTable();
 	delete this;
 }
 
@@ -211,10 +258,7 @@ CallResult ResourceFace::applySettings(FontSettings set)
 		{
 			logMsg("flushing glyph cache");
 			font->freeSize(faceSize);
-			iterateTimes(glyphTableEntries, i)
-			{
-				glyphTable[i].glyph.deinit();
-			}
+			deinitGlyphs();
 		}
 
 		settings = set;
@@ -251,9 +295,9 @@ CallResult ResourceFace::writeCurrentChar(IG::Pixmap &out)
 	return OK;
 }
 
-CallResult ResourceFace::cacheChar(int c, int tableIdx)
+CallResult ResourceFace::cacheChar(int c, GlyphEntry &entry)
 {
-	if(glyphTable[tableIdx].metrics.ySize == -1)
+	if(entry.metrics.ySize == -1)
 	{
 		// failed to previously cache char
 		return INVALID_PARAMETER;
@@ -263,13 +307,12 @@ CallResult ResourceFace::cacheChar(int c, int tableIdx)
 	if(font->activeChar(c, metrics) != OK)
 	{
 		// mark failed attempt
-		glyphTable[tableIdx].metrics.ySize = -1;
+		entry.metrics.ySize = -1;
 		return INVALID_PARAMETER;
 	}
-	//logMsg("setting up table entry %d", tableIdx);
-	glyphTable[tableIdx].metrics = metrics;
-	auto img = GfxGlyphImage(this, &glyphTable[tableIdx]);
-	glyphTable[tableIdx].glyph.init(img, false);
+	entry.metrics = metrics;
+	auto img = GfxGlyphImage(this, &entry);
+	entry.glyph.init(img, false);
 	usedGlyphTableBits |= IG::bit((c >> 11) & 0x1F); // use upper 5 BMP plane bits to map in range 0-31
 	//logMsg("used table bits 0x%X", usedGlyphTableBits);
 	return OK;
@@ -323,14 +366,17 @@ CallResult ResourceFace::precache(const char *string)
 			//logMsg( "%c not a known drawable character, skipping", c);
 			continue;
 		}
-		if(glyphTable[tableIdx].glyph)
+		auto entry = glyphTableEntry(tableIdx, true);
+		if(!entry)
+			return OUT_OF_MEMORY;
+		if(entry->glyph)
 		{
 			//logMsg( "%c already cached", c);
 			continue;
 		}
 
 		logMsg("precaching char %c", c);
-		cacheChar(c, tableIdx);
+		cacheChar(c, *entry);
 	}
 	return OK;
 }
@@ -341,16 +387,18 @@ GlyphEntry *ResourceFace::glyphEntry(int c)
 	uint tableIdx;
 	if(mapCharToTable(c, tableIdx) != OK)
 		return nullptr;
-	assert(tableIdx < glyphTableEntries);
-	if(!glyphTable[tableIdx].glyph)
+	auto entry = glyphTableEntry(tableIdx, true);
+	if(!entry)
+		return nullptr;
+	if(!entry->glyph)
 	{
 		font->applySize(faceSize);
-		if(cacheChar(c, tableIdx) != OK)
+		if(cacheChar(c, *entry) != OK)
 			return nullptr;
 		logMsg("char 0x%X was not in table, cached", c);
 	}
 
-	return &glyphTable[tableIdx];
+	return entry;
 }
 
 CallResult GfxGlyphImage::write(IG::Pixmap &dest)
@@ -61,4 +61,9 @@ void ConditionVar::notify_one()
 	pthread_cond_signal(&cond);
 }
 
+void ConditionVar::notify_all()
+{
+	pthread_cond_broadcast(&cond);
+}
+
 }
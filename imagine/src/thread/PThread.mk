@@ -1,6 +1,6 @@
 ifndef inc_thread_pthread
 inc_thread_pthread := 1
 
-SRC += thread/PThread.cc
+SRC += thread/PThread.cc thread/TaskPool.cc thread/Scheduling.cc
 
 endif
@@ -0,0 +1,209 @@
+/*  This file is part of Imagine.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Imagine.  If not, see <http://www.gnu.org/licenses/> */
+
+#define LOGTAG "Sched"
+#include <imagine/thread/Scheduling.hh>
+#include <imagine/logger/logger.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#ifdef CONFIG_THREAD_SCHEDULING_HINTS
+#include <sched.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#endif
+
+namespace IG
+{
+
+static CPUTopology topology{};
+static bool topologyRead = false;
+
+#ifdef CONFIG_THREAD_SCHEDULING_HINTS
+static constexpr uint MAX_CPUS = 64;
+
+static uint readMaxFreq(uint cpu)
+{
+	char path[64];
+	snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u/cpufreq/cpuinfo_max_freq", cpu);
+	auto file = fopen(path, "r");
+	if(!file)
+		return 0;
+	uint freq = 0;
+	if(fscanf(file, "%u", &freq) != 1)
+		freq = 0;
+	fclose(file);
+	return freq;
+}
+
+const CPUTopology &cpuTopology()
+{
+	if(topologyRead)
+		return topology;
+	topologyRead = true;
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	if(sched_getaffinity(0, sizeof(set), &set) != 0)
+	{
+		logErr("unable to get CPU affinity");
+		return topology;
+	}
+	uint freq[MAX_CPUS]{};
+	uint minFreq = UINT32_MAX, maxFreq = 0;
+	iterateTimes(MAX_CPUS, i)
+	{
+		if(!CPU_ISSET(i, &set))
+			continue;
+		topology.online |= (CPUMask)1 << i;
+		topology.cpus++;
+		freq[i] = readMaxFreq(i);
+		if(freq[i])
+		{
+			minFreq = std::min(minFreq, freq[i]);
+			maxFreq = std::max(maxFreq, freq[i]);
+		}
+	}
+	if(!maxFreq || minFreq == maxFreq)
+	{
+		topology.performance = topology.online;
+		logMsg("%u CPUs with uniform performance", topology.cpus);
+		return topology;
+	}
+	iterateTimes(MAX_CPUS, i)
+	{
+		if(freq[i] == maxFreq)
+			topology.performance |= (CPUMask)1 << i;
+		else if(freq[i] == minFreq)
+			topology.efficiency |= (CPUMask)1 << i;
+	}
+	logMsg("%u CPUs, performance mask:0x%llX (%uMHz) efficiency mask:0x%llX (%uMHz)",
+		topology.cpus, (unsigned long long)topology.performance, maxFreq / 1000,
+		(unsigned long long)topology.efficiency, minFreq / 1000);
+	return topology;
+}
+
+static bool setNiceValue(int nice)
+{
+	// RLIMIT_NICE may refuse raising it as well, in which case the thread stays as is
+	pid_t tid = syscall(SYS_gettid);
+	if(setpriority(PRIO_PROCESS, tid, nice) != 0)
+	{
+		logWarn("unable to set nice value %d of thread %d", nice, (int)tid);
+		return false;
+	}
+	logMsg("set nice value %d of thread %d", nice, (int)tid);
+	return true;
+}
+
+static bool raiseNiceValue()
+{
+	return setNiceValue(-10);
+}
+
+bool applySchedulingHint(const SchedulingHint &hint)
+{
+	bool ok = true;
+	auto &topo = cpuTopology();
+	CPUMask mask = hint.cpus & topo.online;
+	if(hint.cpus && !mask)
+		logWarn("CPU mask:0x%llX has no online CPUs, ignoring it", (unsigned long long)hint.cpus);
+	if(!mask)
+		mask = topo.online;
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	iterateTimes(MAX_CPUS, i)
+	{
+		if(mask & ((CPUMask)1 << i))
+			CPU_SET(i, &set);
+	}
+	// pid 0 refers to the calling thread with the Linux syscalls
+	if(sched_setaffinity(0, sizeof(set), &set) != 0)
+	{
+		logWarn("unable to set CPU mask:0x%llX", (unsigned long long)mask);
+		ok = false;
+	}
+	if(hint.policy == ThreadPolicy::NORMAL)
+	{
+		sched_param param{};
+		if(sched_setscheduler(0, SCHED_OTHER | SCHED_RESET_ON_FORK, &param) != 0)
+		{
+			logWarn("unable to reset to SCHED_OTHER");
+			ok = false;
+		}
+		// undo a nice value set by raiseNiceValue() in an earlier hint
+		if(getpriority(PRIO_PROCESS, syscall(SYS_gettid)) != 0 && !setNiceValue(0))
+			ok = false;
+		return ok;
+	}
+	int policy = hint.policy == ThreadPolicy::FIFO ? SCHED_FIFO : SCHED_RR;
+	int minPrio = sched_get_priority_min(policy);
+	int maxPrio = sched_get_priority_max(policy);
+	if(geteuid() != 0)
+	{
+		rlimit limit{};
+		if(getrlimit(RLIMIT_RTPRIO, &limit) == 0 && limit.rlim_cur != RLIM_INFINITY)
+			maxPrio = std::min(maxPrio, (int)limit.rlim_cur);
+	}
+	if(maxPrio < minPrio)
+	{
+		logMsg("real-time priority not allowed by RLIMIT_RTPRIO");
+		return raiseNiceValue() && ok;
+	}
+	sched_param param{};
+	param.sched_priority = std::max(minPrio, std::min(hint.priority, maxPrio));
+	// don't pass the policy to processes spawned from this thread
+	if(sched_setscheduler(0, policy | SCHED_RESET_ON_FORK, &param) != 0)
+	{
+		logWarn("unable to set %s priority %d", policy == SCHED_FIFO ? "SCHED_FIFO" : "SCHED_RR", param.sched_priority);
+		return raiseNiceValue() && ok;
+	}
+	logMsg("set %s priority %d, CPU mask:0x%llX", policy == SCHED_FIFO ? "SCHED_FIFO" : "SCHED_RR",
+		param.sched_priority, (unsigned long long)mask);
+	return ok;
+}
+#else
+const CPUTopology &cpuTopology()
+{
+	return topology;
+}
+
+bool applySchedulingHint(const SchedulingHint &hint)
+{
+	return false;
+}
+#endif
+
+void JitterStats::add(int64_t intervalNs, int64_t expectedNs)
+{
+	if(!intervalNs || !expectedNs)
+		return;
+	auto jitterNs = std::abs(intervalNs - expectedNs);
+	samples++;
+	totalJitterNs += jitterNs;
+	maxJitterNs = std::max(maxJitterNs, jitterNs);
+	if(intervalNs > expectedNs + expectedNs / 2)
+		late++;
+}
+
+void JitterStats::log(const char *name) const
+{
+	if(!samples)
+		return;
+	logMsg("%s jitter: %u samples, avg %uus, max %uus, %u late", name, samples,
+		(uint)(totalJitterNs / samples / 1000), (uint)(maxJitterNs / 1000), late);
+}
+
+}
@@ -0,0 +1,321 @@
+/*  This file is part of Imagine.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Imagine.  If not, see <http://www.gnu.org/licenses/> */
+
+#define LOGTAG "TaskPool"
+#include <imagine/thread/TaskPool.hh>
+#include <imagine/logger/logger.h>
+#include <sched.h>
+#include <unistd.h>
+
+namespace IG
+{
+
+static constexpr uint QUEUE_SIZE = 256;
+static constexpr uint SPIN_ITERATIONS = 1 << 12;
+
+// index of the current thread's worker, -1 outside the pool
+static thread_local int workerIdx = -1;
+static thread_local TaskPool *workerPool{};
+static Mutex sharedPoolMutex;
+
+// Bounded deque, the owner works on the newest tasks for cache locality
+// while thieves take the oldest, a spinlock suffices since it's only
+// held for a copy
+struct TaskPool::Queue
+{
+	std::atomic_flag lock_ = ATOMIC_FLAG_INIT;
+	Task task[QUEUE_SIZE];
+	uint head = 0, tail = 0;
+
+	void lock()
+	{
+		while(lock_.test_and_set(std::memory_order_acquire))
+			sched_yield();
+	}
+
+	void unlock()
+	{
+		lock_.clear(std::memory_order_release);
+	}
+
+	bool push(Task t)
+	{
+		lock();
+		if(tail - head == QUEUE_SIZE)
+		{
+			unlock();
+			return false;
+		}
+		task[tail++ % QUEUE_SIZE] = t;
+		unlock();
+		return true;
+	}
+
+	bool popNewest(Task &t)
+	{
+		lock();
+		if(tail == head)
+		{
+			unlock();
+			return false;
+		}
+		t = task[--tail % QUEUE_SIZE];
+		unlock();
+		return true;
+	}
+
+	bool popOldest(Task &t)
+	{
+		lock();
+		if(tail == head)
+		{
+			unlock();
+			return false;
+		}
+		t = task[head++ % QUEUE_SIZE];
+		unlock();
+		return true;
+	}
+};
+
+struct TaskPool::Worker
+{
+	pthread_t id{};
+	std::atomic<int> cpu{-1};
+	std::atomic<bool> started{};
+};
+
+static void applyAffinity(pthread_t id, int cpu)
+{
+	#if defined __linux__ && !defined __ANDROID__
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	if(cpu >= 0)
+		CPU_SET(cpu, &set);
+	else
+	{
+		iterateTimes(CPU_SETSIZE, i)
+		{
+			CPU_SET(i, &set);
+		}
+	}
+	if(pthread_setaffinity_np(id, sizeof(set), &set) != 0)
+		logWarn("unable to set affinity to CPU %d", cpu);
+	#endif
+}
+
+bool TaskPool::init(uint threads)
+{
+	if(queue)
+		return true;
+	threads = std::min(threads, MAX_THREADS);
+	queue = new Queue[threads + 1];
+	worker = new Worker[threads];
+	threads_ = threads;
+	quit = false;
+	runningWorkers = threads;
+	logMsg("starting %u worker threads", threads);
+	iterateTimes(threads, i)
+	{
+		IG::runOnThread(
+			[this, i]()
+			{
+				runWorker(i);
+			});
+	}
+	return true;
+}
+
+void TaskPool::deinit()
+{
+	if(!queue)
+		return;
+	// drain any remaining work before stopping the workers
+	while(runQueuedTask(-1)) {}
+	quit.store(true);
+	sleepMutex.lock();
+	sleepCond.notify_all();
+	sleepMutex.unlock();
+	while(runningWorkers.load(std::memory_order_acquire))
+		sched_yield();
+	delete[] queue;
+	delete[] worker;
+	queue = {};
+	worker = {};
+	threads_ = 0;
+}
+
+void TaskPool::setAffinityHint(uint thread, int cpu)
+{
+	if(thread >= threads_)
+		return;
+	auto &w = worker[thread];
+	w.cpu.store(cpu);
+	// before starting, the worker applies the hint itself
+	if(w.started.load(std::memory_order_acquire))
+		applyAffinity(w.id, cpu);
+}
+
+void TaskPool::notifyWaiters()
+{
+	sleepMutex.lock();
+	waitCond.notify_all();
+	sleepMutex.unlock();
+}
+
+void TaskPool::execute(Task &task)
+{
+	task.func();
+	// pairs with the waiters count check in TaskGroup::wait(), one of the two
+	// sides always sees the other so a finished group can't be missed
+	if(task.group->pending.fetch_sub(1) == 1 && waiters.load())
+		notifyWaiters();
+}
+
+void TaskPool::push(Task task)
+{
+	int idx = workerPool == this ? workerIdx : threads_;
+	task.group->pending.fetch_add(1, std::memory_order_relaxed);
+	// count it first so a thief never sees the count behind the queue
+	queuedTasks.fetch_add(1);
+	if(!queue[idx].push(task))
+	{
+		// queue full, no parallelism to gain by waiting for space
+		queuedTasks.fetch_sub(1, std::memory_order_relaxed);
+		execute(task);
+		return;
+	}
+	if(sleepers.load())
+	{
+		sleepMutex.lock();
+		sleepCond.notify_one();
+		sleepMutex.unlock();
+	}
+	// a waiting thread may be the only one free to run it
+	if(waiters.load())
+		notifyWaiters();
+}
+
+bool TaskPool::runQueuedTask(int thisWorker)
+{
+	if(!queuedTasks.load(std::memory_order_relaxed))
+		return false;
+	Task task;
+	bool got = thisWorker >= 0 && queue[thisWorker].popNewest(task);
+	if(!got)
+	{
+		// steal starting after our own queue so thieves spread out
+		uint start = thisWorker >= 0 ? thisWorker + 1 : 0;
+		iterateTimes(threads_ + 1, i)
+		{
+			if(queue[(start + i) % (threads_ + 1)].popOldest(task))
+			{
+				got = true;
+				break;
+			}
+		}
+	}
+	if(!got)
+		return false;
+	queuedTasks.fetch_sub(1, std::memory_order_relaxed);
+	execute(task);
+	return true;
+}
+
+void TaskPool::runWorker(uint idx)
+{
+	workerIdx = idx;
+	workerPool = this;
+	auto &w = worker[idx];
+	w.id = pthread_self();
+	w.started.store(true, std::memory_order_release);
+	if(w.cpu.load() >= 0)
+		applyAffinity(w.id, w.cpu.load());
+	while(!quit.load(std::memory_order_relaxed))
+	{
+		if(runQueuedTask(idx))
+			continue;
+		// tasks often come in bursts, spin a bit before sleeping
+		bool gotWork = false;
+		iterateTimes(SPIN_ITERATIONS, i)
+		{
+			if(queuedTasks.load(std::memory_order_relaxed) || quit.load(std::memory_order_relaxed))
+			{
+				gotWork = true;
+				break;
+			}
+		}
+		if(gotWork)
+			continue;
+		sleepMutex.lock();
+		sleepers.fetch_add(1);
+		while(!queuedTasks.load() && !quit.load())
+			sleepCond.wait(sleepMutex);
+		sleepers.fetch_sub(1);
+		sleepMutex.unlock();
+	}
+	runningWorkers.fetch_sub(1, std::memory_order_release);
+}
+
+void TaskPool::TaskGroup::run(TaskFunc func)
+{
+	if(!pool.threads())
+	{
+		func();
+		return;
+	}
+	pool.push({func, this});
+}
+
+void TaskPool::TaskGroup::wait()
+{
+	int thisWorker = workerPool == &pool ? workerIdx : -1;
+	while(pending.load(std::memory_order_acquire))
+	{
+		// help with queued work, which may be our own tasks
+		if(pool.runQueuedTask(thisWorker))
+			continue;
+		// the rest is running on other threads, sleep until it's done or
+		// more work is queued
+		pool.sleepMutex.lock();
+		pool.waiters.fetch_add(1);
+		while(pending.load() && !pool.queuedTasks.load())
+			pool.waitCond.wait(pool.sleepMutex);
+		pool.waiters.fetch_sub(1);
+		pool.sleepMutex.unlock();
+	}
+}
+
+TaskPool &TaskPool::shared()
+{
+	// never destroyed so exit doesn't wait on workers
+	static TaskPool *pool{};
+	static std::atomic<bool> started{};
+	if(unlikely(!started.load(std::memory_order_acquire)))
+	{
+		sharedPoolMutex.lock();
+		if(!started.load(std::memory_order_relaxed))
+		{
+			long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+			pool = new TaskPool;
+			pool->init(cpus > 1 ? cpus - 1 : 0);
+			started.store(true, std::memory_order_release);
+		}
+		sharedPoolMutex.unlock();
+	}
+	return *pool;
+}
+
+}
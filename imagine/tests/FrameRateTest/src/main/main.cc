@@ -37,6 +37,7 @@ static TestParams testParam[] =
 	{TEST_CLEAR},
 	{TEST_DRAW, {320, 224}},
 	{TEST_WRITE, {320, 224}},
+	{TEST_TASK_POOL},
 };
 #ifdef __ANDROID__
 static std::unique_ptr<RootCpufreqParamSetter> cpuFreq{};
@@ -101,6 +102,8 @@ TestFramework *startTest(Base::Window &win, const TestParams &t)
 			activeTest = new DrawTest{};
 		bcase TEST_WRITE:
 			activeTest = new WriteTest{};
+		bcase TEST_TASK_POOL:
+			activeTest = new TaskPoolTest{};
 	}
 	activeTest->init(t.pixmapSize);
 	win.postDraw();
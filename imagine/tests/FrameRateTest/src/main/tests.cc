@@ -25,6 +25,7 @@ const char *testIDToStr(TestID id)
 		case TEST_CLEAR: return "Clear";
 		case TEST_DRAW: return "Draw";
 		case TEST_WRITE: return "Write";
+		case TEST_TASK_POOL: return "Task Pool";
 		default: return "Unknown";
 	}
 }
@@ -305,3 +306,103 @@ void WriteTest::drawTest()
 	texture.write(0, pixmap, {});
 	sprite.draw();
 }
+
+// a few rounds of integer hashing per item, enough work that splitting it
+// over the pool's threads should show up as a speedup
+static void hashItems(uint32 *result, uint start, uint end)
+{
+	for(uint i = start; i < end; i++)
+	{
+		uint32 h = i;
+		iterateTimes(64, r)
+		{
+			h ^= h >> 16;
+			h *= 0x7feb352d;
+			h ^= h >> 15;
+			h *= 0x846ca68b;
+		}
+		result[i] = h;
+	}
+}
+
+void TaskPoolTest::initTest(IG::WP pixmapSize)
+{
+	serialResult = std::make_unique<uint32[]>(ITEMS);
+	parallelResult = std::make_unique<uint32[]>(ITEMS);
+	statsText.init(View::defaultFace);
+	statsText.setString(statsStr.data());
+	// start the workers before timing anything
+	IG::TaskPool::shared();
+}
+
+void TaskPoolTest::placeTest(const Gfx::GCRect &rect)
+{
+	statsRect = rect;
+	statsText.maxLineSize = rect.xSize();
+	if(strlen(statsStr.data()))
+		statsText.compile(projP);
+}
+
+void TaskPoolTest::deinitTest()
+{
+	statsText.deinit();
+	serialResult.reset();
+	parallelResult.reset();
+}
+
+void TaskPoolTest::frameUpdateTest(Base::Screen &screen, Base::FrameTimeBase frameTime)
+{
+	auto &pool = IG::TaskPool::shared();
+	auto serialStart = IG::Time::now();
+	hashItems(serialResult.get(), 0, ITEMS);
+	auto parallelStart = IG::Time::now();
+	// nested groups exercise the fork/join path as well as parallelFor()
+	IG::TaskPool::TaskGroup group{pool};
+	group.run(
+		[this, &pool]()
+		{
+			pool.parallelFor(0, ITEMS / 2, 1024,
+				[this](uint start, uint end)
+				{
+					hashItems(parallelResult.get(), start, end);
+				});
+		});
+	pool.parallelFor(ITEMS / 2, ITEMS, 1024,
+		[this](uint start, uint end)
+		{
+			hashItems(parallelResult.get(), start, end);
+		});
+	group.wait();
+	auto parallelEnd = IG::Time::now();
+	serialNSecs += (parallelStart - serialStart).nSecs();
+	parallelNSecs += (parallelEnd - parallelStart).nSecs();
+	if(memcmp(serialResult.get(), parallelResult.get(), ITEMS * sizeof(uint32)) != 0)
+		mismatches++;
+	if(frames % 30 == 0)
+	{
+		double serialMSecs = serialNSecs / ((frames + 1) * 1e6);
+		double parallelMSecs = parallelNSecs / ((frames + 1) * 1e6);
+		string_printf(statsStr, "%u worker thread(s)\nSerial: %.2fms\nParallel: %.2fms (%.2fx)\nMismatched frames: %u",
+			pool.threads(), serialMSecs, parallelMSecs,
+			parallelMSecs > 0 ? serialMSecs / parallelMSecs : 0., mismatches);
+		statsText.compile(projP);
+	}
+}
+
+void TaskPoolTest::drawTest()
+{
+	using namespace Gfx;
+	if(!mismatches)
+		setClearColor(0., 0., .3);
+	else
+		setClearColor(.7, .0, .0);
+	Gfx::clear();
+	if(strlen(statsStr.data()))
+	{
+		setColor(1., 1., 1., 1.);
+		texAlphaProgram.use();
+		setBlendMode(BLEND_MODE_ALPHA);
+		statsText.draw(projP.alignXToPixel(statsRect.x + TableView::globalXIndent),
+			projP.alignYToPixel(statsRect.yCenter()), LC2DO, projP);
+	}
+}
@@ -19,12 +19,15 @@
 #include <imagine/gfx/GfxSprite.hh>
 #include <imagine/gfx/ProjectionPlane.hh>
 #include <imagine/time/Time.hh>
+#include <imagine/thread/TaskPool.hh>
+#include <memory>
 
 enum TestID
 {
 	TEST_CLEAR,
 	TEST_DRAW,
 	TEST_WRITE,
+	TEST_TASK_POOL,
 };
 
 struct FramePresentTime
@@ -138,5 +141,26 @@ public:
 	void drawTest() override;
 };
 
+class TaskPoolTest : public TestFramework
+{
+protected:
+	static constexpr uint ITEMS = 1 << 16;
+	std::unique_ptr<uint32[]> serialResult, parallelResult;
+	uint64_t serialNSecs = 0, parallelNSecs = 0;
+	uint mismatches = 0;
+	Gfx::Text statsText;
+	Gfx::GCRect statsRect{};
+	std::array<char, 256> statsStr{};
+
+public:
+	TaskPoolTest() {}
+
+	void initTest(IG::WP pixmapSize) override;
+	void placeTest(const Gfx::GCRect &rect) override;
+	void deinitTest() override;
+	void frameUpdateTest(Base::Screen &screen, Base::FrameTimeBase frameTime) override;
+	void drawTest() override;
+};
+
 TestFramework *startTest(Base::Window &win, const TestParams &t);
 const char *testIDToStr(TestID id);